@@ -1,280 +1,843 @@
-// Copyright 2017 Isaac Hsu. MIT License
-
-#pragma once
-
-#include "Components/ActorComponent.h"
-#include "BufferedInputEventKit.h"
-#include "CyclicBuffer.h"
-#include "InputHistoryRecordArray.h"
-#include "InputBufferComponent.generated.h"
-
-
-UENUM(BlueprintType)
-enum class FBufferedInputEventType : uint8
-{
-	Pressed = 0,
-	Released = 1,
-	Held = 2,
-};
-
-USTRUCT()
-struct FBufferedInputEventSetup
-{
-	GENERATED_BODY()
-
-	FBufferedInputEventSetup()
-		: bEnabled(true)
-		, Name(NAME_None)
-		, Type(FBufferedInputEventType::Pressed)
-		, bExecuteWhenPaused(false)
-		, KeyMappingName(NAME_None)
-	{}
-
-	/** Whether this event is enabled. */
-	UPROPERTY(EditAnywhere)
-	bool bEnabled;
-
-	/** Name of input event, e.g "Jump" */
-	UPROPERTY(EditAnywhere)
-	FName Name;
-
-	/** Type of the input event. */
-	UPROPERTY(EditAnywhere)
-	FBufferedInputEventType Type;
-
-	/** Should the event get triggered even when the game is paused? */
-	UPROPERTY(EditAnywhere, Category = "Input")
-	bool bExecuteWhenPaused;
-
-	/** Name of key mapping to use for this event. */
-	UPROPERTY(EditAnywhere)
-	FName KeyMappingName;
-
-	/** Keys to bind it to. */
-	UPROPERTY(EditAnywhere)
-	TArray<FKey> Keys;
-};
-
-USTRUCT()
-struct FBufferedInputEventKeyMapping
-{
-	GENERATED_BODY()
-
-	FBufferedInputEventKeyMapping() : Name(NAME_None) {}
-
-	/** Name of this mapping. */
-	UPROPERTY(EditAnywhere)
-	FName Name;
-
-	/** Keys to bind it to. */
-	UPROPERTY(EditAnywhere)
-	TArray<FKey> Keys;
-};
- 
-/* Record stored in input buffer representing the same input status over one or several frames. */
-struct FInputBufferRecord
-{
-	FInputBufferRecord()
-		: bValid(false)
-		, StartTime(0.f)
-		, EndTime(0.f)
-		, Events(0)
-		, TranslatedEvents(0)
-	{}
-
-	FInputBufferRecord(float InStarTime, float InEndTime, uint64 InEvents, uint64 InTranslatedEvents, bool bInValid = true)
-		: bValid(bInValid)
-		, StartTime(InStarTime)
-		, EndTime(InEndTime)
-		, Events(InEvents)
-		, TranslatedEvents(InTranslatedEvents)
-	{}
-
-	/** Whether this record is valid. */
-	bool bValid;
-
-	/** Time when we start to record it. */
-	float StartTime;
-
-	/** Time when we stop recording it. */
-	float EndTime;
-
-	/** Bit flags of input events. */
-	uint64 Events;
-
-	/** Input events that are translated from. */
-	uint64 TranslatedEvents;
-
-	/** Input event capacity = the number of bits of event flags. */
-	static const int32 MAX_EVENTS = sizeof(uint64) * 8;
-};
-
-/**
-* A component used to store input data for input buffering.
-*
-* Caution: Should be used with AInputBufferPlayerController.
-**/
-UCLASS( BlueprintType, Blueprintable, ClassGroup=(Input) )
-class INPUTBUFFER_API UInputBufferComponent : public UActorComponent, public FBufferedInputEventKit
-{
-	GENERATED_BODY()
-
-public:		
-	UInputBufferComponent();
-
-public:
-
-	/* Input events set-up information. */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer")
-	TArray<FBufferedInputEventSetup> EventSetups;
-
-	/* A list of input events into which others could be translated. */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer")
-	TArray<FName> TranslatedEvents;
-
-	/* Optional key mappings that can be referenced in input event set-up. */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer")
-	TArray<FBufferedInputEventKeyMapping> KeyMappings;
-
-	/* The maximal capacity of the input buffer. */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer", Meta = (ClampMin = 0, UIMin = 0))
-	int32 MaxInputHistory;
-
-public:
-
-	//~ Begin UActorComponent Interface
-	virtual void BeginPlay() override;
-	//~ End UActorComponent Interface
-
-	/**
-	* Resets internal data structures according to EventSetups. Should be called after changes to EventSetups are made.
-	*
-	* Caution: Calling this function will clear the input buffer.
-	*
-	* @return The number of registered input events.
-	**/
-	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
-	int32 Initialize();
-
-	/* Called by the owner controller's PreProcessInput. */
-	void OnPreProcessInput(class UPlayerInput* PlayerInput, const bool bGamePaused);
-
-	/* Called by the owner controller's PostProcessInput. */
-	void OnPostProcessInput(class UPlayerInput* PlayerInput, const bool bGamePaused);
-
-	/* Clears the input buffer. */
-	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
-	void ClearHistory();
-
-	/* Invalidates the input buffer. The records in the buffer are still there but they will be no longer valid for command recognition. */
-	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
-	void InvalidateHistory();
-
-	bool ConvertEventsToFlags(const TArray<FName>& Events, uint64& Flags) const;
-	void ConvertFlagsToEvents(uint64 Flags, TArray<FName>& Events) const;
-
-	/**
-	* Prints the content of the input buffer to a string.
-	*
-	* @param MaxRecords Maximal number of latest records to print.
-	* @param bIncludeInvalidRecords Whether invalidated records are included.
-	* @param bReverseChronological Whether records are printed in chronological order or reverse chronological order.
-	* @return An output string.
-	*/
-	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
-	FString Print(int32 MaxRecords = 0, bool bIncludeInvalidRecords = false, bool bReverseChronological = false) const;
-
-	/**
-	* Retrieves the current input events.
-	*
-	* Caution: Output input events are only valid after player input is processed in this frame. 
-	*
-	* @param Events An output array of the input events in this frame.
-	*/
-	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
-	void GetCurrentEvents(TArray<FName>& Events) const;
-
-	/**
-	* Retrieves the last input events in the input buffer.
-	*
-	* @param Events An output array of the last input events.
-	* @param TimeLimit If the time of the last events exceeds the time limit, nothing will be retrieved. Zero means no time limit.
-	* @param bSkipEmptyTrail Whether a trailing empty record should be skipped.
-	* @return The time when the last events were buffered.
-	*/
-	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
-	float GetLastEvents(TArray<FName>& Events, float TimeLimit = 0.f, bool bSkipEmptyTrail = true) const;
-
-	/**
-	* Retrieves input records in the input buffer in chronological order.
-	*
-	* @param Records An output array of input records.
-	* @param TimeLimit A time limit used to exclude outdated input records. Zero means no time limit.
-	* @param bIncludeInvalidRecords Whether invalidated records are included.
-	*/
-	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
-	void GetHistoryRecords(TArray<FInputHistoryRecord>& Records, float TimeLimit = 0, bool bIncludeInvalidRecords = false) const;
-
-	/**
-	* Sets input history to given records. 
-	* The given records must be in chronological order, and their timespan cannot overlap.
-	*
-	* Caution: The given records MUST be valid. If incorrect data is inputted, the input buffer may malfunction until those records are flushed out. 
-	*
-	* @param Records An array of given input records.
-	* @return Whether there is an error during the process.
-	*/
-	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
-	bool SetHistoryRecords(const TArray<FInputHistoryRecord>& Records);
-
-	/* Returns whether the last input record matches given input events.
-	*
-	* @param EventsToMatch Input events to match.
-	* @param EventsToIgnore Input events to ignore.
-	* @param TimeLimit If the time of the last record exceeds the time limit, always return false. Zero means no time limit.
-	* @param bSkipEmptyTrail Whether a trailing empty record should be skipped.
-	* @return Whether the last input record matches given input events.
-	*/
-	UFUNCTION(BlueprintCallable, Category = "Input Buffer", Meta = (AutoCreateRefTerm = "EventsToIgnore"))
-	bool MatchEvents(const TArray<FName>& EventsToMatch, const TArray<FName>& EventsToIgnore, float TimeLimit = 0.f, bool bSkipEmptyTrail = true) const;
-
-	/* Returns whether the latest input history matches a given input command. */
-	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
-	bool MatchCommand(class UInputCommand* Command) const;
-
-protected:
-
-	FInputBufferRecord CurrentRecord;
-
-	TCyclicBuffer<FInputBufferRecord> InputHistory;
-
-	TArray<FBufferedInputEventSetup> RuntimeEvents;
-
-	TMap<FName, int32> EventIndexMap;
-
-	TMap<FKey, int32> KeyIndexMap;
-
-	TBitArray<> KeyStates1;
-	TBitArray<> KeyStates2;
-
-	TBitArray<>* PreviousKeyStates;
-	TBitArray<>* CurrentKeyStates;
-
-protected:
-
-	/* Returns the current time used internally in the input buffer. Override this if you wish to use another time function other than GetWorld()->GetRealTimeSeconds(). */
-	virtual float GetCurrentTime() const;
-
-	/* Note returned record is valid only before new records are added to the input buffer. */
-	const FInputBufferRecord* GetLastRecord(float TimeLimit, bool bSkipEmptyTrail) const;
-	const FInputBufferRecord* GetLastRecord(float TimeLimit) const;
-	const FInputBufferRecord* GetLastNonEmptyRecord(float TimeLimit) const;
-
-	FString EventFlagsToString(uint64 Actions, const FString& Separator = ", ") const;
-
-	void ProcessInput(UPlayerInput* PlayerInput, const bool bGamePaused);
-
-	void RecordEvent(uint64 EventIndex, class AInputBufferPlayerController* Controller);
-
-};
-
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+#include "BufferedInputEventKit.h"
+#include "InputBufferRecord.h"
+#include "InputCommandProgram.h"
+#include "CompiledInputCommand.h"
+#include "StaticInputCommand.h"
+#include "EventMaskCache.h"
+#include "InputHistoryRecordArray.h"
+#include "InputBufferRecorder.h"
+#include "InputHistoryArchive.h"
+#include "InputBufferComponent.generated.h"
+
+
+UENUM(BlueprintType)
+enum class FBufferedInputEventType : uint8
+{
+	Pressed = 0,
+	Released = 1,
+	Held = 2,
+};
+
+/* The clock that stamps input records and measures time limits. */
+UENUM(BlueprintType)
+enum class EInputBufferClockSource : uint8
+{
+	/* Real time of the world, which ignores pause and time dilation. */
+	RealTime = 0,
+	/* Game time of the world, which stops while paused and follows time dilation, e.g. during slow-motion effects. */
+	GameTime = 1,
+	/* Engine frames, so time values are measured in frames and time limits are converted with SimulationFrameRate. */
+	FrameCounter = 2,
+};
+
+USTRUCT()
+struct FBufferedInputEventSetup
+{
+	GENERATED_BODY()
+
+	FBufferedInputEventSetup()
+		: bEnabled(true)
+		, Name(NAME_None)
+		, Type(FBufferedInputEventType::Pressed)
+		, bExecuteWhenPaused(false)
+		, KeyMappingName(NAME_None)
+	{}
+
+	/** Whether this event is enabled. */
+	UPROPERTY(EditAnywhere)
+	bool bEnabled;
+
+	/** Name of input event, e.g "Jump" */
+	UPROPERTY(EditAnywhere)
+	FName Name;
+
+	/** Type of the input event. */
+	UPROPERTY(EditAnywhere)
+	FBufferedInputEventType Type;
+
+	/** Should the event get triggered even when the game is paused? */
+	UPROPERTY(EditAnywhere, Category = "Input")
+	bool bExecuteWhenPaused;
+
+	/** Name of key mapping to use for this event. */
+	UPROPERTY(EditAnywhere)
+	FName KeyMappingName;
+
+	/** Keys to bind it to. */
+	UPROPERTY(EditAnywhere)
+	TArray<FKey> Keys;
+};
+
+USTRUCT()
+struct FBufferedInputEventKeyMapping
+{
+	GENERATED_BODY()
+
+	FBufferedInputEventKeyMapping() : Name(NAME_None) {}
+
+	/** Name of this mapping. */
+	UPROPERTY(EditAnywhere)
+	FName Name;
+
+	/** Keys to bind it to. */
+	UPROPERTY(EditAnywhere)
+	TArray<FKey> Keys;
+};
+
+/**
+* Input events resolved to bit flags against an input buffer by UInputBufferComponent::MakeEventMask, so that repeated queries skip looking up event names.
+* Stale once the input buffer is initialized again, since event bits may change meaning.
+*/
+USTRUCT(BlueprintType)
+struct FBufferedInputEventMask
+{
+	GENERATED_BODY()
+
+	FBufferedInputEventMask()
+		: MatchFlags(0)
+		, IgnoreFlags(0)
+		, LayoutVersion(0)
+		, bResolved(false)
+	{}
+
+	/** Bit flags of input events to match. */
+	UPROPERTY()
+	uint64 MatchFlags;
+
+	/** Bit flags of input events to ignore. */
+	UPROPERTY()
+	uint64 IgnoreFlags;
+
+	/** Event layout of the input buffer the mask was resolved against, or zero if the mask was never resolved. */
+	UPROPERTY()
+	uint32 LayoutVersion;
+
+	/** Whether all input events to match are known. A mask with unknown events to match never matches. */
+	UPROPERTY()
+	bool bResolved;
+};
+
+/**
+* A record of input history visited by UInputBufferComponent::VisitHistory. Refers to the record in place, so nothing is copied,
+* and input events are converted to names only when asked for. Valid only during the visit.
+*/
+struct FInputHistoryRecordView
+{
+	FInputHistoryRecordView(const class UInputBufferComponent& InOwner, const FInputBufferRecord& InRecord, int32 InIndex, bool bInValid)
+		: Owner(InOwner)
+		, Record(InRecord)
+		, Index(InIndex)
+		, bValid(bInValid)
+	{}
+
+	/* Bit flags of input events. */
+	uint64 GetEventFlags() const { return Record.Events; }
+
+	/* Bit flags of input events that are translated from. */
+	uint64 GetTranslatedEventFlags() const { return Record.TranslatedEvents; }
+
+	float GetStartTime() const { return Record.StartTime; }
+
+	float GetEndTime() const { return Record.EndTime; }
+
+	/* Whether the record is valid for command recognition, i.e. neither invalidated nor older than the invalidation watermark. */
+	bool IsValid() const { return bValid; }
+
+	/* Index of the record from the end of input history, i.e. zero is the latest record. */
+	int32 GetIndex() const { return Index; }
+
+	/* Appends names of input events. */
+	void GetEvents(TArray<FName>& OutEvents) const;
+
+	/* Appends names of input events that are translated from. */
+	void GetTranslatedEvents(TArray<FName>& OutEvents) const;
+
+private:
+
+	const class UInputBufferComponent& Owner;
+
+	const FInputBufferRecord& Record;
+
+	int32 Index;
+
+	bool bValid;
+};
+ 
+/**
+* A component used to store input data for input buffering.
+*
+* Caution: Should be used with AInputBufferPlayerController.
+**/
+UCLASS( BlueprintType, Blueprintable, ClassGroup=(Input) )
+class INPUTBUFFER_API UInputBufferComponent : public UActorComponent, public FBufferedInputEventKit
+{
+	GENERATED_BODY()
+
+public:		
+	UInputBufferComponent();
+
+public:
+
+	/* Input events set-up information. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer")
+	TArray<FBufferedInputEventSetup> EventSetups;
+
+	/* A list of input events into which others could be translated. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer")
+	TArray<FName> TranslatedEvents;
+
+	/* Optional key mappings that can be referenced in input event set-up. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer")
+	TArray<FBufferedInputEventKeyMapping> KeyMappings;
+
+	/* The maximal capacity of the input buffer. The minimal one if bAutoSizeHistory is true. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer", Meta = (ClampMin = 0, UIMin = 0))
+	int32 MaxInputHistory;
+
+	/**
+	* If true, the capacity of the input buffer grows to the minimum needed by command sets bound with BindCommandSet.
+	* Otherwise a warning is logged when MaxInputHistory is too small for a bound input command.
+	* Records that differ only in translated events are not merged, so the capacity grows again once such records are added.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer")
+	bool bAutoSizeHistory;
+
+	/**
+	* If positive, input history keeps every record that ended within this many seconds: it grows beyond its capacity during bursts of input,
+	* up to MaxRetainedHistory records, and shrinks back once the extra records fall out of the window. Grown storage is pooled among input buffers.
+	* Unused in frame-indexed simulation, where snapshots need a fixed capacity.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer", Meta = (ClampMin = 0, UIMin = 0))
+	float HistoryRetention;
+
+	/* The most records input history can grow to with HistoryRetention. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer", Meta = (ClampMin = 0, UIMin = 0))
+	int32 MaxRetainedHistory;
+
+	/**
+	* If positive, records evicted from input history are kept in a compressed archive, e.g. a full round for replays, analytics or input display.
+	* About this many of the latest evicted records are kept. Command recognition never reads the archive, and rolling back to a snapshot does not rewrite it.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer", Meta = (ClampMin = 0, UIMin = 0))
+	int32 MaxArchivedHistory;
+
+	/**
+	* If true, input records are stamped with simulation frame indices instead of real time, so peers submitting the same input build the same history.
+	* Input sampled from the owner controller is no longer buffered automatically but must be submitted with SimulateFrame.
+	* All time values and limits are then measured in frames.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer")
+	bool bFrameIndexedSimulation;
+
+	/* Simulation frames per second. Used to convert time limits in seconds to whole frames in frame-indexed simulation, or with the frame counter clock. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer", Meta = (ClampMin = 1, UIMin = 1))
+	float SimulationFrameRate;
+
+	/**
+	* The clock that stamps input records and measures time limits. Sampled once per engine frame and shared by all queries in the frame.
+	* Unused in frame-indexed simulation, where time is the index of the simulation frame. Change it with SetClockSource at runtime.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer")
+	EInputBufferClockSource ClockSource;
+
+public:
+
+	//~ Begin UActorComponent Interface
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	//~ End UActorComponent Interface
+
+	//~ Begin UObject Interface
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+	//~ End UObject Interface
+
+	/**
+	* Selects the clock that stamps input records, discarding the sample of the current frame so that the new clock is sampled on the next query.
+	* Records buffered before keep the times of the previous clock, so consider clearing the input buffer if the time unit changes.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	void SetClockSource(EInputBufferClockSource NewClockSource);
+
+	/**
+	* Resets internal data structures according to EventSetups. Should be called after changes to EventSetups are made.
+	*
+	* Caution: Calling this function will clear the input buffer.
+	*
+	* @return The number of registered input events.
+	**/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	int32 Initialize();
+
+	/**
+	* Registers input events again according to EventSetups without clearing the input buffer, e.g. when controls are rebound in the middle of a match.
+	* Event bits of buffered records are moved to where their events are registered now, and bits of events no longer registered are dropped.
+	* Keys still bound keep their states. Event masks, bound input commands and snapshots taken before are stale afterwards.
+	*
+	* @return The number of registered input events.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	int32 Reinitialize();
+
+	/* Called by the owner controller's PreProcessInput. */
+	void OnPreProcessInput(class UPlayerInput* PlayerInput, const bool bGamePaused);
+
+	/* Called by the owner controller's PostProcessInput. */
+	void OnPostProcessInput(class UPlayerInput* PlayerInput, const bool bGamePaused);
+
+	/* Called by the owner controller when it receives a key event. Used to measure input latency. */
+	void OnInputKey(const FKey& Key);
+
+	/**
+	* Buffers input events for a simulation frame in frame-indexed simulation. No engine time is queried, so frames can be re-simulated in a tight loop.
+	*
+	* @param FrameIndex The index of the simulation frame, which becomes the current time of the input buffer. Should start from one since zero time is regarded as unset in command recognition.
+	* @param Events Bit flags of input events in the frame, e.g. those sampled locally by GetCurrentEventFlags.
+	* @param TranslatedEvents Bit flags of input events that the events are translated from.
+	*/
+	void SimulateFrame(int32 FrameIndex, uint64 Events, uint64 TranslatedEvents = 0);
+
+	/**
+	* Buffers input events for a simulation frame in frame-indexed simulation.
+	*
+	* @param FrameIndex The index of the simulation frame, which becomes the current time of the input buffer.
+	* @param Events Input events in the frame.
+	* @return Whether all given input events are known.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	bool SimulateFrameEvents(int32 FrameIndex, const TArray<FName>& Events);
+
+	/* Returns the index of the last simulated frame. */
+	UFUNCTION(BlueprintPure, Category = "Input Buffer")
+	int32 GetSimulationFrame() const { return SimulationFrame; }
+
+	/* Returns input history for native code, e.g. to match compiled input commands with FInputCommandMatcher. */
+	const FInputBufferHistory& GetInputHistory() const { return InputHistory; }
+
+	/* Retrieves bit flags of the input events sampled in this frame. */
+	void GetCurrentEventFlags(uint64& Events, uint64& TranslatedEvents) const
+	{
+		Events = CurrentRecord.Events;
+		TranslatedEvents = CurrentRecord.TranslatedEvents;
+	}
+
+	/* Clears the input buffer. */
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	void ClearHistory();
+
+	/**
+	* Invalidates the input buffer. The records in the buffer are still there but they will be no longer valid for command recognition.
+	* Takes constant time, since it only moves the invalidation watermark of input history.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	void InvalidateHistory();
+
+	/**
+	* Invalidates a record and all older records, keeping later records valid. Takes constant time.
+	*
+	* @param RecordIndex Index of the latest record to invalidate from the end of input history, i.e. zero invalidates all records.
+	*/
+	void InvalidateHistoryFrom(int32 RecordIndex);
+
+	/**
+	* Consumes the records used by a match, e.g. after performing a special move, so that they and older records are no longer valid for command recognition
+	* while input after the match stays valid. Must be called before any record is added after matching. Does nothing if the result has no records.
+	*/
+	void ConsumeHistory(const FInputCommandMatchResult& Result);
+
+	bool ConvertEventsToFlags(const TArray<FName>& Events, uint64& Flags) const;
+	void ConvertFlagsToEvents(uint64 Flags, TArray<FName>& Events) const;
+
+	/**
+	* Prints the content of the input buffer to a string.
+	*
+	* @param MaxRecords Maximal number of latest records to print.
+	* @param bIncludeInvalidRecords Whether invalidated records are included.
+	* @param bReverseChronological Whether records are printed in chronological order or reverse chronological order.
+	* @return An output string.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	FString Print(int32 MaxRecords = 0, bool bIncludeInvalidRecords = false, bool bReverseChronological = false) const;
+
+	/* Same as Print but appends to a given string, so a string kept by the caller can be reused without allocation, e.g. for debug display every frame. */
+	void PrintTo(FString& Out, int32 MaxRecords = 0, bool bIncludeInvalidRecords = false, bool bReverseChronological = false) const;
+
+	/**
+	* Retrieves the current input events.
+	*
+	* Caution: Output input events are only valid after player input is processed in this frame. 
+	*
+	* @param Events An output array of the input events in this frame.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	void GetCurrentEvents(TArray<FName>& Events) const;
+
+	/**
+	* Retrieves the last input events in the input buffer.
+	*
+	* @param Events An output array of the last input events.
+	* @param TimeLimit If the time of the last events exceeds the time limit, nothing will be retrieved. Zero means no time limit.
+	* @param bSkipEmptyTrail Whether a trailing empty record should be skipped.
+	* @return The time when the last events were buffered.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	float GetLastEvents(TArray<FName>& Events, float TimeLimit = 0.f, bool bSkipEmptyTrail = true) const;
+
+	/* Same as GetLastEvents but retrieves the last input events as a mask to match, without converting them to names. */
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer", Meta = (DisplayName = "Get Last Events (Mask)"))
+	float GetLastEventMask(FBufferedInputEventMask& Events, float TimeLimit = 0.f, bool bSkipEmptyTrail = true) const;
+
+	float GetLastEvents(FBufferedInputEventMask& Events, float TimeLimit = 0.f, bool bSkipEmptyTrail = true) const
+	{
+		return GetLastEventMask(Events, TimeLimit, bSkipEmptyTrail);
+	}
+
+	/**
+	* Retrieves input records in the input buffer in chronological order.
+	*
+	* @param Records An output array of input records.
+	* @param TimeLimit A time limit used to exclude outdated input records. Zero means no time limit.
+	* @param bIncludeInvalidRecords Whether invalidated records are included.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	void GetHistoryRecords(TArray<FInputHistoryRecord>& Records, float TimeLimit = 0, bool bIncludeInvalidRecords = false) const;
+
+	/**
+	* Visits input records in the input buffer in place, without allocating anything. Visits the same records as GetHistoryRecords.
+	*
+	* @param Visitor Called with each record. Returns false to stop visiting.
+	* @param TimeLimit A time limit used to exclude outdated input records. Zero means no time limit.
+	* @param bIncludeInvalidRecords Whether invalidated records are included.
+	* @param bReverseChronological Whether the latest record is visited first.
+	* @return The number of visited records.
+	*/
+	int32 VisitHistory(TFunctionRef<bool(const FInputHistoryRecordView&)> Visitor, float TimeLimit = 0.f, bool bIncludeInvalidRecords = false, bool bReverseChronological = true) const;
+
+	/**
+	* Retrieves records evicted from input history into the archive in chronological order. Records still in input history follow them.
+	*
+	* @param Records An output array of input records. Retrieved records are appended.
+	* @param StartTime Records that end before this time are excluded.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	void GetArchivedHistoryRecords(TArray<FInputHistoryRecord>& Records, float StartTime = 0.f) const;
+
+	/* Returns the archive of records evicted from input history for native code, e.g. to decode it with FInputHistoryArchive::FReader. */
+	const FInputHistoryArchive& GetArchivedHistory() const { return ArchivedHistory; }
+
+	/* Removes all records from the archive. Input history is left untouched. */
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	void ClearArchivedHistory();
+
+	/**
+	* Sets input history to given records. 
+	* The given records must be in chronological order, and their timespan cannot overlap.
+	*
+	* Caution: The given records MUST be valid. If incorrect data is inputted, the input buffer may malfunction until those records are flushed out. 
+	*
+	* @param Records An array of given input records.
+	* @return Whether there is an error during the process.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	bool SetHistoryRecords(const TArray<FInputHistoryRecord>& Records);
+
+	/* Returns whether the last input record matches given input events.
+	*
+	* @param EventsToMatch Input events to match.
+	* @param EventsToIgnore Input events to ignore.
+	* @param TimeLimit If the time of the last record exceeds the time limit, always return false. Zero means no time limit.
+	* @param bSkipEmptyTrail Whether a trailing empty record should be skipped.
+	* @return Whether the last input record matches given input events.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer", Meta = (AutoCreateRefTerm = "EventsToIgnore"))
+	bool MatchEvents(const TArray<FName>& EventsToMatch, const TArray<FName>& EventsToIgnore, float TimeLimit = 0.f, bool bSkipEmptyTrail = true) const;
+
+	/**
+	* Resolves input events to bit flags once, so that they can be matched repeatedly without looking up their names, e.g. from Blueprint every tick.
+	*
+	* @param EventsToMatch Input events to match.
+	* @param EventsToIgnore Input events to ignore. Unknown ones are omitted.
+	* @return A mask that stays valid until the input buffer is initialized again.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer", Meta = (AutoCreateRefTerm = "EventsToIgnore"))
+	FBufferedInputEventMask MakeEventMask(const TArray<FName>& EventsToMatch, const TArray<FName>& EventsToIgnore) const;
+
+	/* Returns whether a mask was resolved against the current event layout of the input buffer. */
+	UFUNCTION(BlueprintPure, Category = "Input Buffer")
+	bool IsEventMaskCurrent(const FBufferedInputEventMask& Mask) const { return Mask.LayoutVersion != 0 && Mask.LayoutVersion == EventLayoutVersion; }
+
+	/* Same as MatchEvents but with input events resolved by MakeEventMask. Always returns false if the mask is stale. */
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer", Meta = (DisplayName = "Match Events (Mask)"))
+	bool MatchEventMask(const FBufferedInputEventMask& Mask, float TimeLimit = 0.f, bool bSkipEmptyTrail = true) const;
+
+	bool MatchEvents(const FBufferedInputEventMask& Mask, float TimeLimit = 0.f, bool bSkipEmptyTrail = true) const
+	{
+		return MatchEventMask(Mask, TimeLimit, bSkipEmptyTrail);
+	}
+
+	/* Returns whether the latest input history matches a given input command. */
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	bool MatchCommand(class UInputCommand* Command) const;
+
+	/**
+	* Returns whether the latest input history matches an input command declared in C++ with TStaticInputCommand.
+	* The matcher is specialized for the command at compile time. Event bits of the command must follow the order in which input events are registered.
+	*/
+	template<typename StaticInputCommandType>
+	bool MatchStaticCommand(FInputCommandMatchResult* OutResult = nullptr) const
+	{
+		return StaticInputCommandType::Match(InputHistory, GetCurrentTime(), GetTimeLimitFrameRate(), nullptr, OutResult);
+	}
+
+	/**
+	* Returns whether the latest input history matches a given input command, and where it matches.
+	* The result is filled in while matching, so it costs no extra pass over input history.
+	*
+	* @param OutResult Set to where the command matches, or reset if it does not. Record indices are from the end of input history.
+	*/
+	bool MatchCommandWithResult(class UInputCommand* Command, FInputCommandMatchResult& OutResult) const;
+
+	/**
+	* Compiles an input command for matching against this input buffer, resolving its input events to bit flags.
+	* The result is valid until the input buffer is initialized again or the command is modified.
+	*/
+	void CompileCommand(const class UInputCommand* Command, FInputCommandProgram& OutProgram) const;
+
+	/* Resolves the name table of a compiled input command to bit flags of input events of this input buffer. */
+	void BindCommand(const FCompiledInputCommand& CompiledCommand, FInputCommandProgram& OutProgram) const;
+
+	/**
+	* Binds a set of input commands to this input buffer, resolving input events of all its commands at once.
+	* Optional, since sets are bound when first matched. Useful to avoid the cost of binding during gameplay,
+	* and needed for bAutoSizeHistory to take the set into account.
+	* The binding is kept until the input buffer is initialized again or the set is compiled again.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	void BindCommandSet(class UInputCommandSet* CommandSet);
+
+	/* Returns the capacity that input history is reset to: MaxInputHistory, or more if bAutoSizeHistory is true and bound command sets need more. */
+	UFUNCTION(BlueprintPure, Category = "Input Buffer")
+	int32 GetHistoryCapacity() const;
+
+	/* Returns the matching input command with the highest priority in a set, or null if none matches. */
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	class UInputCommand* MatchCommandSet(class UInputCommandSet* CommandSet) const;
+
+	/* Returns the matching input command with the highest priority in a set, or null if none matches, and where it matches. */
+	class UInputCommand* MatchCommandSetWithResult(class UInputCommandSet* CommandSet, FInputCommandMatchResult& OutResult) const;
+
+	/* Finds all matching input commands in a set in order of priority. Returns whether any command matches. */
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	bool MatchAllCommands(class UInputCommandSet* CommandSet, TArray<class UInputCommand*>& OutCommands) const;
+
+	/**
+	* Matches an input command with the original data-driven algorithm, which resolves input event names on every visited record.
+	* Slow. Kept as the reference that optimized matchers are verified against in differential tests.
+	*/
+	bool MatchCommandReference(const class UInputCommand* Command) const;
+
+	/**
+	* Starts writing input history to a compact binary replay file. File writes happen on a background thread.
+	*
+	* Caution: Recording stops when the input buffer is initialized again.
+	*
+	* @param Filename Path of the replay file.
+	* @return Whether the replay file can be opened for writing.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	bool StartRecording(const FString& Filename);
+
+	/* Stops writing input history to the replay file. Blocks until all recorded data are written. */
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	void StopRecording();
+
+	/* Returns whether input history is being written to a replay file. */
+	UFUNCTION(BlueprintPure, Category = "Input Buffer")
+	bool IsRecording() const;
+
+	/**
+	* Makes the input buffer driven by played back records instead of the clock. No engine time is queried until EndPlayback is called.
+	*
+	* @param FrameRate Frames per second if record times are frame indices, or zero if they are in seconds.
+	*/
+	void BeginPlayback(float FrameRate);
+
+	/* Makes the input buffer driven by the clock again. */
+	void EndPlayback();
+
+	/* Adds a finished record to input history while playing back, and makes its end time the current time of the input buffer. */
+	void PlaybackRecord(const FInputBufferRecord& Record);
+
+	/**
+	* Removes the latest played back records, as the recorded input buffer did when it restored a snapshot.
+	*
+	* @param NumRecords The number of the latest records to remove.
+	* @param NumValid The number of the latest remaining records that are valid again.
+	*/
+	void PlaybackRollBack(int32 NumRecords, int32 NumValid);
+
+	/**
+	* Returns the number of bytes needed to store a snapshot of the input buffer state.
+	* The size only changes when the input buffer is initialized or its capacity changes.
+	*/
+	int32 GetSnapshotSize() const;
+
+	/**
+	* Copies the input buffer state, i.e. input history, the current record and key states, to a block of memory. Nothing is allocated.
+	*
+	* @param Dest A block of memory of at least GetSnapshotSize() bytes.
+	*/
+	void SaveSnapshot(uint8* Dest) const;
+
+	/**
+	* Restores the input buffer state from a block of memory written by SaveSnapshot. Nothing is allocated.
+	* Records archived after the snapshot was taken are removed from the archive, since simulating again evicts them again.
+	* While recording, only an operation removing the records written since the snapshot is added to the replay.
+	*
+	* @param Src A block of memory written by SaveSnapshot.
+	* @return False if the snapshot was taken with a different layout, e.g. before input events were registered again, even if its size matches.
+	*/
+	bool RestoreSnapshot(const uint8* Src);
+
+protected:
+
+	FInputBufferRecord CurrentRecord;
+
+	FInputBufferHistory InputHistory;
+
+	/* Records evicted from input history, if MaxArchivedHistory is positive. */
+	FInputHistoryArchive ArchivedHistory;
+
+	TArray<FBufferedInputEventSetup> RuntimeEvents;
+
+	TMap<FName, int32> EventIndexMap;
+
+	TMap<FKey, int32> KeyIndexMap;
+
+	/* Identifies the layout of event bits since the last initialization, unique among input buffers. Stamped on event masks to detect stale ones. */
+	uint32 EventLayoutVersion;
+
+	/* Names of input events of given event flags, and the names formatted for printing. */
+	struct FEventNames
+	{
+		TArray<FName> Names;
+
+		FString Text;
+	};
+
+	static const int32 NUM_CACHED_EVENT_NAMES = 16;
+
+	/* Names of the event flags used most recently, since input history reuses a handful of event combinations. */
+	mutable TEventMaskCache<FEventNames, NUM_CACHED_EVENT_NAMES> EventNameCache;
+
+	TBitArray<> KeyStates1;
+	TBitArray<> KeyStates2;
+
+	TBitArray<>* PreviousKeyStates;
+	TBitArray<>* CurrentKeyStates;
+
+	/* The index of the last simulated frame in frame-indexed simulation. */
+	int32 SimulationFrame;
+
+	/* Time in cycles of the first key event since the last processed input, or zero if none or latency is not tracked. */
+	uint64 PendingInputCycles;
+
+	/* Time in cycles of the key event that led to the latest non-empty record, or zero if unknown. */
+	uint64 LastInputCycles;
+
+	/* Serial number of the latest non-empty record with a known key event time. */
+	uint32 LastInputSerial;
+
+	/* The number of records added to input history so far. Used as serial numbers of records. */
+	uint32 NumAppendedRecords;
+
+	/* Serial number of the record whose recognition latency has been reported for each input command. Entries of destroyed commands are pruned. */
+	mutable TMap<TWeakObjectPtr<const class UInputCommand>, uint32> ReportedLatencySerials;
+
+	/* An input command bound to this input buffer. */
+	struct FBoundInputCommand
+	{
+		FBoundInputCommand() : CompiledSerial(0) {}
+
+		/* Serial number of the compiled data of the command when it was bound. */
+		uint32 CompiledSerial;
+
+		FInputCommandProgram Program;
+	};
+
+	/* Input commands bound by MatchCommand, which are bound again when their compiled data change. Emptied when the input buffer is initialized, and entries of destroyed commands are pruned. */
+	mutable TMap<TWeakObjectPtr<const class UInputCommand>, FBoundInputCommand> BoundCommands;
+
+	/* A set of input commands bound to this input buffer. */
+	struct FBoundInputCommandSet
+	{
+		FBoundInputCommandSet() : CompiledSerial(0), bAutoSized(false) {}
+
+		/* Serial number of the compiled data of the set when it was bound. */
+		uint32 CompiledSerial;
+
+		/* Whether the set was bound with BindCommandSet, so that the capacity of input history is grown for it. */
+		bool bAutoSized;
+
+		FInputCommandSetProgram Program;
+	};
+
+	/* Bound sets of input commands, which are bound again when their compiled data change. Emptied when the input buffer is initialized, and entries of destroyed sets are pruned. */
+	mutable TMap<TWeakObjectPtr<const class UInputCommandSet>, FBoundInputCommandSet> BoundCommandSets;
+
+	/* The most history records needed by command sets bound with BindCommandSet. Kept when the input buffer is initialized again. */
+	int32 RequiredHistory;
+
+	/* Whether a warning about insufficient capacity has been logged. Logged once per input buffer to avoid flooding the log. */
+	mutable bool bWarnedHistoryCapacity;
+
+	/* Whether any record with translated events has been added to input history, after which records may differ in translated events alone. */
+	bool bTranslatedHistory;
+
+	/* Whether each command of a set matches. Reused by MatchAllCommands. */
+	mutable TBitArray<> CommandSetMatches;
+
+	/* Whether the input buffer is driven by played back records. */
+	bool bPlayingBack;
+
+	/* The end time of the last played back record. */
+	float PlaybackTime;
+
+	/* Frame rate of played back records, or zero if their times are in seconds. */
+	float PlaybackFrameRate;
+
+	/* The clock sampled in the engine frame of ClockFrame. */
+	mutable float ClockTime;
+
+	/* The engine frame when the clock was last sampled, or MAX_uint64 if it has not been sampled since initialization. */
+	mutable uint64 ClockFrame;
+
+	/* Writes input history to a replay file while recording. The last record in input history is written only when it is finished. */
+	TUniquePtr<FInputBufferRecorder> Recorder;
+
+protected:
+
+	/**
+	* Returns the current time used internally in the input buffer. Override this if you wish to use another time function.
+	* By default, the clock is sampled through SampleClock at most once per engine frame. In frame-indexed simulation, returns the index of the last simulated frame,
+	* and while playing back, the end time of the last played back record, so overrides should call this implementation in those modes.
+	*/
+	virtual float GetCurrentTime() const;
+
+	/* Samples the clock selected by ClockSource. Override this to replace the clock while keeping the per-frame sample of GetCurrentTime. */
+	virtual float SampleClock() const;
+
+	/* Returns the frame rate used to convert time limits to the time unit of input records, or zero if records are measured in seconds. */
+	FORCEINLINE float GetTimeLimitFrameRate() const
+	{
+		if (bPlayingBack)
+		{
+			return PlaybackFrameRate;
+		}
+
+		return bFrameIndexedSimulation || ClockSource == EInputBufferClockSource::FrameCounter ? SimulationFrameRate : 0.f;
+	}
+
+	/* Note returned record is valid only before new records are added to the input buffer. */
+	const FInputBufferRecord* GetLastRecord(float TimeLimit, bool bSkipEmptyTrail) const;
+	const FInputBufferRecord* GetLastRecord(float TimeLimit) const;
+	const FInputBufferRecord* GetLastNonEmptyRecord(float TimeLimit) const;
+
+	FString EventFlagsToString(uint64 Actions, const FString& Separator = ", ") const;
+
+	/* Returns the text of given event flags, formatted once per distinct flags and cached. */
+	const FString& GetEventFlagsText(uint64 Events) const;
+
+	/* Adds a record to input history, moving the record it evicts to the archive, and applies HistoryRetention. */
+	void AddHistoryRecord(const FInputBufferRecord& Record);
+
+	/* Moves records older than the latest NumKept ones to the archive, before input history drops them. */
+	void ArchiveOldestRecords(int32 NumKept);
+
+	/* Grows input history before a record is added if the oldest record would be evicted within the retention window. */
+	void GrowRetainedHistory();
+
+	/* Shrinks input history back to its capacity once records beyond it are out of the retention window. */
+	void ShrinkRetainedHistory();
+
+	/* Changes the capacity of input history with storage from the pool, keeping the latest records. */
+	void ResizeRetainedHistory(int32 NewMax);
+
+	/* Builds runtime events and key entries from EventSetups and TranslatedEvents, reusing entries of keys that are still bound. */
+	void RegisterEvents();
+
+	/* Returns names of given event flags from the cache, converting them if they are not cached. Bits without input events are ignored. */
+	const FEventNames& GetEventNames(uint64 Events) const;
+
+	void PrintRecordTo(FString& Out, const FInputBufferRecord& Record, bool bValid, bool bIncludeInvalidRecords) const;
+
+	void ProcessInput(UPlayerInput* PlayerInput, const bool bGamePaused);
+
+	void RecordEvent(uint64 EventIndex, class AInputBufferPlayerController* Controller);
+
+	/* Adds the current record to the input buffer, or prolongs the last record if their input events are the same. Returns whether a record is added. */
+	bool CommitCurrentRecord();
+
+	/* Matches a given input command against input history. */
+	bool MatchCommandHistory(class UInputCommand* Command, FInputCommandMatchResult* OutResult = nullptr) const;
+
+	/* Matches a given set of input commands against input history. Returns the matching command with the highest priority. */
+	class UInputCommand* MatchCommandSetHistory(class UInputCommandSet* CommandSet, FInputCommandMatchResult* OutResult) const;
+
+	/**
+	* Matches candidate commands of a set against input history, like FInputCommandMatcher::MatchSet, but attributes the cost of each command to its asset in stats captures.
+	*
+	* @param OutMatches (Optional) Set to whether each command matches. If null, matching stops at the first matching command.
+	* @param OutResult (Optional) Set to where the first matching command matches, or reset if none matches.
+	* @return The index of the first matching command, or INDEX_NONE if none matches.
+	*/
+	int32 MatchCommandSetCandidates(const class UInputCommandSet* CommandSet, TBitArray<>* OutMatches, FInputCommandMatchResult* OutResult) const;
+
+	/* Returns the program of an input command bound to this input buffer, binding it first if necessary. */
+	const FInputCommandProgram& GetBoundProgram(const class UInputCommand* Command) const;
+
+	/* Returns the programs of a set of input commands bound to this input buffer, binding them first if necessary. */
+	const FInputCommandSetProgram& GetBoundProgram(const class UInputCommandSet* CommandSet) const;
+
+	/* Grows the capacity of input history to the records needed by a set of input commands if bAutoSizeHistory is true. */
+	void GrowRequiredHistory(const class UInputCommandSet* CommandSet);
+
+	/* Checks bound commands again once records may differ in translated events alone, since they can be spread over more records then. */
+	void HandleTranslatedHistory();
+
+	/* Warns once if input history cannot hold the records needed by a newly bound input command or set, or if they are unbounded, i.e. INDEX_NONE. */
+	void CheckHistoryCapacity(int32 NumRecords, const UObject* Source) const;
+
+	/* Resolves a name table to bit flags of input events, or zero for unknown events. */
+	void ResolveNameTable(const TArray<FName>& Names, TArray<uint64, TInlineAllocator<32>>& OutNameFlags) const;
+
+	/* Reports recognition latency of a matched input command once per input record that triggers it. */
+	void ReportRecognition(const class UInputCommand* Command) const;
+
+	/* Returns the number of the latest records within a time limit, which stops at the first invalid record unless invalid records are included. */
+	int32 GetNumVisibleRecords(float TimeLimit, bool bIncludeInvalidRecords) const;
+
+	/* Writes all records in input history but the last one, which may still be prolonged, to the replay file. */
+	void RecordHistory();
+
+	/* Writes the last record in input history to the replay file once it is finished. */
+	void RecordLastRecord();
+
+};
+
+FORCEINLINE void FInputHistoryRecordView::GetEvents(TArray<FName>& OutEvents) const
+{
+	Owner.ConvertFlagsToEvents(Record.Events, OutEvents);
+}
+
+FORCEINLINE void FInputHistoryRecordView::GetTranslatedEvents(TArray<FName>& OutEvents) const
+{
+	Owner.ConvertFlagsToEvents(Record.TranslatedEvents, OutEvents);
+}
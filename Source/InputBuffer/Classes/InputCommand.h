@@ -1,122 +1,159 @@
-// Copyright 2017 Isaac Hsu. MIT License
-
-#pragma once
-
-#include "InputCommand.generated.h"
-
-
-USTRUCT(BlueprintType)
-struct FInputCommandEntry
-{
-	GENERATED_BODY()
-
-	FInputCommandEntry()
-		: MinDuration(0.f)
-		, MaxDuration(0.f)
-		, MinInterval(0.f)
-		, MaxInterval(0.f)
-		, bIgnoreOthers(false)
-	{}
-
-	/* Input events to match. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	TArray<FName> EventsToMatch;
-
-	/* Input events to ignore. Unused if bIgnoreOthers is true. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	TArray<FName> EventsToIgnore;
-
-	/* If true, ignore the presence of the other input events except EventsToMatch. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	bool bIgnoreOthers;
-
-	/* Minimal duration for input to be considered as valid. Should be used for input events of held type. Unused if zero. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 0, UIMin = 0))
-	float MinDuration;
-
-	/* Maximal duration for input to be considered as valid. Should be used for input events of held type. Unused if zero. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 0, UIMin = 0))
-	float MaxDuration;
-
-	/* Minimal time limit between input for this entry and the next one to be considered as valid. Unused if zero. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 0, UIMin = 0))
-	float MinInterval;
-
-	/* Maximal time limit between input for this entry and the next one to be considered as valid. Unused if zero. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 0, UIMin = 0))
-	float MaxInterval;
-
-	FORCEINLINE bool CheckDuration(float Duration) const
-	{
-		if (MaxDuration != 0.f && Duration > MaxDuration)
-		{
-			return false;
-		}
-		if (MinDuration != 0.f && Duration < MinDuration)
-		{
-			return false;
-		}
-
-		return true;
-	}
-
-	FORCEINLINE bool CheckInterval(float Interval) const
-	{
-		if (MinInterval != 0.f && Interval < MinInterval)
-		{
-			return false;
-		}
-		if (MaxInterval != 0.f && Interval > MaxInterval)
-		{
-			return false;
-		}
-
-		return true;
-	}
-};
-
-USTRUCT(BlueprintType)
-struct FInputCommandSequence
-{
-	GENERATED_BODY()
-
-	FInputCommandSequence() : bEnabled(true) {}
-
-	/** Whether this sequence is enabled. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	bool bEnabled;
-
-	/* A list of input snapshots to match. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	TArray<FInputCommandEntry> Entries;
-};
-
-/**
-* Represents an input command commonly found in fighting games, such as Quarter-Circle-Forward Punch.
-* Can be used with UInputBufferComponent to detect combinations of buttons.
-**/
-UCLASS(BlueprintType, Blueprintable, ClassGroup=(Input))
-class INPUTBUFFER_API UInputCommand : public UObject
-{
-	GENERATED_BODY()
-
-public:
-
-	/* Time limit of valid input. Unused if zero. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, AssetRegistrySearchable, Meta = (ClampMin = 0, UIMin = 0))
-	float TimeLimit;
-
-	/* Input events to ignore. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	TArray<FName> EventsToIgnore;
-
-	/* Each sequence contains a series of input snapshots to match. A command is considered matched if any of its sequences matches. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	TArray<FInputCommandSequence> Sequences;
-
-#if WITH_EDITORONLY_DATA
-	UPROPERTY(EditAnywhere, Category = "Thumbnail")
-	class UTexture2D* Thumbnail;
-#endif
-
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+#include "BufferedInputEventKit.h"
+#include "CompiledInputCommand.h"
+#include "InputCommand.generated.h"
+
+
+USTRUCT(BlueprintType)
+struct FInputCommandEntry
+{
+	GENERATED_BODY()
+
+	FInputCommandEntry()
+		: MinDuration(0.f)
+		, MaxDuration(0.f)
+		, MinInterval(0.f)
+		, MaxInterval(0.f)
+		, bIgnoreOthers(false)
+	{}
+
+	/* Input events to match. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<FName> EventsToMatch;
+
+	/* Input events to ignore. Unused if bIgnoreOthers is true. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<FName> EventsToIgnore;
+
+	/* If true, ignore the presence of the other input events except EventsToMatch. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bIgnoreOthers;
+
+	/* Minimal duration for input to be considered as valid. Should be used for input events of held type. Unused if zero. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 0, UIMin = 0))
+	float MinDuration;
+
+	/* Maximal duration for input to be considered as valid. Should be used for input events of held type. Unused if zero. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 0, UIMin = 0))
+	float MaxDuration;
+
+	/* Minimal time limit between input for this entry and the next one to be considered as valid. Unused if zero. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 0, UIMin = 0))
+	float MinInterval;
+
+	/* Maximal time limit between input for this entry and the next one to be considered as valid. Unused if zero. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 0, UIMin = 0))
+	float MaxInterval;
+
+	/* Checks a duration against the limits. If FrameRate is non-zero, the duration is in frames and the limits are rounded to whole frames. */
+	FORCEINLINE bool CheckDuration(float Duration, float FrameRate = 0.f) const
+	{
+		return FBufferedInputEventKit::CheckTimeLimits(Duration, MinDuration, MaxDuration, FrameRate);
+	}
+
+	/* Checks an interval against the limits. If FrameRate is non-zero, the interval is in frames and the limits are rounded to whole frames. */
+	FORCEINLINE bool CheckInterval(float Interval, float FrameRate = 0.f) const
+	{
+		return FBufferedInputEventKit::CheckTimeLimits(Interval, MinInterval, MaxInterval, FrameRate);
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FInputCommandSequence
+{
+	GENERATED_BODY()
+
+	FInputCommandSequence() : bEnabled(true) {}
+
+	/** Whether this sequence is enabled. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bEnabled;
+
+	/* A list of input snapshots to match. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<FInputCommandEntry> Entries;
+};
+
+/**
+* Represents an input command commonly found in fighting games, such as Quarter-Circle-Forward Punch.
+* Can be used with UInputBufferComponent to detect combinations of buttons.
+**/
+UCLASS(BlueprintType, Blueprintable, ClassGroup=(Input))
+class INPUTBUFFER_API UInputCommand : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	/* Time limit of valid input. Unused if zero. Change it with SetTimeLimit at runtime. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, AssetRegistrySearchable, Meta = (ClampMin = 0, UIMin = 0))
+	float TimeLimit;
+
+	/* Input events to ignore. Change them with SetEventsToIgnore at runtime. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<FName> EventsToIgnore;
+
+	/**
+	* Each sequence contains a series of input snapshots to match. A command is considered matched if any of its sequences matches.
+	* Change them with SetSequences at runtime.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	TArray<FInputCommandSequence> Sequences;
+
+	UInputCommand();
+
+	//~ Begin UObject Interface
+	virtual void Serialize(FArchive& Ar) override;
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+	//~ End UObject Interface
+
+	/* Returns the command compiled into a flat form, compiling it first if necessary. */
+	const FCompiledInputCommand& GetCompiledData() const;
+
+	/* Returns a number that changes whenever the command is compiled again, or zero if it is not compiled yet. */
+	FORCEINLINE uint32 GetCompiledSerial() const { return CompiledSerial; }
+
+	/* Returns a new serial number of compiled data. Unique among all input commands and command sets, so that an object at a reused address is never mistaken for a stale one. Thread-safe. */
+	static uint32 AllocateCompiledSerial();
+
+	/**
+	* Discards compiled data so that the command is compiled again when matched next time.
+	* Caution: Call this after modifying properties of the command directly in C++, or input buffers keep matching the old data. The setters below call it.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Command")
+	void InvalidateCompiledData();
+
+	/* Changes the time limit, so that input buffers match the command with the new limit from now on. */
+	UFUNCTION(BlueprintCallable, Category = "Input Command")
+	void SetTimeLimit(float NewTimeLimit);
+
+	/* Changes input events to ignore, so that input buffers match the command with the new events from now on. */
+	UFUNCTION(BlueprintCallable, Category = "Input Command")
+	void SetEventsToIgnore(const TArray<FName>& NewEventsToIgnore);
+
+	/* Changes the sequences, so that input buffers match the command with the new sequences from now on. */
+	UFUNCTION(BlueprintCallable, Category = "Input Command")
+	void SetSequences(const TArray<FInputCommandSequence>& NewSequences);
+
+#if WITH_EDITORONLY_DATA
+	UPROPERTY(EditAnywhere, Category = "Thumbnail")
+	class UTexture2D* Thumbnail;
+#endif
+
+private:
+
+	/* Flattens enabled sequences into compiled data. */
+	void Compile() const;
+
+	/* Loaded from cooked assets, or compiled on demand. */
+	mutable FCompiledInputCommand CompiledData;
+
+	mutable uint32 CompiledSerial;
+
 };
\ No newline at end of file
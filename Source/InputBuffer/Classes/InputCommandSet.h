@@ -0,0 +1,62 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+#include "CompiledInputCommand.h"
+#include "InputCommandSet.generated.h"
+
+/**
+* An ordered list of input commands, such as the move list of a character. Compiled as a unit and bound to an input buffer in one pass.
+* Earlier commands have higher priority when several of them match at the same time.
+**/
+UCLASS(BlueprintType, ClassGroup=(Input))
+class INPUTBUFFER_API UInputCommandSet : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	/* Input commands in order of priority. The first command has the highest priority. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<class UInputCommand*> Commands;
+
+	UInputCommandSet();
+
+	//~ Begin UObject Interface
+	virtual void Serialize(FArchive& Ar) override;
+	virtual void PostLoad() override;
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+	//~ End UObject Interface
+
+	/* Returns all the commands compiled as a unit, compiling them first if necessary. Null commands are compiled as commands that never match. */
+	const FCompiledInputCommandSet& GetCompiledData() const;
+
+	/* Returns a number that changes whenever the set is compiled again, or zero if it is not compiled yet. */
+	FORCEINLINE uint32 GetCompiledSerial() const { return CompiledSerial; }
+
+	/**
+	* Discards compiled data so that the set is compiled again when matched next time.
+	* Caution: Call this after modifying the set or its commands at runtime, or input buffers keep matching the old data.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Command Set")
+	void InvalidateCompiledData();
+
+private:
+
+	/* Combines compiled data of all the commands. */
+	void Compile() const;
+
+	/* Returns whether any command has been compiled again since the set was compiled or loaded. */
+	bool AreCommandsModified() const;
+
+	/* Loaded from cooked assets, or compiled on demand. */
+	mutable FCompiledInputCommandSet CompiledData;
+
+	mutable uint32 CompiledSerial;
+
+	/* Serial numbers of compiled data of the commands when the set was compiled, or when it was loaded from cooked assets. */
+	mutable TArray<uint32> CommandSerials;
+};
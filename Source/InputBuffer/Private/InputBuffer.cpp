@@ -1,22 +1,28 @@
-// Copyright 2017 Isaac Hsu. MIT License
-
-#include "InputBufferPrivatePCH.h"
-
-#define LOCTEXT_NAMESPACE "InputBuffer"
-
-DEFINE_LOG_CATEGORY(InputBufferLog)
-
-void FInputBufferModule::StartupModule()
-{
-	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
-}
-
-void FInputBufferModule::ShutdownModule()
-{
-	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
-	// we call this function before unloading the module.
-}
-
-#undef LOCTEXT_NAMESPACE
-	
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferPrivatePCH.h"
+#include "InputBufferCustomVersion.h"
+
+#define LOCTEXT_NAMESPACE "InputBuffer"
+
+DEFINE_LOG_CATEGORY(InputBufferLog)
+
+const FGuid FInputBufferCustomVersion::GUID(0x6A3F0C21, 0x4B7E4D19, 0x9C25E870, 0x1D4B6F53);
+
+// Register the custom version with core
+FCustomVersionRegistration GRegisterInputBufferCustomVersion(FInputBufferCustomVersion::GUID, FInputBufferCustomVersion::LatestVersion, TEXT("InputBufferVer"));
+
+void FInputBufferModule::StartupModule()
+{
+	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+}
+
+void FInputBufferModule::ShutdownModule()
+{
+	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
+	// we call this function before unloading the module.
+}
+
+#undef LOCTEXT_NAMESPACE
+	
 IMPLEMENT_MODULE(FInputBufferModule, InputBuffer)
\ No newline at end of file
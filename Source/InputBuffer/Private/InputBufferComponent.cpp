@@ -1,735 +1,1928 @@
-// Copyright 2017 Isaac Hsu. MIT License
-
-#include "InputBufferPrivatePCH.h"
-#include "InputBufferComponent.h"
-#include "InputBufferPlayerController.h"
-#include "InputCommand.h"
-
-//////////////////////////////////////////////////////////////////////////
-// UInputBufferComponent
-
-// Sets default values for this component's properties
-UInputBufferComponent::UInputBufferComponent()
-{
-	MaxInputHistory = 10;
-}
-
-void UInputBufferComponent::BeginPlay()
-{
-	Super::BeginPlay();
-
-	Initialize();
-}
-
-int32 UInputBufferComponent::Initialize()
-{
-	RuntimeEvents.Reset(EventSetups.Num() + TranslatedEvents.Num());
-	EventIndexMap.Empty(RuntimeEvents.Num());
-
-	KeyStates1.Reset();
-	KeyStates2.Reset();
-
-	TMap<FName, int32> KeyMappingIndexMap;
-	for (int Idx = 0; Idx < KeyMappings.Num(); Idx++)
-	{
-		auto& Mapping = KeyMappings[Idx];
-		if (Mapping.Name != NAME_None && Mapping.Keys.Num() > 0 && KeyMappingIndexMap.Find(Mapping.Name) == nullptr)
-		{
-			KeyMappingIndexMap.Add(Mapping.Name, Idx);
-		}
-	}
-
-	for (const auto& Setup : EventSetups)
-	{
-		if (Setup.bEnabled && Setup.Name != NAME_None && EventIndexMap.Find(Setup.Name) == nullptr)
-		{
-			if (RuntimeEvents.Num() >= FInputBufferRecord::MAX_EVENTS)
-			{
-				UE_LOG(InputBufferLog, Warning, TEXT("Cannot register input events more than %d."), FInputBufferRecord::MAX_EVENTS);
-				break;
-			}
-
-			// The use of a set makes sure there will be no duplicate keys.
-			TSet<FKey> KeySet;
-
-			for (const FKey& Key : Setup.Keys)
-			{
-				if (Key.IsValid())
-				{
-					KeySet.Add(Key);
-				}
-			}
-
-			if (Setup.KeyMappingName != NAME_None)
-			{
-				int32* Index = KeyMappingIndexMap.Find(Setup.KeyMappingName);
-				if (Index)
-				{
-					for (const FKey& Key : KeyMappings[*Index].Keys)
-					{
-						if (Key.IsValid())
-						{
-							KeySet.Add(Key);
-						}
-					}
-				}
-			}
-
-			if (KeySet.Num() > 0)
-			{
-				for (FKey& Key : KeySet)
-				{
-					if (KeyIndexMap.Find(Key) == nullptr)
-					{
-						int32 Index1 = KeyStates1.Add(false);
-						int32 Index2 = KeyStates2.Add(false);
-						check(Index1 == Index2);
-						KeyIndexMap.Add(Key, Index1);
-					}
-				}
-
-				int32 Index = RuntimeEvents.Add(Setup);
-				EventIndexMap.Add(Setup.Name, Index);
-				RuntimeEvents[Index].Keys = KeySet.Array();
-			}
-			else
-			{
-				UE_LOG(InputBufferLog, Warning, TEXT("Input event '%s' does not have any valid key mappings."), *Setup.Name.ToString());
-			}
-		}
-	}
-
-	for (FName Event : TranslatedEvents)
-	{
-		if (Event != NAME_None && EventIndexMap.Find(Event) == nullptr)
-		{
-			if (RuntimeEvents.Num() >= FInputBufferRecord::MAX_EVENTS)
-			{
-				UE_LOG(InputBufferLog, Warning, TEXT("Cannot register input events more than %d."), FInputBufferRecord::MAX_EVENTS);
-				break;
-			}
-
-			FBufferedInputEventSetup Setup;
-			Setup.Name = Event;
-			int32 Index = RuntimeEvents.Add(Setup);
-			EventIndexMap.Add(Setup.Name, Index);
-		}
-	}
-
-	check(KeyStates1.Num() == KeyStates2.Num());
-
-	PreviousKeyStates = &KeyStates1;
-	CurrentKeyStates = &KeyStates2;
-
-	InputHistory.Reset(MaxInputHistory);
-
-	return EventIndexMap.Num();
-}
-
-void UInputBufferComponent::OnPreProcessInput(UPlayerInput* PlayerInput, const bool bGamePaused)
-{
-}
-
-void UInputBufferComponent::OnPostProcessInput(UPlayerInput* PlayerInput, const bool bGamePaused)
-{
-	ProcessInput(PlayerInput, bGamePaused);
-}
-
-void UInputBufferComponent::ProcessInput(UPlayerInput* PlayerInput, const bool bGamePaused)
-{
-	// Reset the current record because we may add it to the input buffer later.
-	CurrentRecord.bValid = true;
-	CurrentRecord.StartTime = GetCurrentTime();
-	CurrentRecord.EndTime = CurrentRecord.StartTime;
-	CurrentRecord.Events = 0;
-	CurrentRecord.TranslatedEvents = 0;
-
-	auto Controller = Cast<AInputBufferPlayerController>(GetOwner());
-
-	if (PlayerInput)
-	{
-		Swap(PreviousKeyStates, CurrentKeyStates);
-
-		// Update key states so we can determine if a key is just pressed or released.
-		for (const auto& Pair : KeyIndexMap)
-		{
-			FKeyState* State = PlayerInput->GetKeyState(Pair.Key);
-			(*CurrentKeyStates)[Pair.Value] = State ? (State->bDown != 0) : false;
-		}
-
-		// Set event flags according key states
-		for (int32 Idx = 0; Idx < RuntimeEvents.Num(); Idx++)
-		{
-			const auto& Event = RuntimeEvents[Idx];
-
-			if (!bGamePaused || Event.bExecuteWhenPaused)
-			{
-				if (Event.Type == FBufferedInputEventType::Pressed)
-				{
-					for (const FKey& Key : Event.Keys)
-					{
-						int32* KeyIndex = KeyIndexMap.Find(Key);
-						if (KeyIndex)
-						{
-							if (!(*PreviousKeyStates)[*KeyIndex] && (*CurrentKeyStates)[*KeyIndex])
-							{
-								RecordEvent(Idx, Controller);
-								break;
-							}
-						}
-					}
-				}
-				else if (Event.Type == FBufferedInputEventType::Released)
-				{
-					for (const FKey& Key : Event.Keys)
-					{
-						int32* KeyIndex = KeyIndexMap.Find(Key);
-						if (KeyIndex)
-						{
-							if ((*PreviousKeyStates)[*KeyIndex] && !(*CurrentKeyStates)[*KeyIndex])
-							{
-								RecordEvent(Idx, Controller);
-								break;
-							}
-						}
-					}
-				}
-				else if (Event.Type == FBufferedInputEventType::Held)
-				{
-					for (const FKey& Key : Event.Keys)
-					{
-						int32* KeyIndex = KeyIndexMap.Find(Key);
-						if (KeyIndex)
-						{
-							if ((*CurrentKeyStates)[*KeyIndex])
-							{
-								RecordEvent(Idx, Controller);
-								break;
-							}
-						}
-					}
-				}
-			}
-		}
-	}
-
-	// Add the current record to the input buffer if the input events are different from the previous. Otherwise, just prolong the last record.
-	auto LastRecord = InputHistory.LastOrNull();
-	if (LastRecord && LastRecord->Events == CurrentRecord.Events && LastRecord->TranslatedEvents == CurrentRecord.TranslatedEvents)
-	{
-		LastRecord->EndTime = CurrentRecord.StartTime;
-	}
-	else
-	{
-		InputHistory.Add(CurrentRecord);
-	}
-
-	// Trigger PostBufferInput event when the current events are not empty.
-	if (CurrentRecord.Events != 0 && Controller)
-	{
-		Controller->PostBufferInput();
-	}
-}
-
-void UInputBufferComponent::RecordEvent(uint64 EventIndex, AInputBufferPlayerController* Controller)
-{
-	check(EventIndex < RuntimeEvents.Num());
-	check(Controller == GetOwner());
-
-	// Translate given input event and find out an event index for translated event
-	if (Controller)
-	{
-		FName OriginalEvent = RuntimeEvents[EventIndex].Name;
-		FName TranslatedEvent = Controller->TranslateInputEvent(OriginalEvent);
-		if (OriginalEvent != TranslatedEvent)
-		{
-			// Set the original event bit
-			CurrentRecord.TranslatedEvents |= (1LL << EventIndex);
-
-			int32* FoundIndex = EventIndexMap.Find(TranslatedEvent);
-			if (FoundIndex == nullptr)
-			{
-				if (TranslatedEvent == NAME_None)
-				{
-					return; // Skip event flag recording
-				}
-				else
-				{
-					UE_LOG(InputBufferLog, Warning, TEXT("Unknown input event '%s' translated from '%s'."), *TranslatedEvent.ToString(), *OriginalEvent.ToString());
-				}
-			}
-			else
-			{
-				EventIndex = *FoundIndex;
-			}
-		}
-	}
-
-	// Set the event bit
-	CurrentRecord.Events |= (1LL << EventIndex);
-}
-
-void UInputBufferComponent::ClearHistory()
-{
-	InputHistory.Reset(MaxInputHistory);
-}
-
-void UInputBufferComponent::InvalidateHistory()
-{
-	auto Record = InputHistory.GetData();
-	auto RecordEnd = Record + InputHistory.Num();
-	for (; Record != RecordEnd; Record++)
-	{
-		Record->bValid = false;
-	}
-}
-
-bool UInputBufferComponent::ConvertEventsToFlags(const TArray<FName>& Events, uint64& Flags) const
-{
-	bool bSucceeded = true;
-	for (int32 Idx = 0; Idx < Events.Num(); Idx++)
-	{
-		const int32* Index = EventIndexMap.Find(Events[Idx]);
-		if (Index)
-		{
-			Flags |= (1LL << *Index); // Set the event bit
-		}
-		else
-		{
-			bSucceeded = false; // Any unknown event means a failure.
-		}
-	}
-
-	return bSucceeded;
-}
-
-void UInputBufferComponent::ConvertFlagsToEvents(uint64 Flags, TArray<FName>& Events) const
-{
-	// TODO: Reduce complexity
-	for (int Idx = 0; Idx < RuntimeEvents.Num() && Flags != 0; Idx++)
-	{
-		if (Flags & 0x1)
-		{
-			Events.Add(RuntimeEvents[Idx].Name);
-		}
-
-		Flags >>= 1;
-	}
-}
-
-void UInputBufferComponent::GetCurrentEvents(TArray<FName>& Events) const
-{
-	ConvertFlagsToEvents(CurrentRecord.Events, Events);
-}
-
-const FInputBufferRecord* UInputBufferComponent::GetLastRecord(float TimeLimit, bool bSkipEmptyTrail) const
-{
-	if (bSkipEmptyTrail)
-	{
-		return GetLastNonEmptyRecord(TimeLimit);
-	}
-	else
-	{
-		return GetLastRecord(TimeLimit);
-	}
-}
-
-const FInputBufferRecord* UInputBufferComponent::GetLastRecord(float TimeLimit) const
-{
-	float CurrTime = GetCurrentTime();
-
-	for (auto It = InputHistory.CreateConstReverseIterator(); It; ++It)
-	{
-		const FInputBufferRecord& Record = *It;
-		if (Record.bValid && (CurrTime - Record.EndTime <= TimeLimit || TimeLimit == 0.f))
-		{
-			return &Record;
-		}
-		else
-		{
-			break;
-		}
-	}
-
-	return nullptr;
-}
-
-const FInputBufferRecord* UInputBufferComponent::GetLastNonEmptyRecord(float TimeLimit) const
-{
-	float CurrTime = GetCurrentTime();
-
-	for (auto It = InputHistory.CreateConstReverseIterator(); It; ++It)
-	{
-		const FInputBufferRecord& Record = *It;
-		if (Record.bValid && (CurrTime - Record.EndTime <= TimeLimit || TimeLimit == 0.f))
-		{
-			if (Record.Events != 0)
-			{
-				return &Record;
-			}
-		}
-		else
-		{
-			break;
-		}
-	}
-
-	return nullptr;
-}
-
-float UInputBufferComponent::GetLastEvents(TArray<FName>& Events, float TimeLimit, bool bSkipEmptyTrail) const
-{
-	const FInputBufferRecord* Record = GetLastRecord(TimeLimit, bSkipEmptyTrail);
-	if (Record)
-	{
-		ConvertFlagsToEvents(Record->Events, Events);
-		return Record->EndTime;
-	}
-	else
-	{
-		return 0.f;
-	}
-}
-
-void UInputBufferComponent::GetHistoryRecords(TArray<FInputHistoryRecord>& Records, float TimeLimit, bool bIncludeInvalidRecords) const
-{
-	float CurrTime = GetCurrentTime();
-
-	for (auto It = InputHistory.CreateConstReverseIterator(); It; ++It)
-	{
-		const auto& Record = *It;
-		if ((Record.bValid || bIncludeInvalidRecords) && (CurrTime - Record.EndTime <= TimeLimit || TimeLimit == 0.f))
-		{
-			FInputHistoryRecord Copy(Record.StartTime, Record.EndTime, Record.bValid);
-			ConvertFlagsToEvents(Record.Events, Copy.Events);
-			ConvertFlagsToEvents(Record.TranslatedEvents, Copy.TranslatedEvents);
-
-			Records.Add(Copy);
-		}
-		else
-		{
-			break;
-		}
-	}
-
-	Algo::Reverse(Records);
-}
-
-bool UInputBufferComponent::SetHistoryRecords(const TArray<FInputHistoryRecord>& Records)
-{
-	bool AllSucceeded = true;
-	InputHistory.Reset(Records.Num());
-
-	for (const auto& Record : Records)
-	{
-		uint64 Flags = 0;
-		uint64 TranslatedFlags = 0;
-		AllSucceeded = AllSucceeded && ConvertEventsToFlags(Record.Events, Flags);
-		AllSucceeded = AllSucceeded && ConvertEventsToFlags(Record.TranslatedEvents, TranslatedFlags);
-
-		InputHistory.Add(FInputBufferRecord(Record.StartTime, Record.EndTime, Flags, TranslatedFlags, Record.bValid));
-	}
-
-	return AllSucceeded;
-}
-
-bool UInputBufferComponent::MatchEvents(const TArray<FName>& EventsToMatch, const TArray<FName>& EventsToIgnore, float TimeLimit, bool bSkipEmptyTrail) const
-{
-	const FInputBufferRecord* Record = GetLastRecord(TimeLimit, bSkipEmptyTrail);
-	if (Record)
-	{
-		uint64 MatchingFlags = 0; // The bit flags of events to match.
-		if (ConvertEventsToFlags(EventsToMatch, MatchingFlags))
-		{
-			uint64 IgnoringFlags = 0; // The bit flags of events to ignore.
-			ConvertEventsToFlags(EventsToIgnore, IgnoringFlags);
-
-			if (CompareEventFlags(Record->Events, MatchingFlags, IgnoringFlags))
-			{
-				return true;
-			}
-		}
-	}
-
-	return false;
-}
-
-bool UInputBufferComponent::MatchCommand(class UInputCommand* Command) const
-{
-	if (Command == nullptr || InputHistory.Num() == 0)
-	{
-		return false; // because of nothing to match
-	}
-
-	uint64 OuterIgnoreFlags = 0;
-	ConvertEventsToFlags(Command->EventsToIgnore, OuterIgnoreFlags);
-
-	const float CurrTime = GetCurrentTime();
-
-	for (FInputCommandSequence& Sequence : Command->Sequences)
-	{
-		if (Sequence.bEnabled)
-		{
-			bool bRepeating = false; // Are we trying to repeat the current entry?
-			bool bCanRecede = false; // Can we rollback to the previous entry?
-			float CurrEntryStartTime = 0; // The start time of the oldest matching record for the current entry. Used to check durations of entries.
-			float CurrEntryEndTime = 0; // The end time of the latest matching record for the current entry. Used to check durations of entries.
-			float PrevEntryStartTime = 0; // The start time of the oldest matching record for the previous entry. Used to check durations and interval of entries.
-			float PrevEntryEndTime = 0; // The end time of the latest matching record for the previous entry. Used to check durations of entries.
-			int32 EntryIdx = Sequence.Entries.Num() - 1; // The index of the command entry to match in the current iteration.
-			auto It = InputHistory.CreateConstReverseIterator(); // Input history iterator.
-
-			while (EntryIdx >= 0)
-			{
-				const auto& Entry = Sequence.Entries[EntryIdx];
-				//if (Entry.EventsToMatch.Num() == 0)
-				//{
-				//	break; // because of nothing to match
-				//}
-
-				const auto& Record = *It;
-				if (!Record.bValid)
-				{
-					if (bRepeating && EntryIdx == 0)
-					{
-						if (!Entry.CheckDuration(CurrEntryEndTime - CurrEntryStartTime))
-						{
-							break;
-						}
-						// Even if we failed to repeat the first entry, command recognition still succeeds since we have found matching records for all entries.
-						return true;
-					}
-					else
-					{
-						break; // Need not check the previous records since they should be invalid too.
-					}
-				}
-
-				if (CurrTime - Record.EndTime > Command->TimeLimit && Command->TimeLimit != 0.f && !bRepeating)
-				{
-					break;
-				}
-
-				//TArray<FName> RecordedEvents;
-				//ConvertFlagsToEvents(Record.Events, RecordedEvents);
-
-				bool bMatched = false; // Whether the current record matches the current entry?
-				bool bNextEntry = true; // Should we advance to the next entry in the next iteraion?
-				bool bNextRecord = true; // Should we advance to the next record in the next iteraion?
-				uint64 MatchingFlags = 0; // The bit flags of events to match.
-				uint64 IgnoringFlags = 0; // The bit flags of events to ignore.
-				if (ConvertEventsToFlags(Entry.EventsToMatch, MatchingFlags))
-				{
-					// For events to match, unknown events means mismatch. But for events to ignore, unknown events are omitted.
-					ConvertEventsToFlags(Entry.EventsToIgnore, IgnoringFlags);
-
-					if (Entry.bIgnoreOthers)
-					{
-						bMatched = HasEventFlags(Record.Events, MatchingFlags);
-					}
-					else
-					{
-						IgnoringFlags |= OuterIgnoreFlags;
-						bMatched = CompareEventFlags(Record.Events, MatchingFlags, IgnoringFlags);
-					}
-				}
-				else
-				{
-					break; // Fails since we cannot find flags for unknown events.
-				}
-
-				if (bMatched)
-				{
-					if (CurrEntryEndTime == 0)
-					{
-						// Check limits of the duration of the previous entry.
-						if (PrevEntryEndTime != 0.f)
-						{
-							const auto& PrevEntry = Sequence.Entries[EntryIdx + 1];
-							if (!PrevEntry.CheckDuration(PrevEntryEndTime - PrevEntryStartTime))
-							{
-								break;
-							}
-						}
-
-						// Check limits of the internal between the current entry and previous entry.
-						if (PrevEntryStartTime != 0.f && !Entry.CheckInterval(PrevEntryStartTime - Record.EndTime))
-						{
-							break;
-						}
-
-						CurrEntryEndTime = Record.EndTime;
-					}
-					CurrEntryStartTime = Record.StartTime;
-
-					if (EntryIdx > 0)
-					{
-						bCanRecede = true;
-						bRepeating = false;
-					}
-					else
-					{
-						bCanRecede = false;
-						bRepeating = true;
-						bNextEntry = false;
-					}
-				}
-				else if (bRepeating && EntryIdx == 0)
-				{
-					if (!Entry.CheckDuration(CurrEntryEndTime - CurrEntryStartTime))
-					{
-						break;
-					}
-					// Even if we failed to repeat the first entry, command recognition still succeeds since we have found matching records for all entries.
-					return true;
-				}
-				else if (Record.Events == 0)
-				{
-					// Skip the current record when no input.
-					bCanRecede = false;
-					bRepeating = false;
-					bNextEntry = false;
-				}
-				else if (bCanRecede)
-				{
-					// When failing to match the current entry, we try the previous entry if possible.
-					bCanRecede = false;
-					bRepeating = true;
-					bNextRecord = false;
-					bNextEntry = false;
-					EntryIdx++;
-					check(EntryIdx < Sequence.Entries.Num());
-
-					CurrEntryStartTime = PrevEntryStartTime;
-					CurrEntryEndTime = PrevEntryEndTime;
-					PrevEntryStartTime = 0.f;
-					PrevEntryEndTime = 0.f;
-				}
-				else
-				{
-					break; // Fails due to mismatch.
-				}
-
-				if (bNextRecord)
-				{
-					++It;
-					if (!It) // If there is no remaining history.
-					{
-						if (EntryIdx == 0 && bMatched)
-						{
-							if (!Entry.CheckDuration(CurrEntryEndTime - CurrEntryStartTime))
-							{
-								break;
-							}
-
-							return true; // since we have checked all the entries and didn't fail
-						}
-						else
-						{
-							break; // Fails because of mismatch or no remaining history to match the next entry.
-						}
-					}
-				}
-
-				if (bNextEntry)
-				{
-					if (CurrEntryEndTime != 0)
-					{
-						PrevEntryStartTime = CurrEntryStartTime;
-						PrevEntryEndTime = CurrEntryEndTime;
-						CurrEntryStartTime = 0.f;
-						CurrEntryEndTime = 0.f;
-					}
-
-					EntryIdx--;
-				}
-			}
-
-			if (EntryIdx == -1)
-			{
-				return true; // since we have checked all the entries and didn't fail
-			}
-		}
-	}
-
-	return false;
-}
-
-float UInputBufferComponent::GetCurrentTime() const
-{
-	UWorld* World = GetWorld();
-	return World ? World->GetRealTimeSeconds() : 0.f;
-}
-
-FString UInputBufferComponent::EventFlagsToString(uint64 Events, const FString& Separator) const
-{
-	FString Result;
-	bool bFirst = true;
-	for (int Idx = 0; Idx < RuntimeEvents.Num(); Idx++)
-	{
-		if (Events & 0x1)
-		{
-			if (bFirst)
-			{
-				bFirst = false;
-			}
-			else
-			{
-				Result += Separator;
-			}
-
-			Result += RuntimeEvents[Idx].Name.ToString();
-		}
-
-		Events >>= 1;
-	}
-
-	return Result;
-}
-
-FString UInputBufferComponent::Print(int32 MaxRecords, bool bIncludeInvalidRecords, bool bReverseChronological) const
-{
-	FString Result;
-
-	if (MaxRecords == 0)
-	{
-		MaxRecords = InputHistory.Num();
-	}
-	else
-	{
-		MaxRecords = FMath::Clamp(MaxRecords, 0, InputHistory.Num());
-	}
-
-	if (bReverseChronological)
-	{
-		int32 Count = 0;
-		for (auto It = InputHistory.CreateConstReverseIterator(); It && Count < MaxRecords; ++It, ++Count)
-		{
-			if (It->bValid)
-			{
-				Result += FString::Printf(TEXT("[%s] "), *EventFlagsToString(It->Events));
-			}
-			else if (bIncludeInvalidRecords)
-			{
-				Result += FString::Printf(TEXT("(%s) "), *EventFlagsToString(It->Events));
-			}
-		}
-	}
-	else
-	{
-		int32 StartIndex = InputHistory.Num() - MaxRecords;
-		for (auto It = InputHistory.CreateConstIterator(StartIndex); It; ++It)
-		{
-			if (It->bValid)
-			{
-				Result += FString::Printf(TEXT("[%s] "), *EventFlagsToString(It->Events));
-			}
-			else if (bIncludeInvalidRecords)
-			{
-				Result += FString::Printf(TEXT("(%s) "), *EventFlagsToString(It->Events));
-			}
-		}
-	}
-
-	return Result;
-}
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferPrivatePCH.h"
+#include "InputBufferComponent.h"
+#include "EventBitPermutation.h"
+#include "InputBufferPlayerController.h"
+#include "InputCommand.h"
+#include "InputCommandSet.h"
+#include "InputBufferLatency.h"
+#include "InputHistoryPool.h"
+
+DECLARE_CYCLE_STAT(TEXT("ProcessInput"), STAT_InputBuffer_ProcessInput, STATGROUP_InputBuffer);
+DECLARE_CYCLE_STAT(TEXT("RecordEvent"), STAT_InputBuffer_RecordEvent, STATGROUP_InputBuffer);
+DECLARE_CYCLE_STAT(TEXT("MatchCommand"), STAT_InputBuffer_MatchCommand, STATGROUP_InputBuffer);
+DECLARE_CYCLE_STAT(TEXT("MatchCommandSet"), STAT_InputBuffer_MatchCommandSet, STATGROUP_InputBuffer);
+DECLARE_CYCLE_STAT(TEXT("MatchEvents"), STAT_InputBuffer_MatchEvents, STATGROUP_InputBuffer);
+DECLARE_CYCLE_STAT(TEXT("GetHistoryRecords"), STAT_InputBuffer_GetHistoryRecords, STATGROUP_InputBuffer);
+DECLARE_CYCLE_STAT(TEXT("VisitHistory"), STAT_InputBuffer_VisitHistory, STATGROUP_InputBuffer);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Records Appended"), STAT_InputBuffer_RecordsAppended, STATGROUP_InputBuffer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Records Extended"), STAT_InputBuffer_RecordsExtended, STATGROUP_InputBuffer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Commands Evaluated"), STAT_InputBuffer_CommandsEvaluated, STATGROUP_InputBuffer);
+DECLARE_DWORD_COUNTER_STAT(TEXT("History Records Visited"), STAT_InputBuffer_RecordsVisited, STATGROUP_InputBuffer);
+
+/* Counts visited history records locally and adds them to stats once when going out of scope. */
+struct FInputBufferVisitCounter
+{
+	FInputBufferVisitCounter() : Count(0) {}
+
+	~FInputBufferVisitCounter()
+	{
+		INC_DWORD_STAT_BY(STAT_InputBuffer_RecordsVisited, Count);
+	}
+
+	uint32 Count;
+};
+
+/**
+* Finds or adds the entry of an object in a map keyed by weak pointers. Entries of destroyed objects are removed whenever the map doubles in size,
+* so that maps of input commands do not grow without bound when commands are created and destroyed at runtime.
+*/
+template <typename ObjectType, typename ValueType>
+static ValueType& FindOrAddObjectEntry(TMap<TWeakObjectPtr<const ObjectType>, ValueType>& Map, const ObjectType* Object)
+{
+	const TWeakObjectPtr<const ObjectType> Key(Object);
+	if (ValueType* Value = Map.Find(Key))
+	{
+		return *Value;
+	}
+
+	if (Map.Num() >= 16 && FMath::IsPowerOfTwo(Map.Num()))
+	{
+		for (auto It = Map.CreateIterator(); It; ++It)
+		{
+			if (!It.Key().IsValid())
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+
+	return Map.Add(Key);
+}
+
+/* The next layout version of input events. Shared by all input buffers, so a mask resolved against one input buffer is stale for any other. */
+static uint32 NextEventLayoutVersion = 1;
+
+/* Fixed-size part of an input buffer snapshot, which is followed by history records and key states. */
+struct FInputBufferSnapshotHeader
+{
+	/* Event bits of records mean nothing under another layout, even if the sizes match. */
+	uint32 EventLayoutVersion;
+	/* Records archived after the snapshot are evicted again when input is simulated again, so they are removed from the archive on restoration. */
+	uint32 NumArchivedRecords;
+	/* Records written to a replay after the snapshot are removed by a single operation on restoration, if the replay history is the same. */
+	uint32 RecorderClearSerial;
+	uint32 NumRecordedRecords;
+	int32 HistoryCapacity;
+	int32 NumKeyWords;
+	int32 NumRecords;
+	int32 TailIndex;
+	int32 NumValidRecords;
+	uint32 bKeyStatesSwapped;
+	int32 SimulationFrame;
+	FInputBufferRecord CurrentRecord;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// UInputBufferComponent
+
+// Sets default values for this component's properties
+UInputBufferComponent::UInputBufferComponent()
+{
+	MaxInputHistory = 10;
+	bAutoSizeHistory = false;
+	HistoryRetention = 0.f;
+	MaxRetainedHistory = 64;
+	MaxArchivedHistory = 0;
+	RequiredHistory = 0;
+	bWarnedHistoryCapacity = false;
+	bTranslatedHistory = false;
+	bFrameIndexedSimulation = false;
+	SimulationFrameRate = 60.f;
+	ClockSource = EInputBufferClockSource::RealTime;
+	ClockTime = 0.f;
+	ClockFrame = MAX_uint64;
+	SimulationFrame = 0;
+	EventLayoutVersion = 0;
+	PreviousKeyStates = nullptr;
+	CurrentKeyStates = nullptr;
+	PendingInputCycles = 0;
+	LastInputCycles = 0;
+	LastInputSerial = 0;
+	NumAppendedRecords = 0;
+	bPlayingBack = false;
+	PlaybackTime = 0.f;
+	PlaybackFrameRate = 0.f;
+}
+
+void UInputBufferComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Initialize();
+}
+
+void UInputBufferComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	StopRecording();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UInputBufferComponent::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	// Input history and runtime event tables
+	SIZE_T Size = InputHistory.GetAllocatedSize() + RuntimeEvents.GetAllocatedSize() + EventIndexMap.GetAllocatedSize();
+	for (const FBufferedInputEventSetup& Event : RuntimeEvents)
+	{
+		Size += Event.Keys.GetAllocatedSize();
+	}
+
+	// Key maps and states
+	Size += KeyIndexMap.GetAllocatedSize() + KeyStates1.GetAllocatedSize() + KeyStates2.GetAllocatedSize();
+
+	// Compiled command data and caches
+	Size += BoundCommands.GetAllocatedSize();
+	for (const auto& Pair : BoundCommands)
+	{
+		Size += Pair.Value.Program.Sequences.GetAllocatedSize() + Pair.Value.Program.Entries.GetAllocatedSize();
+	}
+	Size += BoundCommandSets.GetAllocatedSize() + CommandSetMatches.GetAllocatedSize();
+	for (const auto& Pair : BoundCommandSets)
+	{
+		Size += Pair.Value.Program.GetAllocatedSize();
+	}
+	Size += ArchivedHistory.GetAllocatedSize() + ReportedLatencySerials.GetAllocatedSize();
+	for (int32 Idx = 0; Idx < EventNameCache.Capacity; Idx++)
+	{
+		const FEventNames& Names = EventNameCache.GetSlotValues()[Idx];
+		Size += Names.Names.GetAllocatedSize() + Names.Text.GetAllocatedSize();
+	}
+
+	if (Recorder.IsValid())
+	{
+		Size += sizeof(FInputBufferRecorder) + Recorder->GetAllocatedSize();
+	}
+
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Size);
+}
+
+int32 UInputBufferComponent::Initialize()
+{
+	if (IsRecording())
+	{
+		UE_LOG(InputBufferLog, Warning, TEXT("Recording stops because the input buffer is initialized again."));
+		StopRecording();
+	}
+
+	ClockFrame = MAX_uint64;
+
+	// Start from fresh key states.
+	KeyIndexMap.Reset();
+	KeyStates1.Reset();
+	KeyStates2.Reset();
+
+	PreviousKeyStates = &KeyStates1;
+	CurrentKeyStates = &KeyStates2;
+
+	RegisterEvents();
+
+	InputHistory.Reset(GetHistoryCapacity());
+	ArchivedHistory.Reset();
+	ArchivedHistory.SetMaxRecords(MaxArchivedHistory);
+
+	return EventIndexMap.Num();
+}
+
+int32 UInputBufferComponent::Reinitialize()
+{
+	if (PreviousKeyStates == nullptr)
+	{
+		return Initialize(); // since there is nothing to keep
+	}
+
+	if (IsRecording())
+	{
+		UE_LOG(InputBufferLog, Warning, TEXT("Recording stops because input events are registered again."));
+		StopRecording();
+	}
+
+	TArray<FName, TInlineAllocator<FInputBufferRecord::MAX_EVENTS>> OldEvents;
+	for (const auto& Event : RuntimeEvents)
+	{
+		OldEvents.Add(Event.Name);
+	}
+
+	RegisterEvents();
+
+	// Move each event bit to where its event is registered now, unless events are only appended.
+	int32 NewIndices[FInputBufferRecord::MAX_EVENTS];
+	bool bMoved = false;
+	for (int32 Idx = 0; Idx < OldEvents.Num(); Idx++)
+	{
+		const int32* Index = EventIndexMap.Find(OldEvents[Idx]);
+		NewIndices[Idx] = Index ? *Index : INDEX_NONE;
+		bMoved = bMoved || NewIndices[Idx] != Idx;
+	}
+
+	if (bMoved)
+	{
+		FEventBitPermutation Permutation;
+		Permutation.Build(NewIndices, OldEvents.Num());
+
+		for (auto It = InputHistory.CreateIterator(); It; ++It)
+		{
+			It->Events = Permutation.Apply(It->Events);
+			It->TranslatedEvents = Permutation.Apply(It->TranslatedEvents);
+		}
+
+		CurrentRecord.Events = Permutation.Apply(CurrentRecord.Events);
+		CurrentRecord.TranslatedEvents = Permutation.Apply(CurrentRecord.TranslatedEvents);
+
+		ArchivedHistory.RemapEvents(Permutation);
+	}
+
+	// Keep the latest records if the capacity changes.
+	if (InputHistory.Max() != GetHistoryCapacity())
+	{
+		ArchiveOldestRecords(GetHistoryCapacity());
+		InputHistory.SetMax(GetHistoryCapacity());
+	}
+
+	return EventIndexMap.Num();
+}
+
+void UInputBufferComponent::RegisterEvents()
+{
+	RuntimeEvents.Reset(EventSetups.Num() + TranslatedEvents.Num());
+	EventIndexMap.Reset();
+	EventNameCache.Reset();
+	BoundCommands.Empty();
+	BoundCommandSets.Empty();
+
+	// Zero stands for an unresolved mask.
+	EventLayoutVersion = NextEventLayoutVersion++;
+	if (NextEventLayoutVersion == 0)
+	{
+		NextEventLayoutVersion = 1;
+	}
+
+	// Keys still bound keep their entries and states, so a key held while events are registered again is not pressed again.
+	TSet<FKey> BoundKeys;
+
+	TMap<FName, int32> KeyMappingIndexMap;
+	for (int Idx = 0; Idx < KeyMappings.Num(); Idx++)
+	{
+		auto& Mapping = KeyMappings[Idx];
+		if (Mapping.Name != NAME_None && Mapping.Keys.Num() > 0 && KeyMappingIndexMap.Find(Mapping.Name) == nullptr)
+		{
+			KeyMappingIndexMap.Add(Mapping.Name, Idx);
+		}
+	}
+
+	for (const auto& Setup : EventSetups)
+	{
+		if (Setup.bEnabled && Setup.Name != NAME_None && EventIndexMap.Find(Setup.Name) == nullptr)
+		{
+			if (RuntimeEvents.Num() >= FInputBufferRecord::MAX_EVENTS)
+			{
+				UE_LOG(InputBufferLog, Warning, TEXT("Cannot register input events more than %d."), FInputBufferRecord::MAX_EVENTS);
+				break;
+			}
+
+			// The use of a set makes sure there will be no duplicate keys.
+			TSet<FKey> KeySet;
+
+			for (const FKey& Key : Setup.Keys)
+			{
+				if (Key.IsValid())
+				{
+					KeySet.Add(Key);
+				}
+			}
+
+			if (Setup.KeyMappingName != NAME_None)
+			{
+				int32* Index = KeyMappingIndexMap.Find(Setup.KeyMappingName);
+				if (Index)
+				{
+					for (const FKey& Key : KeyMappings[*Index].Keys)
+					{
+						if (Key.IsValid())
+						{
+							KeySet.Add(Key);
+						}
+					}
+				}
+			}
+
+			if (KeySet.Num() > 0)
+			{
+				for (const FKey& Key : KeySet)
+				{
+					BoundKeys.Add(Key);
+				}
+
+				int32 Index = RuntimeEvents.Add(Setup);
+				EventIndexMap.Add(Setup.Name, Index);
+				RuntimeEvents[Index].Keys = KeySet.Array();
+			}
+			else
+			{
+				UE_LOG(InputBufferLog, Warning, TEXT("Input event '%s' does not have any valid key mappings."), *Setup.Name.ToString());
+			}
+		}
+	}
+
+	for (FName Event : TranslatedEvents)
+	{
+		if (Event != NAME_None && EventIndexMap.Find(Event) == nullptr)
+		{
+			if (RuntimeEvents.Num() >= FInputBufferRecord::MAX_EVENTS)
+			{
+				UE_LOG(InputBufferLog, Warning, TEXT("Cannot register input events more than %d."), FInputBufferRecord::MAX_EVENTS);
+				break;
+			}
+
+			FBufferedInputEventSetup Setup;
+			Setup.Name = Event;
+			int32 Index = RuntimeEvents.Add(Setup);
+			EventIndexMap.Add(Setup.Name, Index);
+		}
+	}
+
+	// Keys no longer bound are no longer polled, and their state indices are reused by newly bound keys,
+	// so switching between key sets does not grow key states or snapshots.
+	TArray<int32, TInlineAllocator<16>> FreeIndices;
+	for (auto It = KeyIndexMap.CreateIterator(); It; ++It)
+	{
+		if (!BoundKeys.Contains(It.Key()))
+		{
+			FreeIndices.Add(It.Value());
+			It.RemoveCurrent();
+		}
+	}
+
+	for (const FKey& Key : BoundKeys)
+	{
+		if (KeyIndexMap.Find(Key) == nullptr)
+		{
+			if (FreeIndices.Num() > 0)
+			{
+				const int32 Index = FreeIndices.Pop(false);
+				KeyStates1[Index] = false;
+				KeyStates2[Index] = false;
+				KeyIndexMap.Add(Key, Index);
+			}
+			else
+			{
+				int32 Index1 = KeyStates1.Add(false);
+				int32 Index2 = KeyStates2.Add(false);
+				check(Index1 == Index2);
+				KeyIndexMap.Add(Key, Index1);
+			}
+		}
+	}
+
+	check(KeyStates1.Num() == KeyStates2.Num());
+}
+
+void UInputBufferComponent::OnPreProcessInput(UPlayerInput* PlayerInput, const bool bGamePaused)
+{
+}
+
+void UInputBufferComponent::OnPostProcessInput(UPlayerInput* PlayerInput, const bool bGamePaused)
+{
+	ProcessInput(PlayerInput, bGamePaused);
+}
+
+void UInputBufferComponent::ProcessInput(UPlayerInput* PlayerInput, const bool bGamePaused)
+{
+	SCOPE_CYCLE_COUNTER(STAT_InputBuffer_ProcessInput);
+
+	// Time of the first key event since the last frame, if latency is tracked.
+	const uint64 SourceCycles = PendingInputCycles;
+	PendingInputCycles = 0;
+
+	// Reset the current record because we may add it to the input buffer later.
+	CurrentRecord.bValid = true;
+	CurrentRecord.StartTime = GetCurrentTime();
+	CurrentRecord.EndTime = CurrentRecord.StartTime;
+	CurrentRecord.Events = 0;
+	CurrentRecord.TranslatedEvents = 0;
+
+	auto Controller = Cast<AInputBufferPlayerController>(GetOwner());
+
+	if (PlayerInput)
+	{
+		Swap(PreviousKeyStates, CurrentKeyStates);
+
+		// Update key states so we can determine if a key is just pressed or released.
+		for (const auto& Pair : KeyIndexMap)
+		{
+			FKeyState* State = PlayerInput->GetKeyState(Pair.Key);
+			(*CurrentKeyStates)[Pair.Value] = State ? (State->bDown != 0) : false;
+		}
+
+		// Set event flags according key states
+		for (int32 Idx = 0; Idx < RuntimeEvents.Num(); Idx++)
+		{
+			const auto& Event = RuntimeEvents[Idx];
+
+			if (!bGamePaused || Event.bExecuteWhenPaused)
+			{
+				if (Event.Type == FBufferedInputEventType::Pressed)
+				{
+					for (const FKey& Key : Event.Keys)
+					{
+						int32* KeyIndex = KeyIndexMap.Find(Key);
+						if (KeyIndex)
+						{
+							if (!(*PreviousKeyStates)[*KeyIndex] && (*CurrentKeyStates)[*KeyIndex])
+							{
+								RecordEvent(Idx, Controller);
+								break;
+							}
+						}
+					}
+				}
+				else if (Event.Type == FBufferedInputEventType::Released)
+				{
+					for (const FKey& Key : Event.Keys)
+					{
+						int32* KeyIndex = KeyIndexMap.Find(Key);
+						if (KeyIndex)
+						{
+							if ((*PreviousKeyStates)[*KeyIndex] && !(*CurrentKeyStates)[*KeyIndex])
+							{
+								RecordEvent(Idx, Controller);
+								break;
+							}
+						}
+					}
+				}
+				else if (Event.Type == FBufferedInputEventType::Held)
+				{
+					for (const FKey& Key : Event.Keys)
+					{
+						int32* KeyIndex = KeyIndexMap.Find(Key);
+						if (KeyIndex)
+						{
+							if ((*CurrentKeyStates)[*KeyIndex])
+							{
+								RecordEvent(Idx, Controller);
+								break;
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	if (bFrameIndexedSimulation)
+	{
+		return; // Sampled events are buffered when they are submitted through SimulateFrame.
+	}
+
+	if (CommitCurrentRecord() && CurrentRecord.Events != 0 && SourceCycles != 0)
+	{
+		LastInputCycles = SourceCycles;
+		LastInputSerial = NumAppendedRecords;
+		FInputBufferLatencyTracker::Get().AddIngestion(SourceCycles);
+	}
+
+	// Trigger PostBufferInput event when the current events are not empty.
+	if (CurrentRecord.Events != 0 && Controller)
+	{
+		Controller->PostBufferInput();
+	}
+}
+
+bool UInputBufferComponent::CommitCurrentRecord()
+{
+	// Add the current record to the input buffer if the input events are different from the previous. Otherwise, just prolong the last record.
+	auto LastRecord = InputHistory.LastOrNull();
+	if (LastRecord && LastRecord->Events == CurrentRecord.Events && LastRecord->TranslatedEvents == CurrentRecord.TranslatedEvents)
+	{
+		LastRecord->EndTime = CurrentRecord.StartTime;
+		INC_DWORD_STAT(STAT_InputBuffer_RecordsExtended);
+
+		if (HistoryRetention > 0.f && !bFrameIndexedSimulation)
+		{
+			ShrinkRetainedHistory();
+		}
+
+		return false;
+	}
+	else
+	{
+		// The last record is finished now, so it can be recorded.
+		RecordLastRecord();
+
+		AddHistoryRecord(CurrentRecord);
+		NumAppendedRecords++;
+		INC_DWORD_STAT(STAT_InputBuffer_RecordsAppended);
+		return true;
+	}
+}
+
+void UInputBufferComponent::AddHistoryRecord(const FInputBufferRecord& Record)
+{
+	if (Record.TranslatedEvents != 0 && !bTranslatedHistory)
+	{
+		HandleTranslatedHistory();
+	}
+
+	// Played back records go through retention too, so played back history grows and shrinks like the recorded one did.
+	const bool bRetaining = HistoryRetention > 0.f && !bFrameIndexedSimulation;
+	if (bRetaining)
+	{
+		GrowRetainedHistory();
+	}
+
+	// A full history evicts its oldest record.
+	if (InputHistory.Num() > 0 && InputHistory.Num() == InputHistory.Max())
+	{
+		ArchiveOldestRecords(InputHistory.Max() - 1);
+	}
+
+	InputHistory.Add(Record);
+
+	if (bRetaining)
+	{
+		ShrinkRetainedHistory();
+	}
+}
+
+void UInputBufferComponent::ArchiveOldestRecords(int32 NumKept)
+{
+	if (MaxArchivedHistory <= 0)
+	{
+		return;
+	}
+
+	// Oldest first, each keeping its effective validity.
+	for (int32 Idx = InputHistory.Num() - 1; Idx >= NumKept; Idx--)
+	{
+		FInputBufferRecord Evicted = *InputHistory.LastOrNull(Idx);
+		Evicted.bValid = InputHistory.IsValidRecord(Idx);
+		ArchivedHistory.Add(Evicted);
+	}
+}
+
+void UInputBufferComponent::GrowRetainedHistory()
+{
+	// The capacity of the history is kept apart from its storage, which may be larger when taken from the pool.
+	const int32 Capacity = InputHistory.Max();
+	if (Capacity == 0 || InputHistory.Num() < Capacity || Capacity >= MaxRetainedHistory)
+	{
+		return; // since nothing is evicted, or the history cannot grow further
+	}
+
+	const float Retention = ScaleTimeLimit(HistoryRetention, GetTimeLimitFrameRate());
+	if (GetCurrentTime() - InputHistory.LastOrNull(Capacity - 1)->EndTime <= Retention)
+	{
+		ResizeRetainedHistory(FMath::Min(Capacity * 2, MaxRetainedHistory));
+	}
+}
+
+void UInputBufferComponent::ShrinkRetainedHistory()
+{
+	const int32 Capacity = GetHistoryCapacity();
+	if (InputHistory.Max() <= Capacity)
+	{
+		return;
+	}
+
+	// Records are in chronological order, so if the latest record beyond the capacity is out of the window, all older ones are too.
+	const FInputBufferRecord* Record = InputHistory.LastOrNull(Capacity);
+	const float Retention = ScaleTimeLimit(HistoryRetention, GetTimeLimitFrameRate());
+	if (Record == nullptr || GetCurrentTime() - Record->EndTime > Retention)
+	{
+		ResizeRetainedHistory(Capacity);
+	}
+}
+
+void UInputBufferComponent::ResizeRetainedHistory(int32 NewMax)
+{
+	FInputHistoryPool& Pool = FInputHistoryPool::Get();
+
+	ArchiveOldestRecords(NewMax);
+
+	TArray<FInputBufferRecord> Storage;
+	Pool.Acquire(NewMax, Storage);
+	InputHistory.ExchangeStorage(Storage, NewMax);
+	Pool.Release(Storage);
+}
+
+void UInputBufferComponent::OnInputKey(const FKey& Key)
+{
+	if (PendingInputCycles == 0 && KeyIndexMap.Contains(Key) && FInputBufferLatencyTracker::IsEnabled())
+	{
+		PendingInputCycles = FPlatformTime::Cycles64();
+	}
+}
+
+void UInputBufferComponent::SimulateFrame(int32 FrameIndex, uint64 Events, uint64 TranslatedEvents)
+{
+	check(bFrameIndexedSimulation);
+
+	SimulationFrame = FrameIndex;
+
+	CurrentRecord.bValid = true;
+	CurrentRecord.StartTime = (float)FrameIndex;
+	CurrentRecord.EndTime = CurrentRecord.StartTime;
+	CurrentRecord.Events = Events;
+	CurrentRecord.TranslatedEvents = TranslatedEvents;
+
+	CommitCurrentRecord();
+}
+
+bool UInputBufferComponent::SimulateFrameEvents(int32 FrameIndex, const TArray<FName>& Events)
+{
+	if (!bFrameIndexedSimulation)
+	{
+		UE_LOG(InputBufferLog, Warning, TEXT("SimulateFrameEvents can be called only in frame-indexed simulation."));
+		return false;
+	}
+
+	uint64 Flags = 0;
+	bool bSucceeded = ConvertEventsToFlags(Events, Flags);
+	SimulateFrame(FrameIndex, Flags);
+
+	return bSucceeded;
+}
+
+void UInputBufferComponent::RecordEvent(uint64 EventIndex, AInputBufferPlayerController* Controller)
+{
+	SCOPE_CYCLE_COUNTER(STAT_InputBuffer_RecordEvent);
+
+	check(EventIndex < RuntimeEvents.Num());
+	check(Controller == GetOwner());
+
+	// Translate given input event and find out an event index for translated event
+	if (Controller)
+	{
+		FName OriginalEvent = RuntimeEvents[EventIndex].Name;
+		FName TranslatedEvent = Controller->TranslateInputEvent(OriginalEvent);
+		if (OriginalEvent != TranslatedEvent)
+		{
+			// Set the original event bit
+			CurrentRecord.TranslatedEvents |= (1LL << EventIndex);
+
+			int32* FoundIndex = EventIndexMap.Find(TranslatedEvent);
+			if (FoundIndex == nullptr)
+			{
+				if (TranslatedEvent == NAME_None)
+				{
+					return; // Skip event flag recording
+				}
+				else
+				{
+					UE_LOG(InputBufferLog, Warning, TEXT("Unknown input event '%s' translated from '%s'."), *TranslatedEvent.ToString(), *OriginalEvent.ToString());
+				}
+			}
+			else
+			{
+				EventIndex = *FoundIndex;
+			}
+		}
+	}
+
+	// Set the event bit
+	CurrentRecord.Events |= (1LL << EventIndex);
+}
+
+void UInputBufferComponent::ClearHistory()
+{
+	if (Recorder.IsValid())
+	{
+		RecordLastRecord();
+		Recorder->WriteOp(EInputBufferReplayOp::Clear);
+	}
+
+	InputHistory.Reset(GetHistoryCapacity());
+}
+
+void UInputBufferComponent::InvalidateHistory()
+{
+	if (Recorder.IsValid())
+	{
+		// The unfinished last record is written later along with its invalid flag.
+		Recorder->WriteOp(EInputBufferReplayOp::Invalidate);
+	}
+
+	InputHistory.Invalidate();
+}
+
+void UInputBufferComponent::InvalidateHistoryFrom(int32 RecordIndex)
+{
+	if (RecordIndex < 0)
+	{
+		return;
+	}
+
+	if (Recorder.IsValid())
+	{
+		// The unfinished last record is not written yet, so it is not counted among the written records that stay valid.
+		Recorder->WriteOp(EInputBufferReplayOp::Consume, FMath::Max(RecordIndex - 1, 0));
+	}
+
+	InputHistory.InvalidateFrom(RecordIndex);
+}
+
+void UInputBufferComponent::ConsumeHistory(const FInputCommandMatchResult& Result)
+{
+	if (Result.HasRecords())
+	{
+		InvalidateHistoryFrom(Result.EndRecord);
+	}
+}
+
+bool UInputBufferComponent::ConvertEventsToFlags(const TArray<FName>& Events, uint64& Flags) const
+{
+	bool bSucceeded = true;
+	for (int32 Idx = 0; Idx < Events.Num(); Idx++)
+	{
+		const int32* Index = EventIndexMap.Find(Events[Idx]);
+		if (Index)
+		{
+			Flags |= (1LL << *Index); // Set the event bit
+		}
+		else
+		{
+			bSucceeded = false; // Any unknown event means a failure.
+		}
+	}
+
+	return bSucceeded;
+}
+
+void UInputBufferComponent::ConvertFlagsToEvents(uint64 Flags, TArray<FName>& Events) const
+{
+	if (Flags != 0)
+	{
+		Events.Append(GetEventNames(Flags).Names);
+	}
+}
+
+void UInputBufferComponent::GetCurrentEvents(TArray<FName>& Events) const
+{
+	ConvertFlagsToEvents(CurrentRecord.Events, Events);
+}
+
+const FInputBufferRecord* UInputBufferComponent::GetLastRecord(float TimeLimit, bool bSkipEmptyTrail) const
+{
+	if (bSkipEmptyTrail)
+	{
+		return GetLastNonEmptyRecord(TimeLimit);
+	}
+	else
+	{
+		return GetLastRecord(TimeLimit);
+	}
+}
+
+const FInputBufferRecord* UInputBufferComponent::GetLastRecord(float TimeLimit) const
+{
+	float CurrTime = GetCurrentTime();
+	TimeLimit = ScaleTimeLimit(TimeLimit, GetTimeLimitFrameRate());
+	FInputBufferVisitCounter VisitCounter;
+
+	int32 RecordIdx = 0;
+	for (auto It = InputHistory.CreateConstReverseIterator(); It; ++It, ++RecordIdx)
+	{
+		const FInputBufferRecord& Record = *It;
+		VisitCounter.Count++;
+		if (InputHistory.IsValidRecord(RecordIdx) && (CurrTime - Record.EndTime <= TimeLimit || TimeLimit == 0.f))
+		{
+			return &Record;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	return nullptr;
+}
+
+const FInputBufferRecord* UInputBufferComponent::GetLastNonEmptyRecord(float TimeLimit) const
+{
+	float CurrTime = GetCurrentTime();
+	TimeLimit = ScaleTimeLimit(TimeLimit, GetTimeLimitFrameRate());
+	FInputBufferVisitCounter VisitCounter;
+
+	int32 RecordIdx = 0;
+	for (auto It = InputHistory.CreateConstReverseIterator(); It; ++It, ++RecordIdx)
+	{
+		const FInputBufferRecord& Record = *It;
+		VisitCounter.Count++;
+		if (InputHistory.IsValidRecord(RecordIdx) && (CurrTime - Record.EndTime <= TimeLimit || TimeLimit == 0.f))
+		{
+			if (Record.Events != 0)
+			{
+				return &Record;
+			}
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	return nullptr;
+}
+
+float UInputBufferComponent::GetLastEvents(TArray<FName>& Events, float TimeLimit, bool bSkipEmptyTrail) const
+{
+	const FInputBufferRecord* Record = GetLastRecord(TimeLimit, bSkipEmptyTrail);
+	if (Record)
+	{
+		ConvertFlagsToEvents(Record->Events, Events);
+		return Record->EndTime;
+	}
+	else
+	{
+		return 0.f;
+	}
+}
+
+float UInputBufferComponent::GetLastEventMask(FBufferedInputEventMask& Events, float TimeLimit, bool bSkipEmptyTrail) const
+{
+	Events = FBufferedInputEventMask();
+	Events.LayoutVersion = EventLayoutVersion;
+	Events.bResolved = true;
+
+	const FInputBufferRecord* Record = GetLastRecord(TimeLimit, bSkipEmptyTrail);
+	if (Record)
+	{
+		Events.MatchFlags = Record->Events;
+		return Record->EndTime;
+	}
+	else
+	{
+		return 0.f;
+	}
+}
+
+void UInputBufferComponent::GetHistoryRecords(TArray<FInputHistoryRecord>& Records, float TimeLimit, bool bIncludeInvalidRecords) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_InputBuffer_GetHistoryRecords);
+
+	// Count the records first, so they are added in chronological order without reversing.
+	const int32 NumRecords = GetNumVisibleRecords(TimeLimit, bIncludeInvalidRecords);
+	Records.Reserve(Records.Num() + NumRecords);
+
+	int32 RecordIdx = NumRecords - 1; // from the end
+	for (auto It = InputHistory.CreateConstIterator(InputHistory.Num() - NumRecords); It; ++It, --RecordIdx)
+	{
+		const auto& Record = *It;
+
+		FInputHistoryRecord& Copy = Records[Records.Emplace(Record.StartTime, Record.EndTime, InputHistory.IsValidRecord(RecordIdx))];
+		ConvertFlagsToEvents(Record.Events, Copy.Events);
+		ConvertFlagsToEvents(Record.TranslatedEvents, Copy.TranslatedEvents);
+	}
+}
+
+int32 UInputBufferComponent::VisitHistory(TFunctionRef<bool(const FInputHistoryRecordView&)> Visitor, float TimeLimit, bool bIncludeInvalidRecords, bool bReverseChronological) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_InputBuffer_VisitHistory);
+
+	int32 NumVisited = 0;
+	if (bReverseChronological)
+	{
+		const float CurrTime = GetCurrentTime();
+		TimeLimit = ScaleTimeLimit(TimeLimit, GetTimeLimitFrameRate());
+		FInputBufferVisitCounter VisitCounter;
+
+		// Records are checked while visiting, so the visit stops early without a separate pass.
+		int32 RecordIdx = 0;
+		for (auto It = InputHistory.CreateConstReverseIterator(); It; ++It, ++RecordIdx)
+		{
+			const FInputBufferRecord& Record = *It;
+			const bool bValid = InputHistory.IsValidRecord(RecordIdx);
+			VisitCounter.Count++;
+			if (!(bValid || bIncludeInvalidRecords) || (CurrTime - Record.EndTime > TimeLimit && TimeLimit != 0.f))
+			{
+				break;
+			}
+
+			NumVisited++;
+			if (!Visitor(FInputHistoryRecordView(*this, Record, RecordIdx, bValid)))
+			{
+				break;
+			}
+		}
+	}
+	else
+	{
+		const int32 NumRecords = GetNumVisibleRecords(TimeLimit, bIncludeInvalidRecords);
+
+		int32 RecordIdx = NumRecords - 1; // from the end
+		for (auto It = InputHistory.CreateConstIterator(InputHistory.Num() - NumRecords); It; ++It, --RecordIdx)
+		{
+			NumVisited++;
+			if (!Visitor(FInputHistoryRecordView(*this, *It, RecordIdx, InputHistory.IsValidRecord(RecordIdx))))
+			{
+				break;
+			}
+		}
+	}
+
+	return NumVisited;
+}
+
+void UInputBufferComponent::GetArchivedHistoryRecords(TArray<FInputHistoryRecord>& Records, float StartTime) const
+{
+	FInputHistoryArchive::FReader Reader(ArchivedHistory);
+	if (StartTime != 0.f && !Reader.Seek(StartTime))
+	{
+		return;
+	}
+
+	FInputBufferRecord Record;
+	while (Reader.Next(Record))
+	{
+		FInputHistoryRecord& Copy = Records[Records.Emplace(Record.StartTime, Record.EndTime, Record.bValid)];
+		ConvertFlagsToEvents(Record.Events, Copy.Events);
+		ConvertFlagsToEvents(Record.TranslatedEvents, Copy.TranslatedEvents);
+	}
+}
+
+void UInputBufferComponent::ClearArchivedHistory()
+{
+	ArchivedHistory.Reset();
+}
+
+int32 UInputBufferComponent::GetNumVisibleRecords(float TimeLimit, bool bIncludeInvalidRecords) const
+{
+	const float CurrTime = GetCurrentTime();
+	TimeLimit = ScaleTimeLimit(TimeLimit, GetTimeLimitFrameRate());
+	FInputBufferVisitCounter VisitCounter;
+
+	int32 NumRecords = 0;
+	for (auto It = InputHistory.CreateConstReverseIterator(); It; ++It, ++NumRecords)
+	{
+		VisitCounter.Count++;
+		if (!(InputHistory.IsValidRecord(NumRecords) || bIncludeInvalidRecords) || (CurrTime - It->EndTime > TimeLimit && TimeLimit != 0.f))
+		{
+			break;
+		}
+	}
+
+	return NumRecords;
+}
+
+bool UInputBufferComponent::SetHistoryRecords(const TArray<FInputHistoryRecord>& Records)
+{
+	if (Recorder.IsValid())
+	{
+		RecordLastRecord();
+		Recorder->WriteOp(EInputBufferReplayOp::Clear);
+	}
+
+	bool AllSucceeded = true;
+	InputHistory.Reset(Records.Num());
+
+	for (const auto& Record : Records)
+	{
+		uint64 Flags = 0;
+		uint64 TranslatedFlags = 0;
+		AllSucceeded = AllSucceeded && ConvertEventsToFlags(Record.Events, Flags);
+		AllSucceeded = AllSucceeded && ConvertEventsToFlags(Record.TranslatedEvents, TranslatedFlags);
+
+		InputHistory.Add(FInputBufferRecord(Record.StartTime, Record.EndTime, Flags, TranslatedFlags, Record.bValid));
+	}
+
+	RecordHistory();
+
+	return AllSucceeded;
+}
+
+bool UInputBufferComponent::StartRecording(const FString& Filename)
+{
+	TArray<FName> EventNames;
+	EventNames.Reserve(RuntimeEvents.Num());
+	for (const auto& Event : RuntimeEvents)
+	{
+		EventNames.Add(Event.Name);
+	}
+
+	if (!Recorder.IsValid())
+	{
+		Recorder = MakeUnique<FInputBufferRecorder>();
+	}
+
+	if (!Recorder->Start(Filename, EventNames, GetTimeLimitFrameRate()))
+	{
+		Recorder.Reset();
+		return false;
+	}
+
+	// Start from the current state of input history.
+	RecordHistory();
+	return true;
+}
+
+void UInputBufferComponent::StopRecording()
+{
+	if (Recorder.IsValid())
+	{
+		RecordLastRecord();
+		Recorder->Stop();
+		Recorder.Reset();
+	}
+}
+
+bool UInputBufferComponent::IsRecording() const
+{
+	return Recorder.IsValid();
+}
+
+void UInputBufferComponent::RecordHistory()
+{
+	if (Recorder.IsValid())
+	{
+		// Records are written with their validity under the invalidation watermark.
+		int32 Count = InputHistory.Num() - 1;
+		for (auto It = InputHistory.CreateConstIterator(); It && Count > 0; ++It, --Count)
+		{
+			FInputBufferRecord Record = *It;
+			Record.bValid = InputHistory.IsValidRecord(Count);
+			Recorder->WriteRecord(Record);
+		}
+	}
+}
+
+void UInputBufferComponent::RecordLastRecord()
+{
+	auto LastRecord = InputHistory.LastOrNull();
+	if (LastRecord && Recorder.IsValid())
+	{
+		FInputBufferRecord Record = *LastRecord;
+		Record.bValid = InputHistory.IsValidRecord(0);
+		Recorder->WriteRecord(Record);
+	}
+}
+
+bool UInputBufferComponent::MatchEvents(const TArray<FName>& EventsToMatch, const TArray<FName>& EventsToIgnore, float TimeLimit, bool bSkipEmptyTrail) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_InputBuffer_MatchEvents);
+
+	const FInputBufferRecord* Record = GetLastRecord(TimeLimit, bSkipEmptyTrail);
+	if (Record)
+	{
+		uint64 MatchingFlags = 0; // The bit flags of events to match.
+		if (ConvertEventsToFlags(EventsToMatch, MatchingFlags))
+		{
+			uint64 IgnoringFlags = 0; // The bit flags of events to ignore.
+			ConvertEventsToFlags(EventsToIgnore, IgnoringFlags);
+
+			if (CompareEventFlags(Record->Events, MatchingFlags, IgnoringFlags))
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+FBufferedInputEventMask UInputBufferComponent::MakeEventMask(const TArray<FName>& EventsToMatch, const TArray<FName>& EventsToIgnore) const
+{
+	FBufferedInputEventMask Mask;
+	Mask.LayoutVersion = EventLayoutVersion;
+	Mask.bResolved = ConvertEventsToFlags(EventsToMatch, Mask.MatchFlags);
+	ConvertEventsToFlags(EventsToIgnore, Mask.IgnoreFlags);
+
+	if (!Mask.bResolved)
+	{
+		UE_LOG(InputBufferLog, Warning, TEXT("Event mask has unknown input events to match, so it never matches."));
+	}
+
+	return Mask;
+}
+
+bool UInputBufferComponent::MatchEventMask(const FBufferedInputEventMask& Mask, float TimeLimit, bool bSkipEmptyTrail) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_InputBuffer_MatchEvents);
+
+	if (!IsEventMaskCurrent(Mask))
+	{
+		UE_LOG(InputBufferLog, Warning, TEXT("Event mask is stale. It should be made again after the input buffer is initialized."));
+		return false;
+	}
+
+	const FInputBufferRecord* Record = GetLastRecord(TimeLimit, bSkipEmptyTrail);
+	return Mask.bResolved && Record && CompareEventFlags(Record->Events, Mask.MatchFlags, Mask.IgnoreFlags);
+}
+
+bool UInputBufferComponent::MatchCommand(class UInputCommand* Command) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_InputBuffer_MatchCommand);
+
+	const bool bMatched = MatchCommandHistory(Command);
+	if (bMatched)
+	{
+		ReportRecognition(Command);
+	}
+
+	return bMatched;
+}
+
+bool UInputBufferComponent::MatchCommandWithResult(UInputCommand* Command, FInputCommandMatchResult& OutResult) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_InputBuffer_MatchCommand);
+
+	const bool bMatched = MatchCommandHistory(Command, &OutResult);
+	if (bMatched)
+	{
+		ReportRecognition(Command);
+	}
+
+	return bMatched;
+}
+
+void UInputBufferComponent::ReportRecognition(const UInputCommand* Command) const
+{
+	// Report recognition latency once per input record that triggers the command.
+	if (LastInputCycles != 0 && FInputBufferLatencyTracker::IsEnabled())
+	{
+		uint32& ReportedSerial = FindOrAddObjectEntry(ReportedLatencySerials, Command);
+		if (ReportedSerial != LastInputSerial)
+		{
+			ReportedSerial = LastInputSerial;
+			FInputBufferLatencyTracker::Get().AddRecognition(Command->GetFName(), LastInputCycles);
+		}
+	}
+}
+
+void UInputBufferComponent::BindCommandSet(UInputCommandSet* CommandSet)
+{
+	if (CommandSet == nullptr)
+	{
+		return;
+	}
+
+	GrowRequiredHistory(CommandSet);
+
+	GetBoundProgram(CommandSet);
+	FindOrAddObjectEntry(BoundCommandSets, CommandSet).bAutoSized = true;
+}
+
+void UInputBufferComponent::GrowRequiredHistory(const UInputCommandSet* CommandSet)
+{
+	if (!bAutoSizeHistory)
+	{
+		return;
+	}
+
+	// No capacity is enough for an unbounded set, which binding it warns about.
+	const int32 NumRecords = CommandSet->GetCompiledData().GetMinHistoryRecords(GetTimeLimitFrameRate(), nullptr, bTranslatedHistory);
+	if (NumRecords > RequiredHistory)
+	{
+		RequiredHistory = NumRecords;
+
+		// Keep buffered input, since the set may be bound in the middle of a match.
+		if (InputHistory.Max() < GetHistoryCapacity())
+		{
+			InputHistory.SetMax(GetHistoryCapacity());
+		}
+	}
+}
+
+void UInputBufferComponent::HandleTranslatedHistory()
+{
+	bTranslatedHistory = true;
+
+	// Bound commands and sets are bound and checked again when matched next time.
+	for (auto& Pair : BoundCommands)
+	{
+		Pair.Value.CompiledSerial = 0;
+	}
+
+	for (auto& Pair : BoundCommandSets)
+	{
+		Pair.Value.CompiledSerial = 0;
+		if (Pair.Value.bAutoSized && Pair.Key.IsValid())
+		{
+			GrowRequiredHistory(Pair.Key.Get());
+		}
+	}
+}
+
+int32 UInputBufferComponent::GetHistoryCapacity() const
+{
+	return bAutoSizeHistory ? FMath::Max(MaxInputHistory, RequiredHistory) : MaxInputHistory;
+}
+
+void UInputBufferComponent::CheckHistoryCapacity(int32 NumRecords, const UObject* Source) const
+{
+	// Input history may not be allocated yet if the input buffer is not initialized.
+	const int32 Capacity = FMath::Max(InputHistory.Max(), GetHistoryCapacity());
+	if (NumRecords == INDEX_NONE && !bWarnedHistoryCapacity)
+	{
+		bWarnedHistoryCapacity = true;
+		UE_LOG(InputBufferLog, Warning, TEXT("%s may fail to recognize %s, which can be spread over any number of records, with input history of %d records. Give entries that ignore other events a maximal duration, give the command a time limit if input events are translated, and use frame-indexed time."),
+			*GetPathName(), *Source->GetName(), Capacity);
+	}
+	else if (NumRecords > Capacity && !bWarnedHistoryCapacity)
+	{
+		bWarnedHistoryCapacity = true;
+		UE_LOG(InputBufferLog, Warning, TEXT("%s may fail to recognize %s, which needs input history of %d records but the capacity is %d. %s"),
+			*GetPathName(), *Source->GetName(), NumRecords, Capacity,
+			bAutoSizeHistory ? TEXT("Bind it in a command set with BindCommandSet.") : TEXT("Increase MaxInputHistory or enable bAutoSizeHistory."));
+	}
+}
+
+UInputCommand* UInputBufferComponent::MatchCommandSet(UInputCommandSet* CommandSet) const
+{
+	return MatchCommandSetHistory(CommandSet, nullptr);
+}
+
+UInputCommand* UInputBufferComponent::MatchCommandSetWithResult(UInputCommandSet* CommandSet, FInputCommandMatchResult& OutResult) const
+{
+	return MatchCommandSetHistory(CommandSet, &OutResult);
+}
+
+UInputCommand* UInputBufferComponent::MatchCommandSetHistory(UInputCommandSet* CommandSet, FInputCommandMatchResult* OutResult) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_InputBuffer_MatchCommandSet);
+
+	if (CommandSet == nullptr || InputHistory.Num() == 0)
+	{
+		if (OutResult)
+		{
+			OutResult->Reset();
+		}
+		return nullptr; // because of nothing to match
+	}
+
+	FScopeCycleCounterUObject CommandSetScope(CommandSet);
+
+	const int32 MatchIdx = MatchCommandSetCandidates(CommandSet, nullptr, OutResult);
+
+	UInputCommand* Command = CommandSet->Commands.IsValidIndex(MatchIdx) ? CommandSet->Commands[MatchIdx] : nullptr;
+	if (Command)
+	{
+		ReportRecognition(Command);
+	}
+
+	return Command;
+}
+
+bool UInputBufferComponent::MatchAllCommands(UInputCommandSet* CommandSet, TArray<UInputCommand*>& OutCommands) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_InputBuffer_MatchCommandSet);
+
+	OutCommands.Reset();
+
+	if (CommandSet == nullptr || InputHistory.Num() == 0)
+	{
+		return false; // because of nothing to match
+	}
+
+	FScopeCycleCounterUObject CommandSetScope(CommandSet);
+
+	MatchCommandSetCandidates(CommandSet, &CommandSetMatches, nullptr);
+
+	for (TConstSetBitIterator<> It(CommandSetMatches); It; ++It)
+	{
+		UInputCommand* Command = CommandSet->Commands.IsValidIndex(It.GetIndex()) ? CommandSet->Commands[It.GetIndex()] : nullptr;
+		if (Command)
+		{
+			OutCommands.Add(Command);
+			ReportRecognition(Command);
+		}
+	}
+
+	return OutCommands.Num() > 0;
+}
+
+int32 UInputBufferComponent::MatchCommandSetCandidates(const UInputCommandSet* CommandSet, TBitArray<>* OutMatches, FInputCommandMatchResult* OutResult) const
+{
+	const FInputCommandSetProgram& Program = GetBoundProgram(CommandSet);
+
+	if (OutMatches)
+	{
+		OutMatches->Init(false, Program.Commands.Num());
+	}
+
+	if (OutResult)
+	{
+		OutResult->Reset();
+	}
+
+	TBitArray<> Candidates;
+	Program.GetCandidates(FInputCommandMatcher::GetTriggerEvents(InputHistory), Candidates);
+
+	FInputBufferVisitCounter VisitCounter;
+	const float CurrTime = GetCurrentTime();
+	const float FrameRate = GetTimeLimitFrameRate();
+
+	int32 FirstMatch = INDEX_NONE;
+	uint32 NumEvaluated = 0;
+	for (TConstSetBitIterator<> It(Candidates); It; ++It)
+	{
+		const int32 Idx = It.GetIndex();
+
+		// Attributes the cost to each command asset in stats captures, as if the command were matched alone.
+		FScopeCycleCounterUObject CommandScope(CommandSet->Commands.IsValidIndex(Idx) ? CommandSet->Commands[Idx] : nullptr);
+
+		// Only the first match fills in the result, so later commands neither overwrite nor reset it.
+		if (FInputCommandMatcher::Match(Program.Commands[Idx], InputHistory, CurrTime, FrameRate, &VisitCounter.Count, FirstMatch == INDEX_NONE ? OutResult : nullptr, &NumEvaluated))
+		{
+			if (FirstMatch == INDEX_NONE)
+			{
+				FirstMatch = Idx;
+			}
+
+			if (OutMatches == nullptr)
+			{
+				break;
+			}
+
+			(*OutMatches)[Idx] = true;
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_InputBuffer_CommandsEvaluated, NumEvaluated);
+
+	return FirstMatch;
+}
+
+bool UInputBufferComponent::MatchCommandHistory(UInputCommand* Command, FInputCommandMatchResult* OutResult) const
+{
+	if (Command == nullptr || InputHistory.Num() == 0)
+	{
+		if (OutResult)
+		{
+			OutResult->Reset();
+		}
+		return false; // because of nothing to match
+	}
+
+	// Attributes the cost to the command asset in stats captures.
+	FScopeCycleCounterUObject CommandScope(Command);
+	FInputBufferVisitCounter VisitCounter;
+
+	uint32 NumEvaluated = 0;
+	const bool bMatched = FInputCommandMatcher::Match(GetBoundProgram(Command), InputHistory, GetCurrentTime(), GetTimeLimitFrameRate(), &VisitCounter.Count, OutResult, &NumEvaluated);
+	INC_DWORD_STAT_BY(STAT_InputBuffer_CommandsEvaluated, NumEvaluated);
+
+	return bMatched;
+}
+
+const FInputCommandProgram& UInputBufferComponent::GetBoundProgram(const UInputCommand* Command) const
+{
+	const FCompiledInputCommand& CompiledCommand = Command->GetCompiledData();
+
+	FBoundInputCommand& Bound = FindOrAddObjectEntry(BoundCommands, Command);
+	if (Bound.CompiledSerial != Command->GetCompiledSerial())
+	{
+		BindCommand(CompiledCommand, Bound.Program);
+		Bound.CompiledSerial = Command->GetCompiledSerial();
+		CheckHistoryCapacity(CompiledCommand.GetMinHistoryRecords(GetTimeLimitFrameRate(), bTranslatedHistory), Command);
+	}
+
+	return Bound.Program;
+}
+
+const FInputCommandSetProgram& UInputBufferComponent::GetBoundProgram(const UInputCommandSet* CommandSet) const
+{
+	const FCompiledInputCommandSet& CompiledSet = CommandSet->GetCompiledData();
+
+	FBoundInputCommandSet& Bound = FindOrAddObjectEntry(BoundCommandSets, CommandSet);
+	if (Bound.CompiledSerial != CommandSet->GetCompiledSerial())
+	{
+		// The shared name table is resolved once for all the commands.
+		TArray<uint64, TInlineAllocator<32>> NameFlags;
+		ResolveNameTable(CompiledSet.Names, NameFlags);
+		CompiledSet.Bind(NameFlags.GetData(), Bound.Program);
+		Bound.CompiledSerial = CommandSet->GetCompiledSerial();
+
+		int32 CommandIdx = INDEX_NONE;
+		const int32 NumRecords = CompiledSet.GetMinHistoryRecords(GetTimeLimitFrameRate(), &CommandIdx, bTranslatedHistory);
+		if (CommandSet->Commands.IsValidIndex(CommandIdx) && CommandSet->Commands[CommandIdx])
+		{
+			CheckHistoryCapacity(NumRecords, CommandSet->Commands[CommandIdx]);
+		}
+	}
+
+	return Bound.Program;
+}
+
+void UInputBufferComponent::ResolveNameTable(const TArray<FName>& Names, TArray<uint64, TInlineAllocator<32>>& OutNameFlags) const
+{
+	OutNameFlags.SetNumUninitialized(Names.Num());
+	for (int32 Idx = 0; Idx < Names.Num(); Idx++)
+	{
+		const int32* Index = EventIndexMap.Find(Names[Idx]);
+		OutNameFlags[Idx] = Index ? (1LL << *Index) : 0;
+	}
+}
+
+void UInputBufferComponent::CompileCommand(const UInputCommand* Command, FInputCommandProgram& OutProgram) const
+{
+	check(Command);
+
+	BindCommand(Command->GetCompiledData(), OutProgram);
+}
+
+void UInputBufferComponent::BindCommand(const FCompiledInputCommand& CompiledCommand, FInputCommandProgram& OutProgram) const
+{
+	// Each name in the table is looked up once, however many entries refer to it.
+	TArray<uint64, TInlineAllocator<32>> NameFlags;
+	ResolveNameTable(CompiledCommand.Names, NameFlags);
+	CompiledCommand.Bind(NameFlags.GetData(), OutProgram);
+}
+
+bool UInputBufferComponent::MatchCommandReference(const UInputCommand* Command) const
+{
+	if (Command == nullptr || InputHistory.Num() == 0)
+	{
+		return false; // because of nothing to match
+	}
+
+	uint64 OuterIgnoreFlags = 0;
+	ConvertEventsToFlags(Command->EventsToIgnore, OuterIgnoreFlags);
+
+	const float CurrTime = GetCurrentTime();
+	const float FrameRate = GetTimeLimitFrameRate();
+	const float TimeLimit = ScaleTimeLimit(Command->TimeLimit, FrameRate);
+
+	for (const FInputCommandSequence& Sequence : Command->Sequences)
+	{
+		if (Sequence.bEnabled)
+		{
+			bool bRepeating = false; // Are we trying to repeat the current entry?
+			bool bCanRecede = false; // Can we rollback to the previous entry?
+			float CurrEntryStartTime = 0; // The start time of the oldest matching record for the current entry. Used to check durations of entries.
+			float CurrEntryEndTime = 0; // The end time of the latest matching record for the current entry. Used to check durations of entries.
+			float PrevEntryStartTime = 0; // The start time of the oldest matching record for the previous entry. Used to check durations and interval of entries.
+			float PrevEntryEndTime = 0; // The end time of the latest matching record for the previous entry. Used to check durations of entries.
+			int32 EntryIdx = Sequence.Entries.Num() - 1; // The index of the command entry to match in the current iteration.
+			int32 RecordIdx = 0; // The index of the current record from the end of input history.
+			auto It = InputHistory.CreateConstReverseIterator(); // Input history iterator.
+
+			while (EntryIdx >= 0)
+			{
+				const auto& Entry = Sequence.Entries[EntryIdx];
+				//if (Entry.EventsToMatch.Num() == 0)
+				//{
+				//	break; // because of nothing to match
+				//}
+
+				const auto& Record = *It;
+				if (!InputHistory.IsValidRecord(RecordIdx))
+				{
+					if (bRepeating && EntryIdx == 0)
+					{
+						if (!Entry.CheckDuration(CurrEntryEndTime - CurrEntryStartTime, FrameRate))
+						{
+							break;
+						}
+						// Even if we failed to repeat the first entry, command recognition still succeeds since we have found matching records for all entries.
+						return true;
+					}
+					else
+					{
+						break; // Need not check the previous records since they should be invalid too.
+					}
+				}
+
+				if (CurrTime - Record.EndTime > TimeLimit && TimeLimit != 0.f && !bRepeating)
+				{
+					break;
+				}
+
+				//TArray<FName> RecordedEvents;
+				//ConvertFlagsToEvents(Record.Events, RecordedEvents);
+
+				bool bMatched = false; // Whether the current record matches the current entry?
+				bool bNextEntry = true; // Should we advance to the next entry in the next iteraion?
+				bool bNextRecord = true; // Should we advance to the next record in the next iteraion?
+				uint64 MatchingFlags = 0; // The bit flags of events to match.
+				uint64 IgnoringFlags = 0; // The bit flags of events to ignore.
+				if (ConvertEventsToFlags(Entry.EventsToMatch, MatchingFlags))
+				{
+					// For events to match, unknown events means mismatch. But for events to ignore, unknown events are omitted.
+					ConvertEventsToFlags(Entry.EventsToIgnore, IgnoringFlags);
+
+					if (Entry.bIgnoreOthers)
+					{
+						bMatched = HasEventFlags(Record.Events, MatchingFlags);
+					}
+					else
+					{
+						IgnoringFlags |= OuterIgnoreFlags;
+						bMatched = CompareEventFlags(Record.Events, MatchingFlags, IgnoringFlags);
+					}
+				}
+				else
+				{
+					break; // Fails since we cannot find flags for unknown events.
+				}
+
+				if (bMatched)
+				{
+					if (CurrEntryEndTime == 0)
+					{
+						// Check limits of the duration of the previous entry.
+						if (PrevEntryEndTime != 0.f)
+						{
+							const auto& PrevEntry = Sequence.Entries[EntryIdx + 1];
+							if (!PrevEntry.CheckDuration(PrevEntryEndTime - PrevEntryStartTime, FrameRate))
+							{
+								break;
+							}
+						}
+
+						// Check limits of the internal between the current entry and previous entry.
+						if (PrevEntryStartTime != 0.f && !Entry.CheckInterval(PrevEntryStartTime - Record.EndTime, FrameRate))
+						{
+							break;
+						}
+
+						CurrEntryEndTime = Record.EndTime;
+					}
+					CurrEntryStartTime = Record.StartTime;
+
+					if (EntryIdx > 0)
+					{
+						bCanRecede = true;
+						bRepeating = false;
+					}
+					else
+					{
+						bCanRecede = false;
+						bRepeating = true;
+						bNextEntry = false;
+					}
+				}
+				else if (bRepeating && EntryIdx == 0)
+				{
+					if (!Entry.CheckDuration(CurrEntryEndTime - CurrEntryStartTime, FrameRate))
+					{
+						break;
+					}
+					// Even if we failed to repeat the first entry, command recognition still succeeds since we have found matching records for all entries.
+					return true;
+				}
+				else if (Record.Events == 0)
+				{
+					// Skip the current record when no input.
+					bCanRecede = false;
+					bRepeating = false;
+					bNextEntry = false;
+				}
+				else if (bCanRecede)
+				{
+					// When failing to match the current entry, we try the previous entry if possible.
+					bCanRecede = false;
+					bRepeating = true;
+					bNextRecord = false;
+					bNextEntry = false;
+					EntryIdx++;
+					check(EntryIdx < Sequence.Entries.Num());
+
+					CurrEntryStartTime = PrevEntryStartTime;
+					CurrEntryEndTime = PrevEntryEndTime;
+					PrevEntryStartTime = 0.f;
+					PrevEntryEndTime = 0.f;
+				}
+				else
+				{
+					break; // Fails due to mismatch.
+				}
+
+				if (bNextRecord)
+				{
+					++It;
+					RecordIdx++;
+					if (!It) // If there is no remaining history.
+					{
+						if (EntryIdx == 0 && bMatched)
+						{
+							if (!Entry.CheckDuration(CurrEntryEndTime - CurrEntryStartTime, FrameRate))
+							{
+								break;
+							}
+
+							return true; // since we have checked all the entries and didn't fail
+						}
+						else
+						{
+							break; // Fails because of mismatch or no remaining history to match the next entry.
+						}
+					}
+				}
+
+				if (bNextEntry)
+				{
+					if (CurrEntryEndTime != 0)
+					{
+						PrevEntryStartTime = CurrEntryStartTime;
+						PrevEntryEndTime = CurrEntryEndTime;
+						CurrEntryStartTime = 0.f;
+						CurrEntryEndTime = 0.f;
+					}
+
+					EntryIdx--;
+				}
+			}
+
+			if (EntryIdx == -1)
+			{
+				return true; // since we have checked all the entries and didn't fail
+			}
+		}
+	}
+
+	return false;
+}
+
+void UInputBufferComponent::BeginPlayback(float FrameRate)
+{
+	bPlayingBack = true;
+	PlaybackTime = 0.f;
+	PlaybackFrameRate = FrameRate;
+}
+
+void UInputBufferComponent::EndPlayback()
+{
+	bPlayingBack = false;
+}
+
+void UInputBufferComponent::PlaybackRecord(const FInputBufferRecord& Record)
+{
+	check(bPlayingBack);
+
+	PlaybackTime = Record.EndTime;
+	CurrentRecord = Record;
+
+	// Played back records are finished already, so they are never merged.
+	AddHistoryRecord(Record);
+}
+
+void UInputBufferComponent::PlaybackRollBack(int32 NumRecords, int32 NumValid)
+{
+	check(bPlayingBack);
+
+	InputHistory.RollBack(NumRecords, NumValid);
+
+	auto LastRecord = InputHistory.LastOrNull();
+	PlaybackTime = LastRecord ? LastRecord->EndTime : 0.f;
+}
+
+int32 UInputBufferComponent::GetSnapshotSize() const
+{
+	const int32 NumKeyWords = FMath::DivideAndRoundUp(KeyStates1.Num(), NumBitsPerDWORD);
+	return Align(sizeof(FInputBufferSnapshotHeader) + InputHistory.Max() * sizeof(FInputBufferRecord) + 2 * NumKeyWords * sizeof(uint32), 8);
+}
+
+void UInputBufferComponent::SaveSnapshot(uint8* Dest) const
+{
+	check(Dest);
+	check(KeyStates1.Num() == KeyStates2.Num());
+
+	auto Header = reinterpret_cast<FInputBufferSnapshotHeader*>(Dest);
+	Header->EventLayoutVersion = EventLayoutVersion;
+	Header->NumArchivedRecords = ArchivedHistory.GetNumAdded();
+	Header->RecorderClearSerial = Recorder.IsValid() ? Recorder->GetClearSerial() : 0;
+	Header->NumRecordedRecords = Recorder.IsValid() ? Recorder->GetNumRecords() : 0;
+	Header->HistoryCapacity = InputHistory.Max();
+	Header->NumKeyWords = FMath::DivideAndRoundUp(KeyStates1.Num(), NumBitsPerDWORD);
+	Header->NumRecords = InputHistory.Num();
+	Header->TailIndex = InputHistory.GetTailIndex();
+	Header->NumValidRecords = InputHistory.GetNumValid();
+	Header->bKeyStatesSwapped = (CurrentKeyStates == &KeyStates1);
+	Header->SimulationFrame = SimulationFrame;
+	Header->CurrentRecord = CurrentRecord;
+
+	// Records are laid out in storage order, so the buffer can be restored without any reordering.
+	uint8* Data = Dest + sizeof(FInputBufferSnapshotHeader);
+	FMemory::Memcpy(Data, InputHistory.GetData(), Header->NumRecords * sizeof(FInputBufferRecord));
+	Data += Header->HistoryCapacity * sizeof(FInputBufferRecord);
+
+	const int32 KeyStatesSize = Header->NumKeyWords * sizeof(uint32);
+	FMemory::Memcpy(Data, KeyStates1.GetData(), KeyStatesSize);
+	FMemory::Memcpy(Data + KeyStatesSize, KeyStates2.GetData(), KeyStatesSize);
+}
+
+bool UInputBufferComponent::RestoreSnapshot(const uint8* Src)
+{
+	check(Src);
+
+	auto Header = reinterpret_cast<const FInputBufferSnapshotHeader*>(Src);
+	if (Header->EventLayoutVersion != EventLayoutVersion || Header->HistoryCapacity != InputHistory.Max() ||
+		Header->NumKeyWords != FMath::DivideAndRoundUp(KeyStates1.Num(), NumBitsPerDWORD))
+	{
+		UE_LOG(InputBufferLog, Warning, TEXT("Cannot restore an input buffer snapshot taken with a different layout."));
+		return false;
+	}
+
+	const uint8* Data = Src + sizeof(FInputBufferSnapshotHeader);
+	InputHistory.RestoreRaw(reinterpret_cast<const FInputBufferRecord*>(Data), Header->NumRecords, Header->TailIndex, Header->NumValidRecords);
+	Data += Header->HistoryCapacity * sizeof(FInputBufferRecord);
+
+	const int32 KeyStatesSize = Header->NumKeyWords * sizeof(uint32);
+	FMemory::Memcpy(KeyStates1.GetData(), Data, KeyStatesSize);
+	FMemory::Memcpy(KeyStates2.GetData(), Data + KeyStatesSize, KeyStatesSize);
+
+	PreviousKeyStates = Header->bKeyStatesSwapped ? &KeyStates2 : &KeyStates1;
+	CurrentKeyStates = Header->bKeyStatesSwapped ? &KeyStates1 : &KeyStates2;
+	SimulationFrame = Header->SimulationFrame;
+	CurrentRecord = Header->CurrentRecord;
+	ArchivedHistory.RollBack(Header->NumArchivedRecords);
+
+	if (Recorder.IsValid())
+	{
+		if (Header->RecorderClearSerial == Recorder->GetClearSerial() && Header->NumRecordedRecords <= Recorder->GetNumRecords())
+		{
+			// Only records written since the snapshot are removed. The restored last record is unfinished, so it is written again later
+			// and not counted among the written records that are valid again.
+			Recorder->WriteOp(EInputBufferReplayOp::RollBack, Recorder->GetNumRecords() - Header->NumRecordedRecords, FMath::Max(Header->NumValidRecords - 1, 0));
+		}
+		else
+		{
+			// The snapshot was taken before recording started or input history was cleared, so input history is written as a whole.
+			Recorder->WriteOp(EInputBufferReplayOp::Clear);
+			RecordHistory();
+		}
+	}
+
+	return true;
+}
+
+float UInputBufferComponent::GetCurrentTime() const
+{
+	if (bPlayingBack)
+	{
+		return PlaybackTime;
+	}
+
+	if (bFrameIndexedSimulation)
+	{
+		return (float)SimulationFrame;
+	}
+
+	// Queries in the same frame share one sample, so none of them reaches the world.
+	if (ClockFrame != GFrameCounter)
+	{
+		ClockTime = SampleClock();
+		ClockFrame = GFrameCounter;
+	}
+
+	return ClockTime;
+}
+
+void UInputBufferComponent::SetClockSource(EInputBufferClockSource NewClockSource)
+{
+	ClockSource = NewClockSource;
+	ClockFrame = MAX_uint64; // since the sample of this frame is from the previous clock
+}
+
+#if WITH_EDITOR
+void UInputBufferComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	if (PropertyChangedEvent.GetPropertyName() == GET_MEMBER_NAME_CHECKED(UInputBufferComponent, ClockSource))
+	{
+		ClockFrame = MAX_uint64;
+	}
+}
+#endif
+
+float UInputBufferComponent::SampleClock() const
+{
+	if (ClockSource == EInputBufferClockSource::FrameCounter)
+	{
+		return (float)GFrameCounter;
+	}
+
+	UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return 0.f;
+	}
+
+	return ClockSource == EInputBufferClockSource::GameTime ? World->GetTimeSeconds() : World->GetRealTimeSeconds();
+}
+
+FString UInputBufferComponent::EventFlagsToString(uint64 Events, const FString& Separator) const
+{
+	const TArray<FName>& Names = GetEventNames(Events).Names;
+
+	FString Result;
+	for (int32 Idx = 0; Idx < Names.Num(); Idx++)
+	{
+		if (Idx > 0)
+		{
+			Result += Separator;
+		}
+
+		Result += Names[Idx].ToString();
+	}
+
+	return Result;
+}
+
+const FString& UInputBufferComponent::GetEventFlagsText(uint64 Events) const
+{
+	return GetEventNames(Events).Text;
+}
+
+const UInputBufferComponent::FEventNames& UInputBufferComponent::GetEventNames(uint64 Events) const
+{
+	// Bits without input events are ignored, so they don't take slots of their own.
+	if (RuntimeEvents.Num() < FInputBufferRecord::MAX_EVENTS)
+	{
+		Events &= (1ULL << RuntimeEvents.Num()) - 1;
+	}
+
+	const FEventNames* CachedNames = EventNameCache.Find(Events);
+	if (CachedNames)
+	{
+		return *CachedNames;
+	}
+
+	FEventNames& Names = EventNameCache.Add(Events);
+	Names.Names.Reset();
+	Names.Text.Reset();
+
+	// Only visit bits that are set.
+	for (uint64 Flags = Events; Flags != 0; Flags &= Flags - 1)
+	{
+		const FName Name = RuntimeEvents[GetLowestEventIndex(Flags)].Name;
+		if (Names.Names.Num() > 0)
+		{
+			Names.Text += TEXT(", ");
+		}
+
+		Names.Names.Add(Name);
+		Names.Text += Name.ToString();
+	}
+
+	return Names;
+}
+
+FString UInputBufferComponent::Print(int32 MaxRecords, bool bIncludeInvalidRecords, bool bReverseChronological) const
+{
+	FString Result;
+	PrintTo(Result, MaxRecords, bIncludeInvalidRecords, bReverseChronological);
+	return Result;
+}
+
+void UInputBufferComponent::PrintTo(FString& Out, int32 MaxRecords, bool bIncludeInvalidRecords, bool bReverseChronological) const
+{
+	if (MaxRecords == 0)
+	{
+		MaxRecords = InputHistory.Num();
+	}
+	else
+	{
+		MaxRecords = FMath::Clamp(MaxRecords, 0, InputHistory.Num());
+	}
+
+	if (bReverseChronological)
+	{
+		int32 Count = 0;
+		for (auto It = InputHistory.CreateConstReverseIterator(); It && Count < MaxRecords; ++It, ++Count)
+		{
+			PrintRecordTo(Out, *It, InputHistory.IsValidRecord(Count), bIncludeInvalidRecords);
+		}
+	}
+	else
+	{
+		int32 StartIndex = InputHistory.Num() - MaxRecords;
+		int32 RecordIdx = MaxRecords - 1; // from the end
+		for (auto It = InputHistory.CreateConstIterator(StartIndex); It; ++It, --RecordIdx)
+		{
+			PrintRecordTo(Out, *It, InputHistory.IsValidRecord(RecordIdx), bIncludeInvalidRecords);
+		}
+	}
+}
+
+void UInputBufferComponent::PrintRecordTo(FString& Out, const FInputBufferRecord& Record, bool bValid, bool bIncludeInvalidRecords) const
+{
+	if (bValid)
+	{
+		Out += TEXT("[");
+		Out += GetEventFlagsText(Record.Events);
+		Out += TEXT("] ");
+	}
+	else if (bIncludeInvalidRecords)
+	{
+		Out += TEXT("(");
+		Out += GetEventFlagsText(Record.Events);
+		Out += TEXT(") ");
+	}
+}
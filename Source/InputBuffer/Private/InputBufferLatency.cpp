@@ -0,0 +1,177 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferPrivatePCH.h"
+#include "InputBufferLatency.h"
+
+static TAutoConsoleVariable<int32> CVarInputBufferTrackLatency(
+	TEXT("InputBuffer.TrackLatency"),
+	0,
+	TEXT("Whether input buffers measure latencies from key events to input records and input command recognition."));
+
+namespace
+{
+	/* Lower bound of the first bucket in seconds. */
+	const double LATENCY_MIN = 10e-6;
+
+	/* Buckets per octave. */
+	const double LATENCY_BUCKETS_PER_OCTAVE = 4.0;
+
+	double CyclesToSeconds(uint64 SourceCycles)
+	{
+		const uint64 Now = FPlatformTime::Cycles64();
+		return Now > SourceCycles ? FPlatformTime::ToSeconds64(Now - SourceCycles) : 0.0;
+	}
+
+	void DumpHistogram(const TCHAR* Name, const FInputBufferLatencyHistogram& Histogram)
+	{
+		UE_LOG(InputBufferLog, Log, TEXT("%-32s %8u %8.2f %8.2f %8.2f %8.2f %8.2f"),
+			Name,
+			Histogram.Count,
+			Histogram.GetMean() * 1000.0,
+			Histogram.GetPercentile(50.0) * 1000.0,
+			Histogram.GetPercentile(95.0) * 1000.0,
+			Histogram.GetPercentile(99.0) * 1000.0,
+			Histogram.Max * 1000.0);
+	}
+
+	void AppendCsvRow(FString& Csv, const FString& Name, const FInputBufferLatencyHistogram& Histogram)
+	{
+		Csv += FString::Printf(TEXT("%s,%u,%.3f,%.3f,%.3f,%.3f,%.3f\n"),
+			*Name,
+			Histogram.Count,
+			Histogram.GetMean() * 1000.0,
+			Histogram.GetPercentile(50.0) * 1000.0,
+			Histogram.GetPercentile(95.0) * 1000.0,
+			Histogram.GetPercentile(99.0) * 1000.0,
+			Histogram.Max * 1000.0);
+	}
+}
+
+static FAutoConsoleCommand InputBufferLatencyDumpCommand(
+	TEXT("InputBuffer.Latency.Dump"),
+	TEXT("Prints input latency percentiles of input buffers in milliseconds."),
+	FConsoleCommandDelegate::CreateLambda([]() { FInputBufferLatencyTracker::Get().Dump(); }));
+
+static FAutoConsoleCommand InputBufferLatencyCsvCommand(
+	TEXT("InputBuffer.Latency.Csv"),
+	TEXT("Writes input latency percentiles of input buffers in milliseconds to a CSV file. Usage: InputBuffer.Latency.Csv [Filename]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const FString Filename = Args.Num() > 0 ? Args[0] : FPaths::ProfilingDir() / TEXT("InputBufferLatency.csv");
+		if (FInputBufferLatencyTracker::Get().WriteCsv(Filename))
+		{
+			UE_LOG(InputBufferLog, Log, TEXT("Input latencies are written to '%s'."), *Filename);
+		}
+	}));
+
+static FAutoConsoleCommand InputBufferLatencyResetCommand(
+	TEXT("InputBuffer.Latency.Reset"),
+	TEXT("Clears input latencies collected by input buffers."),
+	FConsoleCommandDelegate::CreateLambda([]() { FInputBufferLatencyTracker::Get().Reset(); }));
+
+//////////////////////////////////////////////////////////////////////////
+// FInputBufferLatencyHistogram
+
+void FInputBufferLatencyHistogram::Reset()
+{
+	FMemory::Memzero(Buckets);
+	Count = 0;
+	Sum = 0.0;
+	Max = 0.0;
+}
+
+void FInputBufferLatencyHistogram::Add(double Seconds)
+{
+	int32 Bucket = 0;
+	if (Seconds > LATENCY_MIN)
+	{
+		Bucket = FMath::CeilToInt(FMath::Log2(Seconds / LATENCY_MIN) * LATENCY_BUCKETS_PER_OCTAVE);
+		Bucket = FMath::Clamp(Bucket, 0, NUM_BUCKETS - 1);
+	}
+
+	Buckets[Bucket]++;
+	Count++;
+	Sum += Seconds;
+	Max = FMath::Max(Max, Seconds);
+}
+
+double FInputBufferLatencyHistogram::GetPercentile(double Percentage) const
+{
+	if (Count == 0)
+	{
+		return 0.0;
+	}
+
+	const double Threshold = Count * Percentage / 100.0;
+	uint32 Cumulative = 0;
+	for (int32 Bucket = 0; Bucket < NUM_BUCKETS; Bucket++)
+	{
+		Cumulative += Buckets[Bucket];
+		if (Cumulative >= Threshold)
+		{
+			// The bucket bound never exceeds the largest sample.
+			return FMath::Min(GetBucketBound(Bucket), Max);
+		}
+	}
+
+	return Max;
+}
+
+double FInputBufferLatencyHistogram::GetBucketBound(int32 Bucket)
+{
+	return LATENCY_MIN * FMath::Pow(2.0, Bucket / LATENCY_BUCKETS_PER_OCTAVE);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FInputBufferLatencyTracker
+
+FInputBufferLatencyTracker& FInputBufferLatencyTracker::Get()
+{
+	static FInputBufferLatencyTracker Tracker;
+	return Tracker;
+}
+
+bool FInputBufferLatencyTracker::IsEnabled()
+{
+	return CVarInputBufferTrackLatency.GetValueOnGameThread() != 0;
+}
+
+void FInputBufferLatencyTracker::AddIngestion(uint64 SourceCycles)
+{
+	Ingestion.Add(CyclesToSeconds(SourceCycles));
+}
+
+void FInputBufferLatencyTracker::AddRecognition(FName Command, uint64 SourceCycles)
+{
+	Recognition.FindOrAdd(Command).Add(CyclesToSeconds(SourceCycles));
+}
+
+void FInputBufferLatencyTracker::Reset()
+{
+	Ingestion.Reset();
+	Recognition.Empty();
+}
+
+void FInputBufferLatencyTracker::Dump() const
+{
+	UE_LOG(InputBufferLog, Log, TEXT("%-32s %8s %8s %8s %8s %8s %8s"), TEXT("Latency (ms)"), TEXT("Count"), TEXT("Mean"), TEXT("P50"), TEXT("P95"), TEXT("P99"), TEXT("Max"));
+	DumpHistogram(TEXT("Ingestion"), Ingestion);
+
+	for (const auto& Pair : Recognition)
+	{
+		DumpHistogram(*Pair.Key.ToString(), Pair.Value);
+	}
+}
+
+bool FInputBufferLatencyTracker::WriteCsv(const FString& Filename) const
+{
+	FString Csv = TEXT("Name,Count,MeanMs,P50Ms,P95Ms,P99Ms,MaxMs\n");
+	AppendCsvRow(Csv, TEXT("Ingestion"), Ingestion);
+
+	for (const auto& Pair : Recognition)
+	{
+		AppendCsvRow(Csv, Pair.Key.ToString(), Pair.Value);
+	}
+
+	return FFileHelper::SaveStringToFile(Csv, *Filename);
+}
@@ -0,0 +1,94 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferPrivatePCH.h"
+#include "InputBufferComponent.h"
+#include "InputCommand.h"
+#include "InputCommandSet.h"
+#include "InputHistoryPool.h"
+
+namespace
+{
+	struct FInputBufferWorldMemory
+	{
+		FInputBufferWorldMemory() : NumComponents(0), Size(0) {}
+
+		int32 NumComponents;
+
+		SIZE_T Size;
+	};
+
+	/* Objects that are not instances of their class, such as class default objects and templates, are not counted. */
+	bool IsInstance(const UObject* Object)
+	{
+		return !Object->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject) && !Object->IsPendingKill();
+	}
+
+	void DumpInputBufferMemory()
+	{
+		TMap<FString, FInputBufferWorldMemory> Worlds;
+		for (TObjectIterator<UInputBufferComponent> It; It; ++It)
+		{
+			if (IsInstance(*It))
+			{
+				UWorld* World = It->GetWorld();
+				FInputBufferWorldMemory& WorldMemory = Worlds.FindOrAdd(World ? World->GetPathName() : TEXT("None"));
+				WorldMemory.NumComponents++;
+				WorldMemory.Size += It->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+			}
+		}
+
+		UE_LOG(InputBufferLog, Log, TEXT("%-48s %10s %12s %12s"), TEXT("World"), TEXT("Buffers"), TEXT("Bytes"), TEXT("Per buffer"));
+		for (const auto& Pair : Worlds)
+		{
+			UE_LOG(InputBufferLog, Log, TEXT("%-48s %10d %12llu %12llu"),
+				*Pair.Key,
+				Pair.Value.NumComponents,
+				(uint64)Pair.Value.Size,
+				(uint64)(Pair.Value.Size / Pair.Value.NumComponents));
+		}
+
+		int32 NumCommands = 0;
+		SIZE_T TotalCommandSize = 0;
+
+		UE_LOG(InputBufferLog, Log, TEXT("%-72s %12s"), TEXT("Input command"), TEXT("Bytes"));
+		for (TObjectIterator<UInputCommand> It; It; ++It)
+		{
+			if (IsInstance(*It))
+			{
+				const SIZE_T Size = It->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+				UE_LOG(InputBufferLog, Log, TEXT("%-72s %12llu"), *It->GetPathName(), (uint64)Size);
+
+				NumCommands++;
+				TotalCommandSize += Size;
+			}
+		}
+
+		UE_LOG(InputBufferLog, Log, TEXT("%d input commands, %llu bytes in total."), NumCommands, (uint64)TotalCommandSize);
+
+		int32 NumCommandSets = 0;
+		SIZE_T TotalCommandSetSize = 0;
+
+		UE_LOG(InputBufferLog, Log, TEXT("%-72s %12s"), TEXT("Input command set"), TEXT("Bytes"));
+		for (TObjectIterator<UInputCommandSet> It; It; ++It)
+		{
+			if (IsInstance(*It))
+			{
+				const SIZE_T Size = It->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+				UE_LOG(InputBufferLog, Log, TEXT("%-72s %12llu"), *It->GetPathName(), (uint64)Size);
+
+				NumCommandSets++;
+				TotalCommandSetSize += Size;
+			}
+		}
+
+		UE_LOG(InputBufferLog, Log, TEXT("%d input command sets, %llu bytes in total."), NumCommandSets, (uint64)TotalCommandSetSize);
+
+		const FInputHistoryPool& Pool = FInputHistoryPool::Get();
+		UE_LOG(InputBufferLog, Log, TEXT("Pooled input history: %d records, %llu bytes."), Pool.GetNumPooledRecords(), (uint64)Pool.GetAllocatedSize());
+	}
+}
+
+static FAutoConsoleCommand InputBufferMemoryCommand(
+	TEXT("InputBuffer.Memory"),
+	TEXT("Prints memory used by input buffers per world, by each input command and command set asset, and by pooled input history. UObjects themselves are not counted."),
+	FConsoleCommandDelegate::CreateStatic(&DumpInputBufferMemory));
@@ -0,0 +1,228 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferPrivatePCH.h"
+#include "InputBufferPlayback.h"
+#include "InputBufferComponent.h"
+#include "InputCommand.h"
+
+#if PLATFORM_LINUX || PLATFORM_MAC
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define INPUTBUFFER_WITH_MMAP 1
+#else
+#define INPUTBUFFER_WITH_MMAP 0
+#endif
+
+namespace
+{
+	/* Maps bit flags of recorded input events to those of an input buffer. */
+	FORCEINLINE uint64 RemapEventFlags(uint64 Flags, const uint64* BitMasks)
+	{
+		uint64 Result = 0;
+		for (int32 Idx = 0; Flags != 0; Idx++, Flags >>= 1)
+		{
+			if (Flags & 0x1)
+			{
+				Result |= BitMasks[Idx];
+			}
+		}
+
+		return Result;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FInputBufferPlayback
+
+FInputBufferPlayback::FInputBufferPlayback()
+	: Data(nullptr)
+	, Size(0)
+	, Body(nullptr)
+	, MappedData(nullptr)
+	, FrameRate(0.f)
+{
+}
+
+FInputBufferPlayback::~FInputBufferPlayback()
+{
+	Close();
+}
+
+bool FInputBufferPlayback::Open(const FString& Filename)
+{
+	Close();
+
+	if (!MapFile(Filename))
+	{
+		if (!FFileHelper::LoadFileToArray(LoadedData, *Filename))
+		{
+			UE_LOG(InputBufferLog, Warning, TEXT("Cannot read replay file '%s'."), *Filename);
+			return false;
+		}
+
+		Data = LoadedData.GetData();
+		Size = LoadedData.Num();
+	}
+
+	Body = Data;
+	if (!FInputBufferReplayFormat::ReadHeader(Body, Data + Size, FrameRate, EventNames))
+	{
+		UE_LOG(InputBufferLog, Warning, TEXT("'%s' is not an input buffer replay of a supported version."), *Filename);
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void FInputBufferPlayback::Close()
+{
+#if INPUTBUFFER_WITH_MMAP
+	if (MappedData)
+	{
+		munmap(MappedData, Size);
+	}
+#endif
+
+	MappedData = nullptr;
+	LoadedData.Empty();
+	Data = nullptr;
+	Body = nullptr;
+	Size = 0;
+	EventNames.Reset();
+	FrameRate = 0.f;
+}
+
+bool FInputBufferPlayback::MapFile(const FString& Filename)
+{
+#if INPUTBUFFER_WITH_MMAP
+	const FString FullPath = IFileManager::Get().ConvertToAbsolutePathForExternalAppForRead(*Filename);
+
+	int Handle = open(TCHAR_TO_UTF8(*FullPath), O_RDONLY);
+	if (Handle < 0)
+	{
+		return false;
+	}
+
+	struct stat Stat;
+	if (fstat(Handle, &Stat) == 0 && Stat.st_size > 0)
+	{
+		void* Mapped = mmap(nullptr, Stat.st_size, PROT_READ, MAP_PRIVATE, Handle, 0);
+		if (Mapped != MAP_FAILED)
+		{
+			// Replays are read from the beginning to the end exactly once.
+			madvise(Mapped, Stat.st_size, MADV_SEQUENTIAL);
+
+			MappedData = Mapped;
+			Data = (const uint8*)Mapped;
+			Size = Stat.st_size;
+		}
+	}
+
+	// The mapping stays valid after the file is closed.
+	close(Handle);
+
+	return MappedData != nullptr;
+#else
+	return false;
+#endif
+}
+
+void FInputBufferPlayback::InitializeInputBuffer(UInputBufferComponent* InputBuffer) const
+{
+	check(InputBuffer);
+
+	// Input events without keys are registered in order, so their bits are the same as the recorded ones.
+	InputBuffer->EventSetups.Reset();
+	InputBuffer->KeyMappings.Reset();
+	InputBuffer->TranslatedEvents = EventNames;
+	InputBuffer->Initialize();
+}
+
+int32 FInputBufferPlayback::Play(UInputBufferComponent* InputBuffer, const TArray<UInputCommand*>& Commands, TArray<FInputBufferPlaybackMatch>& OutMatches) const
+{
+	check(InputBuffer);
+
+	if (!IsOpen())
+	{
+		return INDEX_NONE;
+	}
+
+	// Map recorded event bits to those of the input buffer by name.
+	uint64 BitMasks[FInputBufferRecord::MAX_EVENTS] = {};
+	bool bIdentity = true;
+	for (int32 Idx = 0; Idx < EventNames.Num(); Idx++)
+	{
+		TArray<FName> Events;
+		Events.Add(EventNames[Idx]);
+		InputBuffer->ConvertEventsToFlags(Events, BitMasks[Idx]);
+
+		bIdentity = bIdentity && (BitMasks[Idx] == (1ULL << Idx));
+	}
+
+	InputBuffer->BeginPlayback(FrameRate);
+	InputBuffer->ClearHistory();
+
+	FInputBufferRecordCodec Codec;
+	const uint8* Cursor = Body;
+	const uint8* End = Data + Size;
+	int32 NumRecords = 0;
+
+	while (Cursor < End)
+	{
+		EInputBufferReplayOp Op;
+		FInputBufferRecord Record;
+		uint64 Operand = 0;
+		uint64 SecondOperand = 0;
+		if (!Codec.ReadOp(Cursor, End, Op, Record, &Operand, &SecondOperand))
+		{
+			UE_LOG(InputBufferLog, Warning, TEXT("Replay is corrupted after %d records."), NumRecords);
+			NumRecords = INDEX_NONE;
+			break;
+		}
+
+		if (Op == EInputBufferReplayOp::Record)
+		{
+			if (!bIdentity)
+			{
+				Record.Events = RemapEventFlags(Record.Events, BitMasks);
+				Record.TranslatedEvents = RemapEventFlags(Record.TranslatedEvents, BitMasks);
+			}
+
+			InputBuffer->PlaybackRecord(Record);
+
+			// Only finished records are recorded, so commands are matched at the end of each record instead of at every frame of it.
+			for (UInputCommand* Command : Commands)
+			{
+				if (InputBuffer->MatchCommand(Command))
+				{
+					OutMatches.Add(FInputBufferPlaybackMatch(NumRecords, Record.EndTime, Command));
+				}
+			}
+
+			NumRecords++;
+		}
+		else if (Op == EInputBufferReplayOp::Invalidate)
+		{
+			InputBuffer->InvalidateHistory();
+		}
+		else if (Op == EInputBufferReplayOp::Consume)
+		{
+			InputBuffer->InvalidateHistoryFrom((int32)FMath::Min<uint64>(Operand, MAX_int32));
+		}
+		else if (Op == EInputBufferReplayOp::Clear)
+		{
+			InputBuffer->ClearHistory();
+		}
+		else if (Op == EInputBufferReplayOp::RollBack)
+		{
+			InputBuffer->PlaybackRollBack((int32)FMath::Min<uint64>(Operand, MAX_int32), (int32)FMath::Min<uint64>(SecondOperand, MAX_int32));
+		}
+	}
+
+	InputBuffer->EndPlayback();
+
+	return NumRecords;
+}
@@ -1,10 +1,10 @@
-// Copyright 2017 Isaac Hsu. MIT License
-
-#include "InputBuffer.h"
-
-// You should place include statements to your module's private header files here.  You only need to
-// add includes for headers that are used in most of your module's source files though.
-
-#include "Engine.h"
-
-
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBuffer.h"
+
+// You should place include statements to your module's private header files here.  You only need to
+// add includes for headers that are used in most of your module's source files though.
+
+#include "Engine.h"
+
+
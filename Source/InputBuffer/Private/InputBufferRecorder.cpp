@@ -0,0 +1,209 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferPrivatePCH.h"
+#include "InputBufferRecorder.h"
+
+//////////////////////////////////////////////////////////////////////////
+// FInputBufferReplayWriter
+
+/* Background thread that writes chunks of replay data to a file. Emptied chunks are sent back for reuse. */
+class FInputBufferReplayWriter : public FRunnable
+{
+public:
+
+	FInputBufferReplayWriter(FArchive* InArchive)
+		: Archive(InArchive)
+		, WorkEvent(FPlatformProcess::GetSynchEventFromPool())
+		, Thread(nullptr)
+	{
+		Thread = FRunnableThread::Create(this, TEXT("InputBufferReplayWriter"), 0, TPri_BelowNormal);
+	}
+
+	virtual ~FInputBufferReplayWriter()
+	{
+		bStopping = true;
+		WorkEvent->Trigger();
+
+		if (Thread)
+		{
+			Thread->WaitForCompletion();
+			delete Thread;
+		}
+		else
+		{
+			Run(); // Write synchronously if the platform cannot create threads.
+		}
+
+		FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+		delete Archive;
+	}
+
+	void Enqueue(TArray<uint8>&& Data)
+	{
+		Chunks.Enqueue(MoveTemp(Data));
+		WorkEvent->Trigger();
+	}
+
+	bool DequeueEmptyChunk(TArray<uint8>& Data)
+	{
+		return EmptyChunks.Dequeue(Data);
+	}
+
+	//~ Begin FRunnable Interface
+	virtual uint32 Run() override
+	{
+		while (true)
+		{
+			// Read the flag before draining so that chunks queued before stopping are always written.
+			const bool bStop = bStopping;
+
+			TArray<uint8> Data;
+			while (Chunks.Dequeue(Data))
+			{
+				Archive->Serialize(Data.GetData(), Data.Num());
+				Data.Reset();
+				EmptyChunks.Enqueue(MoveTemp(Data));
+			}
+
+			if (bStop)
+			{
+				break;
+			}
+
+			WorkEvent->Wait();
+		}
+
+		Archive->Flush();
+		return 0;
+	}
+	//~ End FRunnable Interface
+
+private:
+
+	FArchive* Archive;
+
+	FEvent* WorkEvent;
+
+	FRunnableThread* Thread;
+
+	FThreadSafeBool bStopping;
+
+	/* Chunks from the game thread to the writer thread. */
+	TQueue<TArray<uint8>, EQueueMode::Spsc> Chunks;
+
+	/* Written chunks from the writer thread back to the game thread. */
+	TQueue<TArray<uint8>, EQueueMode::Spsc> EmptyChunks;
+};
+
+//////////////////////////////////////////////////////////////////////////
+// FInputBufferRecorder
+
+/* The next serial number of a recorded history. Zero stands for no recording. */
+static uint32 NextClearSerial = 1;
+
+static uint32 AllocateClearSerial()
+{
+	const uint32 Serial = NextClearSerial++;
+	if (NextClearSerial == 0)
+	{
+		NextClearSerial = 1;
+	}
+
+	return Serial;
+}
+
+FInputBufferRecorder::FInputBufferRecorder()
+	: Writer(nullptr)
+	, NumRecords(0)
+	, ClearSerial(0)
+{
+}
+
+FInputBufferRecorder::~FInputBufferRecorder()
+{
+	Stop();
+}
+
+bool FInputBufferRecorder::Start(const FString& Filename, const TArray<FName>& EventNames, float FrameRate)
+{
+	Stop();
+
+	FArchive* Archive = IFileManager::Get().CreateFileWriter(*Filename);
+	if (Archive == nullptr)
+	{
+		UE_LOG(InputBufferLog, Warning, TEXT("Cannot open replay file '%s' for writing."), *Filename);
+		return false;
+	}
+
+	Codec.Reset();
+	Chunk.Reset(CHUNK_SIZE + FInputBufferReplayFormat::MAX_RECORD_SIZE);
+	FInputBufferReplayFormat::WriteHeader(Chunk, FrameRate, EventNames);
+
+	Writer = new FInputBufferReplayWriter(Archive);
+	NumRecords = 0;
+	ClearSerial = AllocateClearSerial();
+	return true;
+}
+
+void FInputBufferRecorder::Stop()
+{
+	if (Writer)
+	{
+		if (Chunk.Num() > 0)
+		{
+			Writer->Enqueue(MoveTemp(Chunk));
+		}
+
+		delete Writer;
+		Writer = nullptr;
+	}
+
+	Chunk.Empty();
+	NumRecords = 0;
+	ClearSerial = 0;
+}
+
+void FInputBufferRecorder::WriteRecord(const FInputBufferRecord& Record)
+{
+	check(Writer);
+
+	Codec.WriteRecord(Chunk, Record);
+	NumRecords++;
+	if (Chunk.Num() >= CHUNK_SIZE)
+	{
+		FlushChunk();
+	}
+}
+
+void FInputBufferRecorder::WriteOp(EInputBufferReplayOp Op, uint64 Operand, uint64 SecondOperand)
+{
+	check(Writer);
+
+	Codec.WriteOp(Chunk, Op, Operand, SecondOperand);
+
+	if (Op == EInputBufferReplayOp::Clear)
+	{
+		NumRecords = 0;
+		ClearSerial = AllocateClearSerial();
+	}
+	else if (Op == EInputBufferReplayOp::RollBack)
+	{
+		NumRecords -= (uint32)FMath::Min<uint64>(Operand, NumRecords);
+	}
+
+	if (Chunk.Num() >= CHUNK_SIZE)
+	{
+		FlushChunk();
+	}
+}
+
+void FInputBufferRecorder::FlushChunk()
+{
+	Writer->Enqueue(MoveTemp(Chunk));
+
+	// Reuse a written chunk if there is any, so that no allocation happens in steady state.
+	if (!Writer->DequeueEmptyChunk(Chunk))
+	{
+		Chunk.Reset(CHUNK_SIZE + FInputBufferReplayFormat::MAX_RECORD_SIZE);
+	}
+}
@@ -0,0 +1,214 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferPrivatePCH.h"
+#include "InputBufferReplay.h"
+#include "InputBufferComponent.h"
+
+namespace
+{
+	/* Flags packed in the tag byte of an operation above the operation code. */
+	const uint8 TAG_OP_MASK = 0x0F;
+	const uint8 TAG_VALID = 0x10;
+	const uint8 TAG_TRANSLATED = 0x20;
+
+	void WriteFixed32(TArray<uint8>& Out, uint32 Value)
+	{
+		Out.Add((uint8)Value);
+		Out.Add((uint8)(Value >> 8));
+		Out.Add((uint8)(Value >> 16));
+		Out.Add((uint8)(Value >> 24));
+	}
+
+	bool ReadFixed32(const uint8*& Cursor, const uint8* End, uint32& Value)
+	{
+		if (End - Cursor < 4)
+		{
+			return false;
+		}
+
+		Value = (uint32)Cursor[0] | ((uint32)Cursor[1] << 8) | ((uint32)Cursor[2] << 16) | ((uint32)Cursor[3] << 24);
+		Cursor += 4;
+		return true;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FInputBufferReplayFormat
+
+void FInputBufferReplayFormat::WriteHeader(TArray<uint8>& Out, float FrameRate, const TArray<FName>& EventNames)
+{
+	WriteFixed32(Out, Magic);
+	WriteFixed32(Out, Version);
+	WriteFixed32(Out, TimeToBits(FrameRate));
+
+	WriteVarInt(Out, EventNames.Num());
+	for (FName Name : EventNames)
+	{
+		FTCHARToUTF8 Converter(*Name.ToString());
+		WriteVarInt(Out, Converter.Length());
+		Out.Append((const uint8*)Converter.Get(), Converter.Length());
+	}
+}
+
+bool FInputBufferReplayFormat::ReadHeader(const uint8*& Cursor, const uint8* End, float& FrameRate, TArray<FName>& EventNames)
+{
+	uint32 Value = 0;
+	if (!ReadFixed32(Cursor, End, Value) || Value != Magic)
+	{
+		return false;
+	}
+
+	if (!ReadFixed32(Cursor, End, Value) || Value < MinVersion || Value > Version)
+	{
+		return false;
+	}
+
+	if (!ReadFixed32(Cursor, End, Value))
+	{
+		return false;
+	}
+	FrameRate = BitsToTime(Value);
+
+	uint64 NumNames = 0;
+	if (!ReadVarInt(Cursor, End, NumNames) || NumNames > FInputBufferRecord::MAX_EVENTS)
+	{
+		return false;
+	}
+
+	EventNames.Reset(NumNames);
+	for (uint64 Idx = 0; Idx < NumNames; Idx++)
+	{
+		uint64 Length = 0;
+		if (!ReadVarInt(Cursor, End, Length) || Length > (uint64)(End - Cursor))
+		{
+			return false;
+		}
+
+		FUTF8ToTCHAR Converter((const ANSICHAR*)Cursor, (int32)Length);
+		EventNames.Add(FName(*FString(Converter.Length(), Converter.Get())));
+		Cursor += Length;
+	}
+
+	return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FInputBufferRecordCodec
+
+void FInputBufferRecordCodec::WriteRecord(TArray<uint8>& Out, const FInputBufferRecord& Record)
+{
+	const uint32 StartBits = FInputBufferReplayFormat::TimeToBits(Record.StartTime);
+	const uint32 EndBits = FInputBufferReplayFormat::TimeToBits(Record.EndTime);
+
+	uint8 Tag = (uint8)EInputBufferReplayOp::Record;
+	Tag |= Record.bValid ? TAG_VALID : 0;
+	Tag |= Record.TranslatedEvents != 0 ? TAG_TRANSLATED : 0;
+	Out.Add(Tag);
+
+	FInputBufferReplayFormat::WriteVarInt(Out, FInputBufferReplayFormat::ZigZag((int64)StartBits - (int64)LastEndBits));
+	FInputBufferReplayFormat::WriteVarInt(Out, FInputBufferReplayFormat::ZigZag((int64)EndBits - (int64)StartBits));
+	FInputBufferReplayFormat::WriteVarInt(Out, Record.Events);
+	if (Record.TranslatedEvents != 0)
+	{
+		FInputBufferReplayFormat::WriteVarInt(Out, Record.TranslatedEvents);
+	}
+
+	LastEndBits = EndBits;
+}
+
+void FInputBufferRecordCodec::WriteOp(TArray<uint8>& Out, EInputBufferReplayOp Op, uint64 Operand, uint64 SecondOperand)
+{
+	check(Op != EInputBufferReplayOp::Record);
+	Out.Add((uint8)Op);
+
+	if (Op == EInputBufferReplayOp::Consume || Op == EInputBufferReplayOp::RollBack)
+	{
+		FInputBufferReplayFormat::WriteVarInt(Out, Operand);
+	}
+
+	if (Op == EInputBufferReplayOp::RollBack)
+	{
+		FInputBufferReplayFormat::WriteVarInt(Out, SecondOperand);
+	}
+}
+
+bool FInputBufferRecordCodec::ReadOp(const uint8*& Cursor, const uint8* End, EInputBufferReplayOp& Op, FInputBufferRecord& Record, uint64* OutOperand, uint64* OutSecondOperand)
+{
+	if (Cursor >= End)
+	{
+		return false;
+	}
+
+	const uint8 Tag = *Cursor++;
+	if ((Tag & TAG_OP_MASK) >= (uint8)EInputBufferReplayOp::Max)
+	{
+		return false;
+	}
+
+	Op = (EInputBufferReplayOp)(Tag & TAG_OP_MASK);
+	if (Op == EInputBufferReplayOp::Consume)
+	{
+		uint64 Operand = 0;
+		if (!FInputBufferReplayFormat::ReadVarInt(Cursor, End, Operand))
+		{
+			return false;
+		}
+
+		if (OutOperand)
+		{
+			*OutOperand = Operand;
+		}
+		return true;
+	}
+	else if (Op == EInputBufferReplayOp::RollBack)
+	{
+		uint64 Operand = 0;
+		uint64 SecondOperand = 0;
+		if (!FInputBufferReplayFormat::ReadVarInt(Cursor, End, Operand) || !FInputBufferReplayFormat::ReadVarInt(Cursor, End, SecondOperand))
+		{
+			return false;
+		}
+
+		if (OutOperand)
+		{
+			*OutOperand = Operand;
+		}
+		if (OutSecondOperand)
+		{
+			*OutSecondOperand = SecondOperand;
+		}
+		return true;
+	}
+	else if (Op != EInputBufferReplayOp::Record)
+	{
+		return true;
+	}
+
+	uint64 StartDelta = 0;
+	uint64 Duration = 0;
+	if (!FInputBufferReplayFormat::ReadVarInt(Cursor, End, StartDelta) || !FInputBufferReplayFormat::ReadVarInt(Cursor, End, Duration))
+	{
+		return false;
+	}
+
+	const uint32 StartBits = (uint32)((int64)LastEndBits + FInputBufferReplayFormat::UnZigZag(StartDelta));
+	const uint32 EndBits = (uint32)((int64)StartBits + FInputBufferReplayFormat::UnZigZag(Duration));
+
+	Record.bValid = (Tag & TAG_VALID) != 0;
+	Record.StartTime = FInputBufferReplayFormat::BitsToTime(StartBits);
+	Record.EndTime = FInputBufferReplayFormat::BitsToTime(EndBits);
+	Record.TranslatedEvents = 0;
+
+	if (!FInputBufferReplayFormat::ReadVarInt(Cursor, End, Record.Events))
+	{
+		return false;
+	}
+
+	if ((Tag & TAG_TRANSLATED) != 0 && !FInputBufferReplayFormat::ReadVarInt(Cursor, End, Record.TranslatedEvents))
+	{
+		return false;
+	}
+
+	LastEndBits = EndBits;
+	return true;
+}
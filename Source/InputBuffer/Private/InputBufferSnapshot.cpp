@@ -0,0 +1,55 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferPrivatePCH.h"
+#include "InputBufferSnapshot.h"
+#include "InputBufferComponent.h"
+
+//////////////////////////////////////////////////////////////////////////
+// FInputBufferSnapshotRing
+
+void FInputBufferSnapshotRing::Init(const UInputBufferComponent* InputBuffer, int32 NumSnapshots)
+{
+	check(InputBuffer);
+	check(NumSnapshots > 0);
+
+	SnapshotSize = InputBuffer->GetSnapshotSize();
+	SlotFrames.Init(INDEX_NONE, NumSnapshots);
+	Storage.SetNumUninitialized(SnapshotSize * NumSnapshots);
+}
+
+void FInputBufferSnapshotRing::Reset()
+{
+	for (int32& Frame : SlotFrames)
+	{
+		Frame = INDEX_NONE;
+	}
+}
+
+void FInputBufferSnapshotRing::Save(const UInputBufferComponent* InputBuffer, int32 Frame)
+{
+	check(InputBuffer);
+	check(SlotFrames.Num() > 0);
+
+	// The capacity of input history may change implicitly, e.g. when a command set is bound, so a stale layout must not overrun the slot.
+	if (InputBuffer->GetSnapshotSize() != SnapshotSize)
+	{
+		UE_LOG(InputBufferLog, Warning, TEXT("Snapshot ring is initialized again, dropping saved frames, because %s changed its layout."), *InputBuffer->GetPathName());
+		Init(InputBuffer, SlotFrames.Num());
+	}
+
+	const int32 Slot = GetSlot(Frame);
+	InputBuffer->SaveSnapshot(Storage.GetData() + Slot * SnapshotSize);
+	SlotFrames[Slot] = Frame;
+}
+
+bool FInputBufferSnapshotRing::Restore(UInputBufferComponent* InputBuffer, int32 Frame) const
+{
+	check(InputBuffer);
+
+	if (!Contains(Frame))
+	{
+		return false;
+	}
+
+	return InputBuffer->RestoreSnapshot(Storage.GetData() + GetSlot(Frame) * SnapshotSize);
+}
@@ -1,4 +1,165 @@
-// Copyright 2017 Isaac Hsu. MIT License
-
-#include "InputBufferPrivatePCH.h"
-#include "InputCommand.h"
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferPrivatePCH.h"
+#include "InputCommand.h"
+#include "InputBufferCustomVersion.h"
+
+UInputCommand::UInputCommand()
+	: CompiledSerial(0)
+{
+}
+
+void UInputCommand::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	Ar.UsingCustomVersion(FInputBufferCustomVersion::GUID);
+
+	if (Ar.CustomVer(FInputBufferCustomVersion::GUID) >= FInputBufferCustomVersion::CompiledInputCommand)
+	{
+		// Compiled data is only stored in cooked assets. Otherwise it is compiled on demand, so it never goes stale in the editor.
+		// Sequences are stored in cooked assets too, since Blueprints may read them and replace them with SetSequences at runtime,
+		// which compiles them again, and MatchCommandReference interprets them. Compiled data only takes a fraction of their size.
+		bool bHasCompiledData = Ar.IsSaving() && Ar.IsCooking();
+		Ar << bHasCompiledData;
+
+		if (bHasCompiledData)
+		{
+			if (Ar.IsSaving())
+			{
+				Compile();
+			}
+
+			Ar << CompiledData;
+
+			if (Ar.IsLoading())
+			{
+				CompiledSerial = AllocateCompiledSerial();
+			}
+		}
+	}
+}
+
+uint32 UInputCommand::AllocateCompiledSerial()
+{
+	// Assets may be loaded on the async loading thread.
+	static volatile int32 NextCompiledSerial = 0;
+
+	uint32 Serial;
+	do
+	{
+		Serial = (uint32)FPlatformAtomics::InterlockedIncrement(&NextCompiledSerial);
+	}
+	while (Serial == 0); // Zero means not compiled.
+
+	return Serial;
+}
+
+#if WITH_EDITOR
+void UInputCommand::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	InvalidateCompiledData();
+}
+#endif
+
+const FCompiledInputCommand& UInputCommand::GetCompiledData() const
+{
+	if (CompiledSerial == 0)
+	{
+		Compile();
+	}
+
+	return CompiledData;
+}
+
+void UInputCommand::InvalidateCompiledData()
+{
+	CompiledSerial = 0;
+}
+
+void UInputCommand::SetTimeLimit(float NewTimeLimit)
+{
+	TimeLimit = FMath::Max(NewTimeLimit, 0.f);
+	InvalidateCompiledData();
+}
+
+void UInputCommand::SetEventsToIgnore(const TArray<FName>& NewEventsToIgnore)
+{
+	EventsToIgnore = NewEventsToIgnore;
+	InvalidateCompiledData();
+}
+
+void UInputCommand::SetSequences(const TArray<FInputCommandSequence>& NewSequences)
+{
+	Sequences = NewSequences;
+	InvalidateCompiledData();
+}
+
+void UInputCommand::Compile() const
+{
+	CompiledData.Reset();
+	CompiledData.TimeLimit = TimeLimit;
+
+	TMap<FName, int32> NameIndexMap;
+	auto AddNames = [&](const TArray<FName>& Events, int32& OutFirst, int32& OutNum)
+	{
+		OutFirst = CompiledData.NameRefs.Num();
+		OutNum = Events.Num();
+		for (const FName& Event : Events)
+		{
+			int32* Index = NameIndexMap.Find(Event);
+			if (Index == nullptr)
+			{
+				Index = &NameIndexMap.Add(Event, CompiledData.Names.Add(Event));
+			}
+			CompiledData.NameRefs.Add(*Index);
+		}
+	};
+
+	AddNames(EventsToIgnore, CompiledData.FirstIgnoreName, CompiledData.NumIgnoreNames);
+
+	for (const FInputCommandSequence& Sequence : Sequences)
+	{
+		if (Sequence.bEnabled)
+		{
+			auto& CompiledSequence = CompiledData.Sequences[CompiledData.Sequences.AddDefaulted()];
+			CompiledSequence.FirstEntry = CompiledData.Entries.Num();
+			CompiledSequence.NumEntries = Sequence.Entries.Num();
+
+			for (const FInputCommandEntry& Entry : Sequence.Entries)
+			{
+				auto& CompiledEntry = CompiledData.Entries[CompiledData.Entries.AddDefaulted()];
+				AddNames(Entry.EventsToMatch, CompiledEntry.FirstMatchName, CompiledEntry.NumMatchNames);
+				AddNames(Entry.EventsToIgnore, CompiledEntry.FirstIgnoreName, CompiledEntry.NumIgnoreNames);
+				CompiledEntry.MinDuration = Entry.MinDuration;
+				CompiledEntry.MaxDuration = Entry.MaxDuration;
+				CompiledEntry.MinInterval = Entry.MinInterval;
+				CompiledEntry.MaxInterval = Entry.MaxInterval;
+				CompiledEntry.bIgnoreOthers = Entry.bIgnoreOthers;
+			}
+		}
+	}
+
+	CompiledSerial = AllocateCompiledSerial();
+}
+
+void UInputCommand::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	SIZE_T Size = EventsToIgnore.GetAllocatedSize() + Sequences.GetAllocatedSize();
+	for (const FInputCommandSequence& Sequence : Sequences)
+	{
+		Size += Sequence.Entries.GetAllocatedSize();
+		for (const FInputCommandEntry& Entry : Sequence.Entries)
+		{
+			Size += Entry.EventsToMatch.GetAllocatedSize() + Entry.EventsToIgnore.GetAllocatedSize();
+		}
+	}
+
+	Size += CompiledData.GetAllocatedSize();
+
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Size);
+}
@@ -0,0 +1,129 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferPrivatePCH.h"
+#include "InputCommandSet.h"
+#include "InputCommand.h"
+#include "InputBufferCustomVersion.h"
+
+UInputCommandSet::UInputCommandSet()
+	: CompiledSerial(0)
+{
+}
+
+void UInputCommandSet::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	Ar.UsingCustomVersion(FInputBufferCustomVersion::GUID);
+
+	// Compiled data is only stored in cooked assets, like compiled data of input commands.
+	bool bHasCompiledData = Ar.IsSaving() && Ar.IsCooking();
+	Ar << bHasCompiledData;
+
+	if (bHasCompiledData)
+	{
+		if (Ar.IsSaving())
+		{
+			Compile();
+		}
+
+		Ar << CompiledData;
+
+		if (Ar.IsLoading())
+		{
+			CompiledSerial = UInputCommand::AllocateCompiledSerial();
+			CommandSerials.Empty();
+		}
+	}
+}
+
+void UInputCommandSet::PostLoad()
+{
+	Super::PostLoad();
+
+	if (CompiledSerial != 0)
+	{
+		// Compiled data was loaded from cooked assets, along with compiled data of the commands.
+		// Captures their serial numbers so that modifying any command at runtime invalidates the set, as in uncooked builds.
+		// A command not loaded yet has a zero serial number, which only makes the set compile once more.
+		CommandSerials.Reset(Commands.Num());
+
+		for (const UInputCommand* Command : Commands)
+		{
+			CommandSerials.Add(Command ? Command->GetCompiledSerial() : 0);
+		}
+	}
+}
+
+void UInputCommandSet::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Commands.GetAllocatedSize() + CompiledData.GetAllocatedSize() + CommandSerials.GetAllocatedSize());
+}
+
+#if WITH_EDITOR
+void UInputCommandSet::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	InvalidateCompiledData();
+}
+#endif
+
+const FCompiledInputCommandSet& UInputCommandSet::GetCompiledData() const
+{
+	if (CompiledSerial == 0 || AreCommandsModified())
+	{
+		Compile();
+	}
+
+	return CompiledData;
+}
+
+void UInputCommandSet::InvalidateCompiledData()
+{
+	CompiledSerial = 0;
+}
+
+void UInputCommandSet::Compile() const
+{
+	CompiledData.Reset();
+	CommandSerials.Reset(Commands.Num());
+
+	for (const UInputCommand* Command : Commands)
+	{
+		if (Command)
+		{
+			CompiledData.Add(Command->GetCompiledData());
+			CommandSerials.Add(Command->GetCompiledSerial());
+		}
+		else
+		{
+			CompiledData.Add(FCompiledInputCommand()); // Keeps indices of commands.
+			CommandSerials.Add(0);
+		}
+	}
+
+	CompiledSerial = UInputCommand::AllocateCompiledSerial();
+}
+
+bool UInputCommandSet::AreCommandsModified() const
+{
+	if (CommandSerials.Num() != Commands.Num())
+	{
+		return true;
+	}
+
+	for (int32 Idx = 0; Idx < Commands.Num(); Idx++)
+	{
+		// An invalidated command has a zero serial number, and so does a recompiled command have a new one.
+		const uint32 Serial = Commands[Idx] ? Commands[Idx]->GetCompiledSerial() : 0;
+		if (Serial != CommandSerials[Idx])
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,248 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferPrivatePCH.h"
+#include "InputHistoryArchive.h"
+#include "EventBitPermutation.h"
+
+//////////////////////////////////////////////////////////////////////////
+// FInputHistoryArchive
+
+void FInputHistoryArchive::SetMaxRecords(int32 InMaxRecords)
+{
+	MaxRecords = FMath::Max(InMaxRecords, 0);
+	Trim();
+}
+
+void FInputHistoryArchive::Add(const FInputBufferRecord& Record)
+{
+	if (Blocks.Num() == 0 || Blocks.Last().NumRecords == RECORDS_PER_BLOCK)
+	{
+		// Each block starts delta encoding over, so it can be decoded without the blocks before it.
+		Codec.Reset();
+
+		FBlock& Block = Blocks[Blocks.AddUninitialized()];
+		Block.Offset = Data.Num();
+		Block.NumRecords = 0;
+	}
+
+	Codec.WriteRecord(Data, Record);
+
+	FBlock& Block = Blocks.Last();
+	Block.NumRecords++;
+	Block.EndTime = Record.EndTime;
+	NumRecords++;
+	NumAdded++;
+
+	Trim();
+}
+
+void FInputHistoryArchive::Reset()
+{
+	Data.Reset();
+	Blocks.Reset();
+	Codec.Reset();
+	NumRecords = 0;
+	NumAdded = 0;
+}
+
+void FInputHistoryArchive::RollBack(uint32 InNumAdded)
+{
+	const int32 NumRemoved = (int32)(NumAdded - InNumAdded);
+	if (NumRemoved <= 0)
+	{
+		return; // since nothing was added after that point
+	}
+
+	if (NumRemoved >= NumRecords)
+	{
+		Reset();
+		NumAdded = InNumAdded;
+		return;
+	}
+
+	// Find the block of the last record kept. Blocks after it are dropped whole.
+	const int32 NumKept = NumRecords - NumRemoved;
+	int32 BlockIdx = Blocks.Num();
+	int32 NumBefore = NumRecords;
+	while (NumBefore > NumKept)
+	{
+		BlockIdx--;
+		NumBefore -= Blocks[BlockIdx].NumRecords;
+	}
+
+	// The block is encoded again from its kept records, which also restores the delta encoding state for records added next.
+	TArray<FInputBufferRecord, TInlineAllocator<RECORDS_PER_BLOCK>> KeptRecords;
+	if (NumKept > NumBefore)
+	{
+		FInputBufferRecordCodec Decoder;
+		const uint8* Cursor = Data.GetData() + Blocks[BlockIdx].Offset;
+		const uint8* End = Data.GetData() + Data.Num();
+		KeptRecords.SetNum(NumKept - NumBefore);
+		for (FInputBufferRecord& Record : KeptRecords)
+		{
+			EInputBufferReplayOp Op;
+			verify(Decoder.ReadOp(Cursor, End, Op, Record) && Op == EInputBufferReplayOp::Record);
+		}
+	}
+
+	Data.SetNum(Blocks[BlockIdx].Offset, false);
+	Blocks.SetNum(BlockIdx, false);
+	NumRecords = NumBefore;
+
+	for (const FInputBufferRecord& Record : KeptRecords)
+	{
+		Add(Record);
+	}
+
+	NumAdded = InNumAdded;
+}
+
+void FInputHistoryArchive::RemapEvents(const FEventBitPermutation& Permutation)
+{
+	TArray<FInputBufferRecord> Records;
+	Records.Reserve(NumRecords);
+
+	FReader Reader(*this);
+	FInputBufferRecord Record;
+	while (Reader.Next(Record))
+	{
+		Record.Events = Permutation.Apply(Record.Events);
+		Record.TranslatedEvents = Permutation.Apply(Record.TranslatedEvents);
+		Records.Add(Record);
+	}
+
+	const uint32 OldNumAdded = NumAdded;
+	Reset();
+	for (const FInputBufferRecord& Remapped : Records)
+	{
+		Add(Remapped);
+	}
+	NumAdded = OldNumAdded;
+}
+
+void FInputHistoryArchive::Trim()
+{
+	if (MaxRecords == 0)
+	{
+		return;
+	}
+
+	// The last block is still being filled, so it is never dropped.
+	int32 NumDropped = 0;
+	int32 NumKept = NumRecords;
+	while (NumDropped < Blocks.Num() - 1 && NumKept - Blocks[NumDropped].NumRecords >= MaxRecords)
+	{
+		NumKept -= Blocks[NumDropped].NumRecords;
+		NumDropped++;
+	}
+
+	if (NumDropped > 0)
+	{
+		const int32 NumBytes = Blocks[NumDropped].Offset;
+		Data.RemoveAt(0, NumBytes, false);
+		Blocks.RemoveAt(0, NumDropped, false);
+		for (FBlock& Block : Blocks)
+		{
+			Block.Offset -= NumBytes;
+		}
+
+		NumRecords = NumKept;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FInputHistoryArchive::FReader
+
+FInputHistoryArchive::FReader::FReader(const FInputHistoryArchive& InArchive)
+	: Archive(InArchive)
+	, BlockIdx(0)
+	, NumLeft(0)
+	, Cursor(nullptr)
+	, bPending(false)
+{
+	StartBlock(0);
+}
+
+void FInputHistoryArchive::FReader::StartBlock(int32 InBlockIdx)
+{
+	BlockIdx = InBlockIdx;
+	Codec.Reset();
+	bPending = false;
+
+	if (BlockIdx < Archive.Blocks.Num())
+	{
+		Cursor = Archive.Data.GetData() + Archive.Blocks[BlockIdx].Offset;
+		NumLeft = Archive.Blocks[BlockIdx].NumRecords;
+	}
+	else
+	{
+		Cursor = nullptr;
+		NumLeft = 0;
+	}
+}
+
+bool FInputHistoryArchive::FReader::Seek(float Time)
+{
+	// Blocks end in chronological order, so find the first one that ends at or after the time.
+	int32 Low = 0;
+	int32 High = Archive.Blocks.Num();
+	while (Low < High)
+	{
+		const int32 Mid = (Low + High) / 2;
+		if (Archive.Blocks[Mid].EndTime < Time)
+		{
+			Low = Mid + 1;
+		}
+		else
+		{
+			High = Mid;
+		}
+	}
+
+	StartBlock(Low);
+
+	FInputBufferRecord Record;
+	while (Next(Record))
+	{
+		if (Record.EndTime >= Time)
+		{
+			PendingRecord = Record;
+			bPending = true;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool FInputHistoryArchive::FReader::Next(FInputBufferRecord& OutRecord)
+{
+	if (bPending)
+	{
+		OutRecord = PendingRecord;
+		bPending = false;
+		return true;
+	}
+
+	while (NumLeft == 0)
+	{
+		if (BlockIdx + 1 >= Archive.Blocks.Num())
+		{
+			return false;
+		}
+
+		StartBlock(BlockIdx + 1);
+	}
+
+	const uint8* End = Archive.Data.GetData() + Archive.Data.Num();
+
+	EInputBufferReplayOp Op;
+	if (!Codec.ReadOp(Cursor, End, Op, OutRecord) || Op != EInputBufferReplayOp::Record)
+	{
+		checkNoEntry(); // The archive encodes nothing but records.
+		return false;
+	}
+
+	NumLeft--;
+	return true;
+}
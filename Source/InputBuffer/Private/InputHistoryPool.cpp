@@ -0,0 +1,61 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferPrivatePCH.h"
+#include "InputHistoryPool.h"
+
+FInputHistoryPool& FInputHistoryPool::Get()
+{
+	static FInputHistoryPool Pool;
+	return Pool;
+}
+
+void FInputHistoryPool::Acquire(int32 Capacity, TArray<FInputBufferRecord>& OutStorage)
+{
+	check(Capacity >= 0);
+
+	// Take the smallest storage that fits, unless it would waste more than it holds.
+	int32 BestIdx = INDEX_NONE;
+	for (int32 Idx = 0; Idx < Storages.Num(); Idx++)
+	{
+		const int32 Max = Storages[Idx].Max();
+		if (Max >= Capacity && Max <= Capacity * 2 && (BestIdx == INDEX_NONE || Max < Storages[BestIdx].Max()))
+		{
+			BestIdx = Idx;
+		}
+	}
+
+	if (BestIdx == INDEX_NONE)
+	{
+		OutStorage.Empty(Capacity);
+		return;
+	}
+
+	NumPooledRecords -= Storages[BestIdx].Max();
+	OutStorage = MoveTemp(Storages[BestIdx]);
+	Storages.RemoveAtSwap(BestIdx, 1, false);
+}
+
+void FInputHistoryPool::Release(TArray<FInputBufferRecord>& Storage)
+{
+	const int32 Max = Storage.Max();
+	if (Max == 0)
+	{
+		return;
+	}
+
+	if (NumPooledRecords + Max > MAX_POOLED_RECORDS)
+	{
+		Storage.Empty();
+		return;
+	}
+
+	Storage.Reset();
+	NumPooledRecords += Max;
+	Storages.Add(MoveTemp(Storage));
+}
+
+void FInputHistoryPool::Empty()
+{
+	Storages.Empty();
+	NumPooledRecords = 0;
+}
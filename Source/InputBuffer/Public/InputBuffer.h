@@ -1,16 +1,18 @@
-// Copyright 2017 Isaac Hsu. MIT License
-
-#pragma once
-
-#include "ModuleManager.h"
-
-DECLARE_LOG_CATEGORY_EXTERN(InputBufferLog, Log, All);
-
-class FInputBufferModule : public IModuleInterface
-{
-public:
-
-	/** IModuleInterface implementation */
-	virtual void StartupModule() override;
-	virtual void ShutdownModule() override;
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+#include "ModuleManager.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(InputBufferLog, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("InputBuffer"), STATGROUP_InputBuffer, STATCAT_Advanced);
+
+class FInputBufferModule : public IModuleInterface
+{
+public:
+
+	/** IModuleInterface implementation */
+	virtual void StartupModule() override;
+	virtual void ShutdownModule() override;
 };
\ No newline at end of file
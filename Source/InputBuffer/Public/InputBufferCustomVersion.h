@@ -0,0 +1,26 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+/* Custom serialization version for assets of the input buffer plugin. */
+struct INPUTBUFFER_API FInputBufferCustomVersion
+{
+	enum Type
+	{
+		// Before any version changes were made in the plugin
+		BeforeCustomVersionWasAdded = 0,
+
+		// Input commands store compiled data in cooked assets
+		CompiledInputCommand,
+
+		// -----<new versions can be added above this line>-------------------------------------------------
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	// The GUID for this custom version number
+	const static FGuid GUID;
+
+private:
+	FInputBufferCustomVersion() {}
+};
@@ -0,0 +1,85 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+/**
+* Histogram of latencies in buckets of a quarter octave each, from 10 microseconds up to about 10 seconds.
+* Percentiles are estimated from bucket bounds, so no samples need to be stored.
+*/
+struct INPUTBUFFER_API FInputBufferLatencyHistogram
+{
+	static const int32 NUM_BUCKETS = 80;
+
+	FInputBufferLatencyHistogram()
+	{
+		Reset();
+	}
+
+	void Reset();
+
+	void Add(double Seconds);
+
+	/* Returns the estimated latency in seconds below which a given percentage of samples falls. */
+	double GetPercentile(double Percentage) const;
+
+	double GetMean() const
+	{
+		return Count > 0 ? Sum / Count : 0.0;
+	}
+
+	/* Returns the upper bound of a bucket in seconds. */
+	static double GetBucketBound(int32 Bucket);
+
+	uint32 Buckets[NUM_BUCKETS];
+
+	uint32 Count;
+
+	double Sum;
+
+	double Max;
+};
+
+/**
+* Collects input latencies of all input buffers:
+* - Ingestion: from the first key event in a frame to the input record appearing in input history.
+* - Recognition: from the key event of the latest input record to an input command matching it, per input command.
+*
+* Tracking is enabled with the console variable InputBuffer.TrackLatency. Results are available through the console commands
+* InputBuffer.Latency.Dump, InputBuffer.Latency.Csv [Filename] and InputBuffer.Latency.Reset.
+*/
+class INPUTBUFFER_API FInputBufferLatencyTracker
+{
+public:
+
+	static FInputBufferLatencyTracker& Get();
+
+	static bool IsEnabled();
+
+	void AddIngestion(uint64 SourceCycles);
+
+	void AddRecognition(FName Command, uint64 SourceCycles);
+
+	void Reset();
+
+	/* Prints percentiles of all histograms to the log. */
+	void Dump() const;
+
+	/* Writes percentiles of all histograms in milliseconds to a CSV file. */
+	bool WriteCsv(const FString& Filename) const;
+
+	const FInputBufferLatencyHistogram& GetIngestion() const
+	{
+		return Ingestion;
+	}
+
+	const TMap<FName, FInputBufferLatencyHistogram>& GetRecognition() const
+	{
+		return Recognition;
+	}
+
+protected:
+
+	FInputBufferLatencyHistogram Ingestion;
+
+	TMap<FName, FInputBufferLatencyHistogram> Recognition;
+};
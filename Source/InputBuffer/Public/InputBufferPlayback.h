@@ -0,0 +1,113 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+#include "InputBufferReplay.h"
+
+class UInputBufferComponent;
+class UInputCommand;
+
+/* An input command recognized while playing back a replay. */
+struct FInputBufferPlaybackMatch
+{
+	FInputBufferPlaybackMatch(int32 InRecordIndex, float InTime, UInputCommand* InCommand)
+		: RecordIndex(InRecordIndex)
+		, Time(InTime)
+		, Command(InCommand)
+	{}
+
+	/* The index of the played record, counting from zero, after which the command was recognized. */
+	int32 RecordIndex;
+
+	/* The end time of the played record. */
+	float Time;
+
+	/* The recognized input command. */
+	UInputCommand* Command;
+};
+
+/**
+* Plays back an input buffer replay written by FInputBufferRecorder.
+* Records are fed directly into an input buffer without any clock, so replays can be verified as fast as possible, e.g. in headless regression runs.
+* The replay file is memory-mapped where supported and loaded into memory otherwise.
+*
+* Caution: Commands are matched once per record, when the record is finished, at its end time. Live input buffers match every frame while the latest
+* record grows, so a command whose time limits or durations only hold partway through a long record is recognized live but not in playback.
+* Replays cannot tell at which frame of a record an invalidation or a consumed command happened, so matching at every frame would not be exact either.
+*/
+class INPUTBUFFER_API FInputBufferPlayback
+{
+public:
+
+	FInputBufferPlayback();
+	~FInputBufferPlayback();
+
+	/**
+	* Opens a replay file and reads its header.
+	*
+	* @return False if the file cannot be read or is not a replay of a supported version.
+	*/
+	bool Open(const FString& Filename);
+
+	void Close();
+
+	bool IsOpen() const
+	{
+		return Data != nullptr;
+	}
+
+	/* Returns names of recorded input events in bit order. */
+	const TArray<FName>& GetEventNames() const
+	{
+		return EventNames;
+	}
+
+	/* Returns frames per second if record times are frame indices, or zero if they are in seconds. */
+	float GetFrameRate() const
+	{
+		return FrameRate;
+	}
+
+	/* Sets up an input buffer with the recorded input events and no key bindings, so a replay can be played without any player controller. */
+	void InitializeInputBuffer(UInputBufferComponent* InputBuffer) const;
+
+	/**
+	* Plays the whole replay through an input buffer and matches given input commands after every played record, at its end time. See the caution above.
+	* Recorded input events are mapped to those of the input buffer by name. Events unknown to the input buffer are dropped.
+	*
+	* @param InputBuffer The input buffer to feed. Its input history is cleared first.
+	* @param Commands Input commands to match.
+	* @param OutMatches Input commands recognized during playback.
+	* @return The number of played records, or INDEX_NONE if the replay is corrupted.
+	*/
+	int32 Play(UInputBufferComponent* InputBuffer, const TArray<UInputCommand*>& Commands, TArray<FInputBufferPlaybackMatch>& OutMatches) const;
+
+protected:
+
+	/* Memory-maps a file. Returns false if memory-mapping is not supported on this platform or fails. */
+	bool MapFile(const FString& Filename);
+
+	/* Start of the replay data. */
+	const uint8* Data;
+
+	/* Size of the replay data in bytes. */
+	int64 Size;
+
+	/* Start of the operation stream after the header. */
+	const uint8* Body;
+
+	/* Address of the memory-mapped file, if any. */
+	void* MappedData;
+
+	/* Replay data loaded into memory where memory-mapping is unavailable. */
+	TArray<uint8> LoadedData;
+
+	TArray<FName> EventNames;
+
+	float FrameRate;
+
+private:
+
+	FInputBufferPlayback(const FInputBufferPlayback&) = delete;
+	FInputBufferPlayback& operator=(const FInputBufferPlayback&) = delete;
+};
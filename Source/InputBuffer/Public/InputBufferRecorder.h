@@ -0,0 +1,88 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+#include "InputBufferReplay.h"
+
+/**
+* Streams input records to a binary replay file (see FInputBufferReplayFormat).
+* Encoded data is buffered in memory and handed over in chunks to a background thread, so the game thread never waits on file I/O while recording.
+*/
+class INPUTBUFFER_API FInputBufferRecorder
+{
+public:
+
+	/* Size of the chunks handed over to the writer thread. */
+	static const int32 CHUNK_SIZE = 64 * 1024;
+
+	FInputBufferRecorder();
+	~FInputBufferRecorder();
+
+	/**
+	* Opens a replay file and writes its header.
+	*
+	* @param Filename Path of the replay file.
+	* @param EventNames Names of input events in bit order.
+	* @param FrameRate Frames per second if record times are frame indices, or zero if they are in seconds.
+	* @return Whether the file can be opened for writing.
+	*/
+	bool Start(const FString& Filename, const TArray<FName>& EventNames, float FrameRate);
+
+	/* Writes all buffered data and closes the replay file. Blocks until the writer thread finishes. */
+	void Stop();
+
+	bool IsRecording() const
+	{
+		return Writer != nullptr;
+	}
+
+	/* Writes a finished input record. */
+	void WriteRecord(const FInputBufferRecord& Record);
+
+	/* Writes an operation on input history other than adding records. See FInputBufferRecordCodec::WriteOp. */
+	void WriteOp(EInputBufferReplayOp Op, uint64 Operand = 0, uint64 SecondOperand = 0);
+
+	/* Returns the number of records in the replay since recording started or input history was last cleared, excluding removed ones. */
+	uint32 GetNumRecords() const
+	{
+		return NumRecords;
+	}
+
+	/**
+	* Returns a serial number that changes whenever recording starts or input history is cleared, and is unique among all recorders.
+	* Record counts taken under different serial numbers count records of different histories, so they cannot be compared.
+	*/
+	uint32 GetClearSerial() const
+	{
+		return ClearSerial;
+	}
+
+	/* Returns the size of encoded data buffered on the game thread. Chunks queued for the writer thread are not counted. */
+	SIZE_T GetAllocatedSize() const
+	{
+		return Chunk.GetAllocatedSize();
+	}
+
+protected:
+
+	/* Hands the current chunk over to the writer thread and starts a new one. */
+	void FlushChunk();
+
+	FInputBufferRecordCodec Codec;
+
+	/* Encoded data not yet handed over to the writer thread. */
+	TArray<uint8> Chunk;
+
+	class FInputBufferReplayWriter* Writer;
+
+	/* See GetNumRecords. */
+	uint32 NumRecords;
+
+	/* See GetClearSerial. Zero if not recording. */
+	uint32 ClearSerial;
+
+private:
+
+	FInputBufferRecorder(const FInputBufferRecorder&) = delete;
+	FInputBufferRecorder& operator=(const FInputBufferRecorder&) = delete;
+};
@@ -0,0 +1,157 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+struct FInputBufferRecord;
+
+/* Operations stored in an input buffer replay. */
+enum class EInputBufferReplayOp : uint8
+{
+	/* A finished input record is added to input history. */
+	Record = 0,
+
+	/* All records in input history become invalid. */
+	Invalidate = 1,
+
+	/* All records in input history are removed. */
+	Clear = 2,
+
+	/* Records in input history become invalid except a number of the latest ones, stored as a variable-length integer after the tag. */
+	Consume = 3,
+
+	/**
+	* The latest records in input history are removed, as when a snapshot is restored. Two variable-length integers follow the tag:
+	* the number of records to remove, and the number of the latest remaining records that are valid again.
+	* Records evicted from a full input history since then are not brought back.
+	*/
+	RollBack = 4,
+
+	Max,
+};
+
+/**
+* Binary format of input buffer replays.
+*
+* A replay starts with a header of magic, version, frame rate (zero if times are in seconds) and a table of input event names in bit order.
+* The header is followed by a stream of operations, each of which starts with a tag byte.
+* A record stores the distances between IEEE bit patterns of its times and the end time of the previous record, which are small integers since
+* buffer times rarely decrease, followed by its event bit flags. All of them are variable-length integers, so a typical record takes a few bytes.
+*/
+struct INPUTBUFFER_API FInputBufferReplayFormat
+{
+	static const uint32 Magic = 0x43524249; // "IBRC"
+	static const uint32 Version = 3;
+
+	/* Replays of older versions are still readable, since later versions only add operations. */
+	static const uint32 MinVersion = 1;
+
+	/* The maximal number of bytes of an encoded record. */
+	static const int32 MAX_RECORD_SIZE = 1 + 4 * 10;
+
+	static void WriteHeader(TArray<uint8>& Out, float FrameRate, const TArray<FName>& EventNames);
+
+	/**
+	* Reads the header of a replay.
+	*
+	* @param Cursor Points to the beginning of the replay. Advanced to the first operation on success.
+	* @return False if the data is not a replay of a supported version.
+	*/
+	static bool ReadHeader(const uint8*& Cursor, const uint8* End, float& FrameRate, TArray<FName>& EventNames);
+
+	FORCEINLINE static void WriteVarInt(TArray<uint8>& Out, uint64 Value)
+	{
+		while (Value >= 0x80)
+		{
+			Out.Add((uint8)(Value | 0x80));
+			Value >>= 7;
+		}
+		Out.Add((uint8)Value);
+	}
+
+	FORCEINLINE static bool ReadVarInt(const uint8*& Cursor, const uint8* End, uint64& Value)
+	{
+		Value = 0;
+		for (int32 Shift = 0; Shift < 64 && Cursor < End; Shift += 7)
+		{
+			const uint8 Byte = *Cursor++;
+			Value |= (uint64)(Byte & 0x7F) << Shift;
+			if ((Byte & 0x80) == 0)
+			{
+				return true;
+			}
+		}
+
+		return false; // Truncated or malformed
+	}
+
+	/* Maps signed integers to unsigned ones so that small magnitudes take few bytes. */
+	FORCEINLINE static uint64 ZigZag(int64 Value)
+	{
+		return ((uint64)Value << 1) ^ (uint64)(Value >> 63);
+	}
+
+	FORCEINLINE static int64 UnZigZag(uint64 Value)
+	{
+		return (int64)(Value >> 1) ^ -(int64)(Value & 1);
+	}
+
+	FORCEINLINE static uint32 TimeToBits(float Time)
+	{
+		uint32 Bits;
+		FMemory::Memcpy(&Bits, &Time, sizeof(Bits));
+		return Bits;
+	}
+
+	FORCEINLINE static float BitsToTime(uint32 Bits)
+	{
+		float Time;
+		FMemory::Memcpy(&Time, &Bits, sizeof(Time));
+		return Time;
+	}
+};
+
+/**
+* Encodes and decodes the operation stream of input buffer replays.
+* Records are delta-encoded against the previous one, so the same codec must be used for the whole stream.
+*/
+class INPUTBUFFER_API FInputBufferRecordCodec
+{
+public:
+
+	FInputBufferRecordCodec()
+		: LastEndBits(0)
+	{}
+
+	/* Restarts delta encoding, e.g. at the beginning of an independently decodable block. */
+	void Reset()
+	{
+		LastEndBits = 0;
+	}
+
+	void WriteRecord(TArray<uint8>& Out, const FInputBufferRecord& Record);
+
+	/**
+	* Writes an operation other than adding a record.
+	*
+	* @param Operand The number of records that stay valid if the operation is EInputBufferReplayOp::Consume, or the number of records to remove if it is EInputBufferReplayOp::RollBack. Unused otherwise.
+	* @param SecondOperand The number of records that are valid again if the operation is EInputBufferReplayOp::RollBack. Unused otherwise.
+	*/
+	void WriteOp(TArray<uint8>& Out, EInputBufferReplayOp Op, uint64 Operand = 0, uint64 SecondOperand = 0);
+
+	/**
+	* Reads an operation from a stream.
+	*
+	* @param Cursor Points to the operation. Advanced to the next operation on success.
+	* @param Op The read operation.
+	* @param Record The read record if the operation is EInputBufferReplayOp::Record.
+	* @param OutOperand (Optional) Set to the operand if the operation is EInputBufferReplayOp::Consume or EInputBufferReplayOp::RollBack.
+	* @param OutSecondOperand (Optional) Set to the second operand if the operation is EInputBufferReplayOp::RollBack.
+	* @return False if the stream is truncated or corrupted.
+	*/
+	bool ReadOp(const uint8*& Cursor, const uint8* End, EInputBufferReplayOp& Op, FInputBufferRecord& Record, uint64* OutOperand = nullptr, uint64* OutSecondOperand = nullptr);
+
+protected:
+
+	/* Bit pattern of the end time of the last record. */
+	uint32 LastEndBits;
+};
@@ -0,0 +1,73 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+class UInputBufferComponent;
+
+/**
+* A ring of input buffer snapshots indexed by frame number, e.g. for rollback netcode.
+* Storage of all snapshots is allocated up front, so saving and restoring are plain memory copies.
+*
+* Caution: Should be initialized again after the bound input buffer is initialized or its capacity changes. Otherwise the next save does it, dropping all saved frames.
+*/
+class INPUTBUFFER_API FInputBufferSnapshotRing
+{
+public:
+
+	FInputBufferSnapshotRing()
+		: SnapshotSize(0)
+	{}
+
+	/**
+	* Allocates storage for snapshots of a given input buffer.
+	*
+	* @param InputBuffer The input buffer whose layout the snapshots follow.
+	* @param NumSnapshots The number of frames that can be kept at the same time.
+	*/
+	void Init(const UInputBufferComponent* InputBuffer, int32 NumSnapshots);
+
+	/* Forgets all saved frames while keeping the storage. */
+	void Reset();
+
+	/**
+	* Saves the state of an input buffer for a given frame, replacing the frame that shares the same slot.
+	* If the snapshot size of the input buffer changed since the ring was initialized, the ring is initialized again first, which drops all saved frames.
+	*/
+	void Save(const UInputBufferComponent* InputBuffer, int32 Frame);
+
+	/**
+	* Restores the state of an input buffer saved for a given frame.
+	*
+	* @return False if the frame is not in the ring or the snapshot does not fit the input buffer.
+	*/
+	bool Restore(UInputBufferComponent* InputBuffer, int32 Frame) const;
+
+	/* Returns whether a snapshot for a given frame is in the ring. */
+	bool Contains(int32 Frame) const
+	{
+		return SlotFrames.Num() > 0 && SlotFrames[GetSlot(Frame)] == Frame;
+	}
+
+	/* Returns the number of frames that can be kept at the same time. */
+	int32 Num() const
+	{
+		return SlotFrames.Num();
+	}
+
+protected:
+
+	FORCEINLINE int32 GetSlot(int32 Frame) const
+	{
+		const int32 Slot = Frame % SlotFrames.Num();
+		return Slot < 0 ? Slot + SlotFrames.Num() : Slot;
+	}
+
+	/* Size of each snapshot in bytes. */
+	int32 SnapshotSize;
+
+	/* Frame saved in each slot, or INDEX_NONE for empty slots. */
+	TArray<int32> SlotFrames;
+
+	/* Contiguous storage of all snapshots. */
+	TArray<uint8> Storage;
+};
@@ -0,0 +1,134 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+#include "InputBufferRecord.h"
+#include "InputBufferReplay.h"
+
+struct FEventBitPermutation;
+
+/**
+* Cold tier of input history: records evicted from the hot input history, kept compressed for replays, analytics and input display.
+* Records are encoded like replays, with times delta-encoded against the previous record and event flags as variable-length integers,
+* in blocks that are decodable independently. Each block remembers its time span, so seeking to a time decodes a single block at most.
+* Command recognition never reads the archive, so matchers keep scanning a small hot history however long the archive grows.
+*/
+class INPUTBUFFER_API FInputHistoryArchive
+{
+public:
+
+	/* The number of records encoded in a block. */
+	static const int32 RECORDS_PER_BLOCK = 64;
+
+	FInputHistoryArchive()
+		: MaxRecords(0)
+		, NumRecords(0)
+		, NumAdded(0)
+	{}
+
+	/**
+	* Sets how many records to keep. Whole blocks of the oldest records are dropped as long as the rest still hold that many,
+	* so the archive holds up to RECORDS_PER_BLOCK - 1 records more.
+	*
+	* @param InMaxRecords The number of records to keep, or zero to keep all of them.
+	*/
+	void SetMaxRecords(int32 InMaxRecords);
+
+	/* Appends a record, which must not end earlier than the last appended one for seeking to work. */
+	void Add(const FInputBufferRecord& Record);
+
+	/* Removes all records. Allocations are kept. */
+	void Reset();
+
+	/**
+	* Removes the records added since the archive had a given number of records added, e.g. when input history is rolled back to a snapshot,
+	* so that records evicted again after the rollback are not archived twice. Only the last block kept is encoded again.
+	*
+	* @param InNumAdded The number of records added at the point to roll back to, as returned by GetNumAdded().
+	*/
+	void RollBack(uint32 InNumAdded);
+
+	/* Moves event bits of all records to new positions, e.g. after input events are registered again. Decodes and encodes the whole archive. */
+	void RemapEvents(const FEventBitPermutation& Permutation);
+
+	int32 Num() const
+	{
+		return NumRecords;
+	}
+
+	/* Returns the number of records added since the archive was reset, including those dropped since. */
+	uint32 GetNumAdded() const
+	{
+		return NumAdded;
+	}
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Data.GetAllocatedSize() + Blocks.GetAllocatedSize();
+	}
+
+	/* Decodes archived records in chronological order. Becomes invalid when records are added to or removed from the archive. */
+	class INPUTBUFFER_API FReader
+	{
+	public:
+
+		/* Starts reading from the oldest record. */
+		explicit FReader(const FInputHistoryArchive& InArchive);
+
+		/* Moves to the oldest record that ends at or after a given time. Returns false if there is none. */
+		bool Seek(float Time);
+
+		/* Reads the next record. Returns false if there are no more records. */
+		bool Next(FInputBufferRecord& OutRecord);
+
+	private:
+
+		/* Moves to the beginning of a block. */
+		void StartBlock(int32 BlockIdx);
+
+		const FInputHistoryArchive& Archive;
+
+		FInputBufferRecordCodec Codec;
+
+		int32 BlockIdx;
+
+		/* The number of records left in the current block. */
+		int32 NumLeft;
+
+		const uint8* Cursor;
+
+		/* A record read ahead by Seek, returned by the next call to Next. */
+		FInputBufferRecord PendingRecord;
+
+		bool bPending;
+	};
+
+private:
+
+	/* Drops whole blocks of the oldest records while the archive holds more records than allowed. */
+	void Trim();
+
+	struct FBlock
+	{
+		/* Offset of the first encoded record in the data. */
+		int32 Offset;
+
+		int32 NumRecords;
+
+		/* The end time of the last record of the block. */
+		float EndTime;
+	};
+
+	TArray<uint8> Data;
+
+	TArray<FBlock> Blocks;
+
+	/* Delta encoding state of the last block. */
+	FInputBufferRecordCodec Codec;
+
+	int32 MaxRecords;
+
+	int32 NumRecords;
+
+	uint32 NumAdded;
+};
@@ -0,0 +1,53 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+#include "InputBufferRecord.h"
+
+/**
+* Storage of input history shared by all input buffers, so that histories growing during bursts of input and shrinking back when idle
+* reuse each other's allocations instead of reallocating. Pooled storage is bounded, and storage beyond the bound is freed.
+* Used on the game thread only.
+*/
+class INPUTBUFFER_API FInputHistoryPool
+{
+public:
+
+	/* The most records kept in pooled storage in total. */
+	static const int32 MAX_POOLED_RECORDS = 4096;
+
+	static FInputHistoryPool& Get();
+
+	/**
+	* Takes storage from the pool, or allocates it if none fits.
+	*
+	* @param Capacity The minimal capacity of the storage.
+	* @param OutStorage Receives empty storage whose capacity is at least the given one. Its previous allocation is freed.
+	*/
+	void Acquire(int32 Capacity, TArray<FInputBufferRecord>& OutStorage);
+
+	/* Returns storage to the pool, or frees it if the pool is full. The storage is left empty without allocation. */
+	void Release(TArray<FInputBufferRecord>& Storage);
+
+	/* Frees all pooled storage. */
+	void Empty();
+
+	/* Returns the number of records that pooled storage can hold. */
+	int32 GetNumPooledRecords() const
+	{
+		return NumPooledRecords;
+	}
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Storages.GetAllocatedSize() + NumPooledRecords * sizeof(FInputBufferRecord);
+	}
+
+private:
+
+	FInputHistoryPool() : NumPooledRecords(0) {}
+
+	TArray<TArray<FInputBufferRecord>> Storages;
+
+	int32 NumPooledRecords;
+};
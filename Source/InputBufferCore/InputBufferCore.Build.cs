@@ -0,0 +1,26 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+using UnrealBuildTool;
+
+public class InputBufferCore : ModuleRules
+{
+	public InputBufferCore(TargetInfo Target)
+	{
+
+        // ... add public include paths required here ...
+        PublicIncludePaths.AddRange(new string[] {
+            "InputBufferCore/Public",
+        });
+
+        // ... add other private include paths required here ...
+        PrivateIncludePaths.AddRange(new string[] {
+            "InputBufferCore/Private",
+        });
+
+        // Only Core is allowed here, so that input buffering and command matching never depend on UObjects, a world or player input.
+        // Core itself is still required: the module uses its containers, memory and assertions, and its tests run in the automation framework.
+        PublicDependencyModuleNames.AddRange(new string[] {
+			"Core",
+		});
+	}
+}
@@ -0,0 +1,270 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferCorePrivatePCH.h"
+#include "CompiledInputCommand.h"
+
+namespace
+{
+	/* Combines bit flags of a range of names. Returns false if any of them is unknown. */
+	FORCEINLINE bool ResolveNames(const int32* NameRefs, int32 Num, const uint64* NameFlags, uint64& OutFlags)
+	{
+		bool bResolved = true;
+		for (int32 Idx = 0; Idx < Num; Idx++)
+		{
+			const uint64 Flag = NameFlags[NameRefs[Idx]];
+			OutFlags |= Flag;
+			bResolved = bResolved && Flag != 0;
+		}
+
+		return bResolved;
+	}
+
+	/**
+	* Returns the most records an entry can be matched over, or INDEX_NONE if there is no bound.
+	*
+	* @param bTolerant Whether records matching the entry can differ, i.e. the entry tolerates other input events or records can differ in translated events.
+	* @param bFirst Whether the entry is the first of its sequence, which the matcher walks back over past the time limit of the command.
+	*/
+	int32 GetMaxEntryRecords(const FCompiledInputCommandEntry& Entry, bool bTolerant, bool bFirst, float FrameRate)
+	{
+		// Records matching an entry that tolerates nothing have the same events, so they are merged into one unless their translated events differ.
+		if (!bTolerant)
+		{
+			return 1;
+		}
+
+		// Records can be arbitrarily short if they are measured in seconds.
+		if (FrameRate == 0.f)
+		{
+			return INDEX_NONE;
+		}
+
+		// Otherwise N records last at least N - 1 frames. The duration of the first entry is checked after walking past it, so one more record shows whether it is too long.
+		if (Entry.MaxDuration > 0.f)
+		{
+			return (int32)FBufferedInputEventKit::ScaleTimeLimit(Entry.MaxDuration, FrameRate) + (bFirst ? 2 : 1);
+		}
+
+		// The first entry matches once its records last long enough, whatever records precede them.
+		if (bFirst)
+		{
+			return (int32)FBufferedInputEventKit::ScaleTimeLimit(Entry.MinDuration, FrameRate) + 1;
+		}
+
+		return INDEX_NONE;
+	}
+}
+
+void FCompiledInputCommand::Reset()
+{
+	TimeLimit = 0.f;
+	FirstIgnoreName = 0;
+	NumIgnoreNames = 0;
+	Names.Reset();
+	NameRefs.Reset();
+	Sequences.Reset();
+	Entries.Reset();
+}
+
+void FCompiledInputCommand::Bind(const uint64* NameFlags, FInputCommandProgram& OutProgram) const
+{
+	OutProgram.Reset();
+	OutProgram.TimeLimit = TimeLimit;
+
+	const int32* Refs = NameRefs.GetData();
+
+	// For events to ignore, unknown events are omitted.
+	uint64 OuterIgnoreFlags = 0;
+	ResolveNames(Refs + FirstIgnoreName, NumIgnoreNames, NameFlags, OuterIgnoreFlags);
+
+	OutProgram.Sequences.AddUninitialized(Sequences.Num());
+	OutProgram.Entries.AddUninitialized(Entries.Num());
+
+	for (int32 SequenceIdx = 0; SequenceIdx < Sequences.Num(); SequenceIdx++)
+	{
+		const FCompiledInputCommandSequence& Sequence = Sequences[SequenceIdx];
+		FInputCommandProgramSequence& ProgramSequence = OutProgram.Sequences[SequenceIdx];
+		ProgramSequence.FirstEntry = Sequence.FirstEntry;
+		ProgramSequence.NumEntries = Sequence.NumEntries;
+		ProgramSequence.bResolved = true;
+
+		for (int32 EntryIdx = Sequence.FirstEntry; EntryIdx < Sequence.FirstEntry + Sequence.NumEntries; EntryIdx++)
+		{
+			const FCompiledInputCommandEntry& Entry = Entries[EntryIdx];
+			FInputCommandProgramEntry& ProgramEntry = OutProgram.Entries[EntryIdx];
+
+			// For events to match, an unknown event means the sequence can never match.
+			ProgramEntry.MatchFlags = 0;
+			if (!ResolveNames(Refs + Entry.FirstMatchName, Entry.NumMatchNames, NameFlags, ProgramEntry.MatchFlags))
+			{
+				ProgramSequence.bResolved = false;
+			}
+
+			ProgramEntry.IgnoreFlags = OuterIgnoreFlags;
+			ResolveNames(Refs + Entry.FirstIgnoreName, Entry.NumIgnoreNames, NameFlags, ProgramEntry.IgnoreFlags);
+
+			ProgramEntry.MinDuration = Entry.MinDuration;
+			ProgramEntry.MaxDuration = Entry.MaxDuration;
+			ProgramEntry.MinInterval = Entry.MinInterval;
+			ProgramEntry.MaxInterval = Entry.MaxInterval;
+			ProgramEntry.bIgnoreOthers = Entry.bIgnoreOthers;
+		}
+
+		ProgramSequence.TriggerFlags = Sequence.NumEntries > 0 ? OutProgram.Entries[Sequence.FirstEntry + Sequence.NumEntries - 1].MatchFlags : 0;
+	}
+}
+
+int32 FCompiledInputCommand::GetMinHistoryRecords(float FrameRate, bool bTranslatedEvents) const
+{
+	int32 MaxRecords = 0;
+	for (const FCompiledInputCommandSequence& Sequence : Sequences)
+	{
+		if (Sequence.NumEntries == 0)
+		{
+			continue;
+		}
+
+		// Each entry is followed by at most one empty record, before the next entry or after the last one when buttons are released.
+		// Intervals add no records, since consecutive empty records are merged unless their translated events differ, and any other record must match an entry.
+		int32 NumFirstRecords = INDEX_NONE;
+		int32 NumLaterRecords = 0;
+		for (int32 EntryIdx = Sequence.FirstEntry; EntryIdx < Sequence.FirstEntry + Sequence.NumEntries; EntryIdx++)
+		{
+			const FCompiledInputCommandEntry& Entry = Entries[EntryIdx];
+			const bool bTolerant = Entry.bIgnoreOthers || Entry.NumIgnoreNames > 0 || NumIgnoreNames > 0 || bTranslatedEvents;
+			const bool bFirst = EntryIdx == Sequence.FirstEntry;
+
+			const int32 NumEntryRecords = GetMaxEntryRecords(Entry, bTolerant, bFirst, FrameRate);
+			if (bFirst)
+			{
+				NumFirstRecords = NumEntryRecords;
+			}
+			else if (NumEntryRecords == INDEX_NONE || NumLaterRecords == INDEX_NONE)
+			{
+				NumLaterRecords = INDEX_NONE;
+			}
+			else
+			{
+				NumLaterRecords += NumEntryRecords + 1;
+			}
+		}
+
+		if (NumFirstRecords == INDEX_NONE)
+		{
+			return INDEX_NONE;
+		}
+
+		// Records of later entries, the latest record of the first entry and the empty record after it must end within the time limit.
+		// Each record lasts at least a frame, so they are at most as many as the frames in the limit, though each entry needs a record of its own anyway.
+		// Empty records that differ in translated events are not merged either, and the matcher skips any number of them.
+		int32 NumLimitedRecords = NumLaterRecords == INDEX_NONE || bTranslatedEvents ? INDEX_NONE : NumLaterRecords + 2;
+		if (FrameRate > 0.f && TimeLimit > 0.f)
+		{
+			const int32 NumRecordsInLimit = FMath::Max((int32)FBufferedInputEventKit::ScaleTimeLimit(TimeLimit, FrameRate) + 1, Sequence.NumEntries);
+			NumLimitedRecords = NumLimitedRecords == INDEX_NONE ? NumRecordsInLimit : FMath::Min(NumLimitedRecords, NumRecordsInLimit);
+		}
+
+		if (NumLimitedRecords == INDEX_NONE)
+		{
+			return INDEX_NONE;
+		}
+
+		// Older records of the first entry are walked past the time limit.
+		MaxRecords = FMath::Max(MaxRecords, NumLimitedRecords + NumFirstRecords - 1);
+	}
+
+	return MaxRecords;
+}
+
+FArchive& operator<<(FArchive& Ar, FCompiledInputCommand& Command)
+{
+	Ar << Command.TimeLimit;
+	Ar << Command.FirstIgnoreName << Command.NumIgnoreNames;
+	Ar << Command.Names;
+	Ar << Command.NameRefs;
+	Ar << Command.Sequences;
+	Ar << Command.Entries;
+	return Ar;
+}
+
+void FCompiledInputCommandSet::Reset()
+{
+	Names.Reset();
+	Commands.Reset();
+}
+
+void FCompiledInputCommandSet::Add(const FCompiledInputCommand& Command)
+{
+	FCompiledInputCommand& Added = Commands[Commands.Add(Command)];
+
+	TArray<int32, TInlineAllocator<32>> NameIndices;
+	NameIndices.AddUninitialized(Command.Names.Num());
+	for (int32 Idx = 0; Idx < Command.Names.Num(); Idx++)
+	{
+		NameIndices[Idx] = Names.AddUnique(Command.Names[Idx]);
+	}
+
+	for (int32& NameRef : Added.NameRefs)
+	{
+		NameRef = NameIndices[NameRef];
+	}
+	Added.Names.Empty();
+}
+
+void FCompiledInputCommandSet::Bind(const uint64* NameFlags, FInputCommandSetProgram& OutProgram) const
+{
+	OutProgram.Commands.SetNum(Commands.Num());
+	for (int32 Idx = 0; Idx < Commands.Num(); Idx++)
+	{
+		Commands[Idx].Bind(NameFlags, OutProgram.Commands[Idx]);
+	}
+
+	OutProgram.BuildTriggerIndex();
+}
+
+int32 FCompiledInputCommandSet::GetMinHistoryRecords(float FrameRate, int32* OutCommandIdx, bool bTranslatedEvents) const
+{
+	int32 MaxRecords = 0;
+	int32 MaxCommandIdx = INDEX_NONE;
+	for (int32 Idx = 0; Idx < Commands.Num(); Idx++)
+	{
+		const int32 NumRecords = Commands[Idx].GetMinHistoryRecords(FrameRate, bTranslatedEvents);
+		if (NumRecords == INDEX_NONE)
+		{
+			MaxRecords = INDEX_NONE;
+			MaxCommandIdx = Idx;
+			break; // since no capacity is enough
+		}
+
+		if (MaxCommandIdx == INDEX_NONE || NumRecords > MaxRecords)
+		{
+			MaxRecords = NumRecords;
+			MaxCommandIdx = Idx;
+		}
+	}
+
+	if (OutCommandIdx)
+	{
+		*OutCommandIdx = MaxCommandIdx;
+	}
+
+	return MaxRecords;
+}
+
+SIZE_T FCompiledInputCommandSet::GetAllocatedSize() const
+{
+	SIZE_T Size = Names.GetAllocatedSize() + Commands.GetAllocatedSize();
+	for (const FCompiledInputCommand& Command : Commands)
+	{
+		Size += Command.GetAllocatedSize();
+	}
+
+	return Size;
+}
+
+FArchive& operator<<(FArchive& Ar, FCompiledInputCommandSet& CommandSet)
+{
+	Ar << CommandSet.Names;
+	Ar << CommandSet.Commands;
+	return Ar;
+}
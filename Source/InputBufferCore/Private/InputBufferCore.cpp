@@ -0,0 +1,5 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferCorePrivatePCH.h"
+
+IMPLEMENT_MODULE(FInputBufferCoreModule, InputBufferCore)
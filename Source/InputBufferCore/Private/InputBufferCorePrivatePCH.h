@@ -0,0 +1,4 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "Core.h"
+#include "InputBufferCore.h"
@@ -0,0 +1,200 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferCorePrivatePCH.h"
+#include "InputCommandProgram.h"
+
+void FInputCommandSetProgram::BuildTriggerIndex()
+{
+	TriggeredCommands.Reset();
+	UntriggeredCommands.Reset();
+
+	// Lowest trigger bits of each command, deduplicated.
+	TArray<uint64> CommandBits;
+	CommandBits.AddZeroed(Commands.Num());
+
+	for (int32 CommandIdx = 0; CommandIdx < Commands.Num(); CommandIdx++)
+	{
+		bool bUntriggered = false;
+		for (const FInputCommandProgramSequence& Sequence : Commands[CommandIdx].Sequences)
+		{
+			if (!Sequence.bResolved)
+			{
+				continue; // since it never matches
+			}
+
+			if (Sequence.TriggerFlags == 0)
+			{
+				bUntriggered = true;
+			}
+			else
+			{
+				CommandBits[CommandIdx] |= 1ULL << FBufferedInputEventKit::GetLowestEventIndex(Sequence.TriggerFlags);
+			}
+		}
+
+		if (bUntriggered)
+		{
+			UntriggeredCommands.Add(CommandIdx);
+			CommandBits[CommandIdx] = 0;
+		}
+	}
+
+	// Group commands by bit, keeping them in order of priority within each group.
+	for (int32 Bit = 0; Bit < FInputBufferRecord::MAX_EVENTS; Bit++)
+	{
+		TriggerStarts[Bit] = TriggeredCommands.Num();
+		for (int32 CommandIdx = 0; CommandIdx < Commands.Num(); CommandIdx++)
+		{
+			if (CommandBits[CommandIdx] & (1ULL << Bit))
+			{
+				TriggeredCommands.Add(CommandIdx);
+			}
+		}
+	}
+	TriggerStarts[FInputBufferRecord::MAX_EVENTS] = TriggeredCommands.Num();
+}
+
+void FInputCommandSetProgram::GetCandidates(uint64 TriggerEvents, TBitArray<>& OutCandidates) const
+{
+	OutCandidates.Init(false, Commands.Num());
+
+	for (int32 CommandIdx : UntriggeredCommands)
+	{
+		OutCandidates[CommandIdx] = true;
+	}
+
+	// Only visit bits that are set.
+	for (uint64 Events = TriggerEvents; Events != 0; Events &= Events - 1)
+	{
+		const int32 Bit = FBufferedInputEventKit::GetLowestEventIndex(Events);
+		for (int32 Idx = TriggerStarts[Bit]; Idx < TriggerStarts[Bit + 1]; Idx++)
+		{
+			OutCandidates[TriggeredCommands[Idx]] = true;
+		}
+	}
+}
+
+SIZE_T FInputCommandSetProgram::GetAllocatedSize() const
+{
+	SIZE_T Size = Commands.GetAllocatedSize() + TriggeredCommands.GetAllocatedSize() + UntriggeredCommands.GetAllocatedSize();
+	for (const FInputCommandProgram& Program : Commands)
+	{
+		Size += Program.Sequences.GetAllocatedSize() + Program.Entries.GetAllocatedSize();
+	}
+
+	return Size;
+}
+
+uint64 FInputCommandMatcher::GetTriggerEvents(const FInputBufferHistory& History)
+{
+	for (auto It = History.CreateConstReverseIterator(); It; ++It)
+	{
+		if (It->Events != 0)
+		{
+			return It->Events;
+		}
+	}
+
+	return 0;
+}
+
+bool FInputCommandMatcher::Match(const FInputCommandProgram& Program, const FInputBufferHistory& History, float CurrTime, float FrameRate, uint32* OutNumVisited, FInputCommandMatchResult* OutResult, uint32* OutNumEvaluated)
+{
+	if (History.Num() == 0)
+	{
+		if (OutResult)
+		{
+			OutResult->Reset();
+		}
+		return false; // because of nothing to match
+	}
+
+	uint32 NumVisited = 0;
+	bool bEvaluated = false;
+	bool bMatched = false;
+
+	const uint64 TriggerEvents = GetTriggerEvents(History);
+
+	for (const FInputCommandProgramSequence& Sequence : Program.Sequences)
+	{
+		// A sequence with unknown input events to match can never match, and neither can one whose last entry misses the latest input.
+		if (!Sequence.bResolved || !FBufferedInputEventKit::HasEventFlags(TriggerEvents, Sequence.TriggerFlags))
+		{
+			continue;
+		}
+
+		bEvaluated = true;
+		if (MatchSequence(Program, Sequence, History, CurrTime, FrameRate, NumVisited, OutResult))
+		{
+			bMatched = true;
+			break;
+		}
+	}
+
+	if (!bMatched && OutResult)
+	{
+		OutResult->Reset();
+	}
+
+	if (OutNumVisited)
+	{
+		*OutNumVisited += NumVisited;
+	}
+
+	if (OutNumEvaluated && bEvaluated)
+	{
+		(*OutNumEvaluated)++;
+	}
+
+	return bMatched;
+}
+
+int32 FInputCommandMatcher::MatchSet(const FInputCommandSetProgram& Program, const FInputBufferHistory& History, float CurrTime, float FrameRate, TBitArray<>* OutMatches, uint32* OutNumVisited, FInputCommandMatchResult* OutResult, uint32* OutNumEvaluated)
+{
+	if (OutMatches)
+	{
+		OutMatches->Init(false, Program.Commands.Num());
+	}
+
+	if (OutResult)
+	{
+		OutResult->Reset();
+	}
+
+	if (History.Num() == 0)
+	{
+		return INDEX_NONE; // because of nothing to match
+	}
+
+	TBitArray<> Candidates;
+	Program.GetCandidates(GetTriggerEvents(History), Candidates);
+
+	int32 FirstMatch = INDEX_NONE;
+	for (TConstSetBitIterator<> It(Candidates); It; ++It)
+	{
+		const int32 Idx = It.GetIndex();
+
+		// Only the first match fills in the result, so later commands neither overwrite nor reset it.
+		if (Match(Program.Commands[Idx], History, CurrTime, FrameRate, OutNumVisited, FirstMatch == INDEX_NONE ? OutResult : nullptr, OutNumEvaluated))
+		{
+			if (FirstMatch == INDEX_NONE)
+			{
+				FirstMatch = Idx;
+			}
+
+			if (OutMatches == nullptr)
+			{
+				break;
+			}
+
+			(*OutMatches)[Idx] = true;
+		}
+	}
+
+	return FirstMatch;
+}
+
+bool FInputCommandMatcher::MatchSequence(const FInputCommandProgram& Program, const FInputCommandProgramSequence& Sequence, const FInputBufferHistory& History, float CurrTime, float FrameRate, uint32& NumVisited, FInputCommandMatchResult* OutResult)
+{
+	return MatchEntries(Program.Entries.GetData() + Sequence.FirstEntry, Sequence.NumEntries, Program.TimeLimit, History, CurrTime, FrameRate, NumVisited, OutResult);
+}
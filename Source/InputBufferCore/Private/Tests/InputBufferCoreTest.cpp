@@ -0,0 +1,289 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferCorePrivatePCH.h"
+#include "AutomationTest.h"
+#include "InputCommandProgram.h"
+#include "EventMaskCache.h"
+#include "EventBitPermutation.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	const uint64 DOWN = 1 << 0;
+	const uint64 RIGHT = 1 << 1;
+	const uint64 PUNCH = 1 << 2;
+	const uint64 KICK = 1 << 3;
+
+	/* Adds a record for each frame like an input buffer in frame-indexed simulation, prolonging the last record if its events are the same. */
+	void SimulateFrame(FInputBufferHistory& History, int32 Frame, uint64 Events)
+	{
+		FInputBufferRecord* LastRecord = History.LastOrNull();
+		if (LastRecord && LastRecord->bValid && LastRecord->Events == Events)
+		{
+			LastRecord->EndTime = (float)Frame;
+		}
+		else
+		{
+			History.Add(FInputBufferRecord((float)Frame, (float)Frame, Events, 0));
+		}
+	}
+
+	FInputCommandProgramEntry& AddEntry(FInputCommandProgram& Program, uint64 MatchFlags)
+	{
+		if (Program.Sequences.Num() == 0)
+		{
+			Program.Sequences.AddDefaulted();
+		}
+
+		Program.Sequences.Last().NumEntries++;
+
+		auto& Entry = Program.Entries[Program.Entries.AddDefaulted()];
+		Entry.MatchFlags = MatchFlags;
+		return Entry;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInputBufferCoreTest, "Plugins.InputBuffer.Core", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::SmokeFilter)
+
+bool FInputBufferCoreTest::RunTest(const FString& Parameters)
+{
+	// Cyclic buffer
+	{
+		TCyclicBuffer<int32> Buffer;
+		TestEqual(TEXT("Adding to a buffer without capacity should fail."), Buffer.Add(1), (int32)INDEX_NONE);
+
+		Buffer.Reset(3);
+		const int32 Capacity = Buffer.Max();
+		TestEqual(TEXT("The capacity must be the requested one, whatever the allocator rounds up to."), Capacity, 3);
+		const int32 NumAdded = Capacity + 2;
+		for (int32 Value = 1; Value <= NumAdded; Value++)
+		{
+			Buffer.Add(Value);
+		}
+
+		TestEqual(TEXT("A full buffer must keep its capacity."), Buffer.Num(), Capacity);
+		TestEqual(TEXT("The last element must be the latest added one."), *Buffer.LastOrNull(), NumAdded);
+		TestEqual(TEXT("The n-th last element must be counted from the latest one."), *Buffer.LastOrNull(2), NumAdded - 2);
+		TestNull(TEXT("Elements beyond the capacity must not be accessible."), Buffer.LastOrNull(Capacity));
+
+		TArray<int32> Forward;
+		for (auto It = Buffer.CreateConstIterator(); It; ++It)
+		{
+			Forward.Add(*It);
+		}
+		TestTrue(TEXT("Iteration must go from the oldest element to the latest one."), Forward.Num() == Capacity && Forward[0] == 3 && Forward.Last() == NumAdded);
+
+		TArray<int32> Backward;
+		for (auto It = Buffer.CreateConstReverseIterator(); It; ++It)
+		{
+			Backward.Add(*It);
+		}
+		TestTrue(TEXT("Reverse iteration must go from the latest element to the oldest one."), Backward.Num() == Capacity && Backward[0] == NumAdded && Backward.Last() == 3);
+
+		// Growing keeps all the elements in order.
+		Buffer.SetMax(Capacity * 4);
+		TestEqual(TEXT("Growing must keep all the elements."), Buffer.Num(), Capacity);
+		TestEqual(TEXT("Growing must keep the latest element last."), *Buffer.LastOrNull(), NumAdded);
+		Buffer.Add(NumAdded + 1);
+		TestEqual(TEXT("A grown buffer should not replace elements until it is full."), Buffer.Num(), Capacity + 1);
+
+		// Shrinking keeps the newest elements.
+		Buffer.SetMax(2);
+		TestTrue(TEXT("Shrinking must keep the newest elements."), Buffer.Num() <= Buffer.Max() && *Buffer.LastOrNull() == NumAdded + 1 && *Buffer.LastOrNull(1) == NumAdded);
+
+		// Exchanging storage keeps the newest elements and hands the previous allocation back.
+		TArray<int32> Storage;
+		Storage.Reserve(Capacity * 2);
+		const int32 NumBefore = Buffer.Num();
+		Buffer.ExchangeStorage(Storage, Capacity);
+		TestTrue(TEXT("Exchanging storage must take the requested capacity and keep the elements."), Buffer.Max() == Capacity && Buffer.Num() == NumBefore && *Buffer.LastOrNull() == NumAdded + 1);
+		TestTrue(TEXT("The previous storage must be handed back empty with its allocation."), Storage.Num() == 0 && Storage.Max() > 0);
+
+		// Storage larger than the capacity must not hold more elements than the capacity.
+		for (int32 Value = 1; Value <= Capacity * 2; Value++)
+		{
+			Buffer.Add(Value);
+		}
+		TestEqual(TEXT("A buffer in larger storage must replace elements at its capacity."), Buffer.Num(), Capacity);
+	}
+
+	// Event flags and time limits
+	{
+		TestTrue(TEXT("Events including all events to match should match."), FBufferedInputEventKit::HasEventFlags(DOWN | PUNCH, PUNCH));
+		TestTrue(TEXT("Ignored events should not affect comparison."), FBufferedInputEventKit::CompareEventFlags(DOWN | PUNCH, PUNCH, DOWN));
+		TestFalse(TEXT("Events that are neither matched nor ignored should fail comparison."), FBufferedInputEventKit::CompareEventFlags(DOWN | PUNCH, PUNCH, 0));
+
+		TestEqual(TEXT("Time limits should be rounded to whole frames."), FBufferedInputEventKit::ScaleTimeLimit(0.1f, 60.f), 6.f);
+		TestEqual(TEXT("Non-zero time limits should never become zero frames."), FBufferedInputEventKit::ScaleTimeLimit(0.001f, 60.f), 1.f);
+		TestTrue(TEXT("Zero limits should be unused."), FBufferedInputEventKit::CheckTimeLimits(100.f, 0.f, 0.f, 0.f));
+		TestFalse(TEXT("Times beyond the maximal limit should fail."), FBufferedInputEventKit::CheckTimeLimits(7.f, 0.f, 0.1f, 60.f));
+	}
+
+	// Command matching on a quarter-circle-forward punch
+	{
+		FInputCommandProgram Program;
+		AddEntry(Program, DOWN);
+		AddEntry(Program, DOWN | RIGHT).MaxInterval = 0.1f; // 6 frames
+		AddEntry(Program, RIGHT | PUNCH);
+
+		FInputBufferHistory History;
+		History.Reset(16);
+		TestFalse(TEXT("Command recognition should fail if input history is empty."), FInputCommandMatcher::Match(Program, History, 0.f, 60.f));
+
+		SimulateFrame(History, 1, DOWN);
+		SimulateFrame(History, 2, DOWN);
+		SimulateFrame(History, 3, DOWN | RIGHT);
+		SimulateFrame(History, 4, RIGHT | PUNCH);
+
+		uint32 NumVisited = 0;
+		TestTrue(TEXT("Command recognition should succeed if all entries match in order."), FInputCommandMatcher::Match(Program, History, 4.f, 60.f, &NumVisited));
+		TestTrue(TEXT("Visited records should be counted."), NumVisited > 0);
+
+		FInputCommandMatchResult Result;
+		FInputCommandMatcher::Match(Program, History, 4.f, 60.f, nullptr, &Result);
+		TestEqual(TEXT("The match should start at the oldest record of the first entry."), Result.StartRecord, 2);
+		TestEqual(TEXT("The match should end at the latest record."), Result.EndRecord, 0);
+		TestEqual(TEXT("The match should start when the first entry starts."), Result.StartTime, 1.f);
+		TestEqual(TEXT("The match should end when the last entry ends."), Result.EndTime, 4.f);
+		TestTrue(TEXT("Each entry should map to its records."), Result.Entries.Num() == 3
+			&& Result.Entries[0].StartRecord == 2 && Result.Entries[0].EndRecord == 2
+			&& Result.Entries[1].StartRecord == 1 && Result.Entries[1].EndRecord == 1
+			&& Result.Entries[2].StartRecord == 0 && Result.Entries[2].EndRecord == 0);
+
+		SimulateFrame(History, 5, 0);
+		FInputCommandMatcher::Match(Program, History, 5.f, 60.f, nullptr, &Result);
+		TestTrue(TEXT("Trailing empty records should not be part of the match."), Result.StartRecord == 3 && Result.EndRecord == 1 && Result.EndTime == 4.f);
+
+		SimulateFrame(History, 6, KICK);
+		TestFalse(TEXT("Command recognition should fail if the latest record does not match."), FInputCommandMatcher::Match(Program, History, 6.f, 60.f, nullptr, &Result));
+		TestFalse(TEXT("The result should be reset if the command does not match."), Result.HasRecords());
+
+		History.Reset(16);
+		SimulateFrame(History, 1, DOWN);
+		SimulateFrame(History, 2, DOWN | RIGHT);
+		for (int32 Frame = 3; Frame < 12; Frame++)
+		{
+			SimulateFrame(History, Frame, 0);
+		}
+		SimulateFrame(History, 12, RIGHT | PUNCH);
+		TestFalse(TEXT("Command recognition should fail if the interval exceeds the limit."), FInputCommandMatcher::Match(Program, History, 12.f, 60.f));
+
+		Program.TimeLimit = 0.05f; // 3 frames
+		History.Reset(16);
+		SimulateFrame(History, 1, DOWN);
+		SimulateFrame(History, 2, DOWN | RIGHT);
+		SimulateFrame(History, 3, RIGHT | PUNCH);
+		SimulateFrame(History, 4, 0);
+		TestTrue(TEXT("Command recognition should succeed within the time limit."), FInputCommandMatcher::Match(Program, History, 4.f, 60.f));
+		TestFalse(TEXT("Command recognition should fail if input is older than the time limit."), FInputCommandMatcher::Match(Program, History, 10.f, 60.f));
+
+		Program.Sequences[0].bResolved = false;
+		TestFalse(TEXT("A sequence with unknown events to match should never match."), FInputCommandMatcher::Match(Program, History, 4.f, 60.f));
+	}
+
+	// Invalidation watermark
+	{
+		FInputBufferHistory History;
+		History.Reset(4);
+		SimulateFrame(History, 1, DOWN);
+		SimulateFrame(History, 2, PUNCH);
+		SimulateFrame(History, 3, KICK);
+		TestEqual(TEXT("All records should be valid before invalidation."), History.GetNumValid(), 3);
+
+		History.InvalidateFrom(1);
+		TestTrue(TEXT("Records from the given index on should be invalid."), History.IsValidRecord(0) && !History.IsValidRecord(1) && !History.IsValidRecord(2));
+
+		History.InvalidateFrom(2);
+		TestEqual(TEXT("The watermark should never move back."), History.GetNumValid(), 1);
+
+		SimulateFrame(History, 4, DOWN);
+		SimulateFrame(History, 5, PUNCH);
+		TestEqual(TEXT("Records added after the watermark should be valid."), History.GetNumValid(), 3);
+
+		History.Invalidate();
+		TestEqual(TEXT("No record should be valid after invalidation."), History.GetNumValid(), 0);
+
+		SimulateFrame(History, 6, KICK);
+		TestTrue(TEXT("A record added after invalidation should be valid."), History.GetNumValid() == 1 && History.IsValidRecord(0));
+	}
+
+	// Prefiltering on the latest non-empty record
+	{
+		FInputCommandProgram Punch;
+		AddEntry(Punch, DOWN);
+		AddEntry(Punch, PUNCH);
+		Punch.Sequences[0].TriggerFlags = PUNCH;
+
+		FInputCommandProgram Kick;
+		AddEntry(Kick, DOWN);
+		AddEntry(Kick, KICK);
+		Kick.Sequences[0].TriggerFlags = KICK;
+
+		FInputBufferHistory History;
+		History.Reset(16);
+		SimulateFrame(History, 1, DOWN);
+		SimulateFrame(History, 2, PUNCH);
+		SimulateFrame(History, 3, 0);
+
+		TestTrue(TEXT("Trigger events must be those of the latest non-empty record."), FInputCommandMatcher::GetTriggerEvents(History) == PUNCH);
+		TestTrue(TEXT("A sequence whose trigger flags are present should be matched."), FInputCommandMatcher::Match(Punch, History, 3.f, 60.f));
+
+		uint32 NumPrefiltered = 0;
+		FInputCommandMatcher::Match(Kick, History, 3.f, 60.f, nullptr, nullptr, &NumPrefiltered);
+		TestTrue(TEXT("A command whose sequences all fail the trigger prefilter should not be counted as evaluated."), NumPrefiltered == 0);
+		FInputCommandMatcher::Match(Punch, History, 3.f, 60.f, nullptr, nullptr, &NumPrefiltered);
+		TestTrue(TEXT("A command with a sequence passing the trigger prefilter should be counted as evaluated."), NumPrefiltered == 1);
+
+		FInputCommandSetProgram Set;
+		Set.Commands.Add(Kick);
+		Set.Commands.Add(Punch);
+		Set.Commands.Add(FInputCommandProgram());
+		Set.Commands.Last().Sequences.AddDefaulted(); // An empty sequence always matches.
+		Set.BuildTriggerIndex();
+
+		TBitArray<> Candidates;
+		Set.GetCandidates(PUNCH, Candidates);
+		TestTrue(TEXT("Only commands triggered by the latest input and untriggered ones should be candidates."), !Candidates[0] && Candidates[1] && Candidates[2]);
+
+		TBitArray<> Matches;
+		uint32 NumEvaluated = 0;
+		TestEqual(TEXT("The first candidate that matches should have the highest priority."), FInputCommandMatcher::MatchSet(Set, History, 3.f, 60.f, &Matches, nullptr, nullptr, &NumEvaluated), 1);
+		TestTrue(TEXT("Commands that are not candidates should not match."), !Matches[0] && Matches[1] && Matches[2]);
+		TestTrue(TEXT("Only candidates should be counted as evaluated."), NumEvaluated == 2);
+	}
+
+	// Event mask cache
+	{
+		TEventMaskCache<int32, 2> Cache;
+		TestTrue(TEXT("An empty cache should find nothing."), Cache.Find(PUNCH) == nullptr);
+
+		Cache.Add(PUNCH) = 1;
+		Cache.Add(KICK) = 2;
+		TestTrue(TEXT("Cached values should be found."), Cache.Find(PUNCH) && *Cache.Find(PUNCH) == 1 && Cache.Find(KICK) && *Cache.Find(KICK) == 2);
+
+		Cache.Find(PUNCH);
+		TestEqual(TEXT("A full cache should reuse the slot of the least recently used value."), Cache.Add(DOWN), 2);
+		TestTrue(TEXT("The least recently used value should be evicted."), Cache.Find(KICK) == nullptr && Cache.Find(PUNCH) && Cache.Find(DOWN));
+
+		Cache.Reset();
+		TestTrue(TEXT("A reset cache should find nothing."), Cache.Num() == 0 && Cache.Find(PUNCH) == nullptr);
+	}
+
+	// Event bit permutation
+	{
+		// Drop the second bit, shift the next two down and swap the last two.
+		const int32 NewIndices[] = { 0, INDEX_NONE, 1, 2, 4, 3 };
+		FEventBitPermutation Permutation;
+		Permutation.Build(NewIndices, ARRAY_COUNT(NewIndices));
+
+		TestTrue(TEXT("Bits should move to their new indices."), Permutation.Apply(0x3D) == 0x1F);
+		TestTrue(TEXT("Dropped bits should be cleared."), Permutation.Apply(0x02) == 0);
+		TestTrue(TEXT("Swapped bits should trade places."), Permutation.Apply(0x10) == 0x10 && Permutation.Apply(0x20) == 0x08);
+		TestTrue(TEXT("Bits beyond the old ones should be cleared."), Permutation.Apply(1ULL << 63) == 0);
+	}
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
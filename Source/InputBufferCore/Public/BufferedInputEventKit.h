@@ -0,0 +1,61 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+/* Holds common static functions for input events. Data members are not allowed here. */
+struct FBufferedInputEventKit
+{
+	/* Returns whether LHS has every bits set as RHS. */
+	static bool HasEventFlags(uint64 Input, uint64 Match)
+	{
+		return (Input & Match) == Match;
+	}
+
+	/* Returns whether given bit flags has every bits set as matching one and has no bit set other than the matching and ignoring bits. */
+	static bool CompareEventFlags(uint64 Input, uint64 Match, uint64 Ignore)
+	{
+		uint64 Intersection = Input & Match;
+		if (Intersection == Match) // check if the input has every bit set as the matching bits
+		{
+			uint64 Union = Match | Ignore;
+			return (Input | Union) == Union; // return false if the input has any bit set which is not in the matching and ignoring bits
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	/* Returns the index of the lowest set bit of given bit flags, which must not be zero. */
+	static FORCEINLINE int32 GetLowestEventIndex(uint64 Events)
+	{
+		const uint32 Low = (uint32)Events;
+		return Low != 0 ? (int32)FMath::CountTrailingZeros(Low) : 32 + (int32)FMath::CountTrailingZeros((uint32)(Events >> 32));
+	}
+
+	/* Converts a time limit in seconds to the time unit of input records. With a non-zero frame rate, the limit is rounded to whole frames and a non-zero limit never becomes zero. */
+	static float ScaleTimeLimit(float Limit, float FrameRate)
+	{
+		if (FrameRate == 0.f || Limit == 0.f)
+		{
+			return Limit;
+		}
+
+		return FMath::Max(1.f, FMath::RoundToFloat(Limit * FrameRate));
+	}
+
+	/* Checks a duration or an interval against minimal and maximal limits, each unused if zero. See ScaleTimeLimit for the frame rate. */
+	static bool CheckTimeLimits(float Time, float MinLimit, float MaxLimit, float FrameRate)
+	{
+		if (MaxLimit != 0.f && Time > ScaleTimeLimit(MaxLimit, FrameRate))
+		{
+			return false;
+		}
+		if (MinLimit != 0.f && Time < ScaleTimeLimit(MinLimit, FrameRate))
+		{
+			return false;
+		}
+
+		return true;
+	}
+};
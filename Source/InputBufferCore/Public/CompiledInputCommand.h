@@ -0,0 +1,158 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+#include "InputCommandProgram.h"
+
+/* An entry of a compiled input command. Input events are ranges of indices to the name table of the command. */
+struct FCompiledInputCommandEntry
+{
+	FCompiledInputCommandEntry()
+		: FirstMatchName(0)
+		, NumMatchNames(0)
+		, FirstIgnoreName(0)
+		, NumIgnoreNames(0)
+		, MinDuration(0.f)
+		, MaxDuration(0.f)
+		, MinInterval(0.f)
+		, MaxInterval(0.f)
+		, bIgnoreOthers(false)
+	{}
+
+	int32 FirstMatchName;
+	int32 NumMatchNames;
+	int32 FirstIgnoreName;
+	int32 NumIgnoreNames;
+
+	float MinDuration;
+	float MaxDuration;
+	float MinInterval;
+	float MaxInterval;
+
+	bool bIgnoreOthers;
+
+	friend FArchive& operator<<(FArchive& Ar, FCompiledInputCommandEntry& Entry)
+	{
+		Ar << Entry.FirstMatchName << Entry.NumMatchNames << Entry.FirstIgnoreName << Entry.NumIgnoreNames;
+		Ar << Entry.MinDuration << Entry.MaxDuration << Entry.MinInterval << Entry.MaxInterval;
+		Ar << Entry.bIgnoreOthers;
+		return Ar;
+	}
+};
+
+/* A sequence of a compiled input command. Its entries are stored contiguously in the entries of the command. */
+struct FCompiledInputCommandSequence
+{
+	FCompiledInputCommandSequence()
+		: FirstEntry(0)
+		, NumEntries(0)
+	{}
+
+	int32 FirstEntry;
+
+	int32 NumEntries;
+
+	friend FArchive& operator<<(FArchive& Ar, FCompiledInputCommandSequence& Sequence)
+	{
+		Ar << Sequence.FirstEntry << Sequence.NumEntries;
+		return Ar;
+	}
+};
+
+/**
+* Input command compiled independently of any input buffer: enabled sequences and their entries flattened into contiguous arrays,
+* with all input event names collected in a table. Serialized in cooked assets, so loading it is a single pass over a few arrays.
+* Bound to an input buffer by resolving the name table to event bit flags once, which produces an FInputCommandProgram.
+*/
+struct INPUTBUFFERCORE_API FCompiledInputCommand
+{
+	FCompiledInputCommand()
+		: TimeLimit(0.f)
+		, FirstIgnoreName(0)
+		, NumIgnoreNames(0)
+	{}
+
+	void Reset();
+
+	/**
+	* Produces a program for an input buffer.
+	*
+	* @param NameFlags Bit flag of each input event in the name table, or zero if the event is unknown to the input buffer.
+	* @param OutProgram The program to fill. Its allocations are reused.
+	*/
+	void Bind(const uint64* NameFlags, FInputCommandProgram& OutProgram) const;
+
+	/**
+	* Returns the minimum capacity of input history needed to recognize the command, i.e. the most records any sequence can be spread over:
+	* a record for each entry and an empty record after it, plus records of other input events toggling while an entry that tolerates them is held.
+	* If record times are frame indices, every record lasts at least a frame, so time limits and durations bound the records of tolerant entries.
+	* Records are merged only if both their events and translated events are the same, so with translated events every entry counts as tolerant
+	* and any number of empty records can separate entries, which only the time limit bounds.
+	*
+	* @param FrameRate Frames per second if record times are frame indices, or zero if they are in seconds.
+	* @param bTranslatedEvents Whether records of input history can differ in translated events alone.
+	* @return The number of records, or INDEX_NONE if a tolerant entry can be spread over any number of records, e.g. if record times are in seconds.
+	*/
+	int32 GetMinHistoryRecords(float FrameRate, bool bTranslatedEvents = false) const;
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Names.GetAllocatedSize() + NameRefs.GetAllocatedSize() + Sequences.GetAllocatedSize() + Entries.GetAllocatedSize();
+	}
+
+	friend INPUTBUFFERCORE_API FArchive& operator<<(FArchive& Ar, FCompiledInputCommand& Command);
+
+	/* Time limit of valid input in seconds. Unused if zero. */
+	float TimeLimit;
+
+	/* Input events ignored by the whole command. */
+	int32 FirstIgnoreName;
+	int32 NumIgnoreNames;
+
+	/* Distinct input event names used by the command. */
+	TArray<FName> Names;
+
+	/* Indices to the name table, referred to by ranges in entries. */
+	TArray<int32> NameRefs;
+
+	TArray<FCompiledInputCommandSequence> Sequences;
+
+	TArray<FCompiledInputCommandEntry> Entries;
+};
+
+/**
+* Input commands compiled as a unit, in order of priority. All commands share one name table, so binding the set resolves each input event once.
+* Name references of the commands are indices to the shared table, and their own name tables are empty.
+*/
+struct INPUTBUFFERCORE_API FCompiledInputCommandSet
+{
+	void Reset();
+
+	/* Appends a compiled input command, merging its name table into the shared one. */
+	void Add(const FCompiledInputCommand& Command);
+
+	/**
+	* Produces a program for each command for an input buffer.
+	*
+	* @param NameFlags Bit flag of each input event in the shared name table, or zero if the event is unknown to the input buffer.
+	* @param OutProgram The programs to fill. Their allocations are reused.
+	*/
+	void Bind(const uint64* NameFlags, FInputCommandSetProgram& OutProgram) const;
+
+	/**
+	* Returns the minimum capacity of input history needed to recognize every command, or INDEX_NONE if any command is unbounded. See FCompiledInputCommand::GetMinHistoryRecords.
+	*
+	* @param OutCommandIdx (Optional) Set to the index of the command that needs the most records, or INDEX_NONE if the set is empty.
+	* @param bTranslatedEvents Whether records of input history can differ in translated events alone.
+	*/
+	int32 GetMinHistoryRecords(float FrameRate, int32* OutCommandIdx = nullptr, bool bTranslatedEvents = false) const;
+
+	SIZE_T GetAllocatedSize() const;
+
+	friend INPUTBUFFERCORE_API FArchive& operator<<(FArchive& Ar, FCompiledInputCommandSet& CommandSet);
+
+	/* Distinct input event names used by all the commands. */
+	TArray<FName> Names;
+
+	TArray<FCompiledInputCommand> Commands;
+};
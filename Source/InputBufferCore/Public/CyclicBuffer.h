@@ -1,369 +1,487 @@
-// Copyright 2017 Isaac Hsu. MIT License
-
-#pragma once
-
-#include "Array.h"
-
-template<typename ElementType, typename Allocator>
-class TCyclicBuffer;
-
-template<typename ContainerType, typename ElementType>
-class TCyclicBufferIterator
-{
-	typedef TCyclicBufferIterator ThisClass;
-
-public:
-
-	TCyclicBufferIterator(ContainerType& InContainer)
-		: Container(InContainer)
-		, Index(InContainer.GetHeadIndex())
-	{}
-
-	TCyclicBufferIterator(ContainerType& InContainer, int32 StartIndex)
-		: Container(InContainer)
-		, Index(InContainer.GetHeadIndex() + StartIndex)
-	{
-		if (Container.IsValidIndex(StartIndex))
-		{
-			if (Index >= Container.Num())
-			{
-				Index -= Container.Num();
-			}
-		}
-		else
-		{
-			Index = Container.Num();
-		}
-	}
-
-	/** Advances iterator to the next element in the container. */
-	ThisClass& operator++()
-	{
-		Advance();
-		return *this;
-	}
-
-	ThisClass operator++(int)
-	{
-		ThisClass Tmp(*this);
-		Advance();
-		return Tmp;
-	}
-
-	/** @name Element access */
-	//@{
-	ElementType& operator* () const
-	{
-		return Container[Index];
-	}
-
-	ElementType* operator-> () const
-	{
-		return &Container[Index];
-	}
-	//@}
-
-	/** conversion to "bool" returning true if the iterator has not reached the last element. */
-	FORCEINLINE explicit operator bool() const
-	{
-		return Container.IsValidIndex(Index);
-	}
-	/** inverse of the "bool" operator */
-	FORCEINLINE bool operator !() const
-	{
-		return !(bool)*this;
-	}
-
-private:
-
-	void Advance()
-	{
-		if (Index == Container.TailIndex) // If we have reached the tail
-		{
-			Index = Container.Num();
-		}
-		else
-		{
-			++Index;
-			int32 Limit = Container.Num() - 1;
-			if (Index > Limit && Container.TailIndex != Limit) // If we have reached the upper bound but not the tail
-			{
-				Index = 0;
-			}
-		}
-	}
-
-	int32 Index;
-	ContainerType& Container;
-};
-
-template<typename ContainerType, typename ElementType>
-class TCyclicBufferReverseIterator
-{
-	typedef TCyclicBufferReverseIterator ThisClass;
-
-public:
-
-	TCyclicBufferReverseIterator(ContainerType& InContainer)
-		: Container(InContainer)
-		, Index(InContainer.TailIndex)
-	{}
-
-	TCyclicBufferReverseIterator(ContainerType& InContainer, int32 StartIndex)
-		: Container(InContainer)
-		, Index(InContainer.TailIndex - StartIndex)
-	{
-		if (Container.IsValidIndex(StartIndex))
-		{
-			if (Index < 0)
-			{
-				Index += Container.Num();
-			}
-		}
-		else
-		{
-			Index = INDEX_NONE;
-		}
-	}
-
-	/** Advances iterator to the next element in the container. */
-	ThisClass& operator++()
-	{
-		Advance();
-		return *this;
-	}
-
-	ThisClass operator++(int)
-	{
-		ThisClass Tmp(*this);
-		Advance();
-		return Tmp;
-	}
-
-	/** @name Element access */
-	//@{
-	ElementType& operator* () const
-	{
-		return Container[Index];
-	}
-
-	ElementType* operator-> () const
-	{
-		return &Container[Index];
-	}
-	//@}
-
-	/** conversion to "bool" returning true if the iterator has not reached the last element. */
-	FORCEINLINE explicit operator bool() const
-	{
-		return Container.IsValidIndex(Index);
-	}
-	/** inverse of the "bool" operator */
-	FORCEINLINE bool operator !() const
-	{
-		return !(bool)*this;
-	}
-
-private:
-
-	void Advance()
-	{
-		if (Index == Container.GetHeadIndex()) // If we have reached the head
-		{
-			Index = INDEX_NONE;
-		}
-		else
-		{
-			--Index;
-			int32 Limit = Container.Num() - 1;
-			if (Index < 0 && Container.TailIndex != Limit) // If we have reached the lower bound but not the head
-			{
-				Index = Limit;
-			}
-		}
-	}
-
-	int32 Index;
-	ContainerType& Container;
-};
-
-/**
-* Homogeneous cyclic buffer based on TArray. When a new element is added, the oldest one may be replaced if the buffer is full.
-*
-* Caution: Must resize the buffer before adding elements to it.
-*/
-template<typename ElementType, typename Allocator = FDefaultAllocator>
-class TCyclicBuffer : private TArray<ElementType, Allocator>
-{
-	typedef TArray<ElementType, Allocator> Super;
-
-public:
-
-	typedef TCyclicBufferIterator<TCyclicBuffer, ElementType> TIterator;
-	friend TIterator;
-
-	typedef TCyclicBufferIterator<const TCyclicBuffer, const ElementType> TConstIterator;
-	friend TConstIterator;
-
-	typedef TCyclicBufferReverseIterator<TCyclicBuffer, ElementType> TReverseIterator;
-	friend TReverseIterator;
-
-	typedef TCyclicBufferReverseIterator<const TCyclicBuffer, const ElementType> TConstReverseIterator;
-	friend TConstReverseIterator;
-
-public:
-
-	TCyclicBuffer()	: TailIndex(INDEX_NONE) {}
-
-	using Super::Num;
-	using Super::Max;
-	using Super::GetData;
-
-	/**
-	* Returns n-th last element from the buffer.
-	*
-	* @param IndexFromTheEnd (Optional) Index from the end of buffer (default = 0).
-	* @returns Reference to n-th last element from the buffer.
-	*/
-	FORCEINLINE ElementType* LastOrNull(int32 IndexFromTheEnd = 0)
-	{
-		ElementType* Result = nullptr;
-		if (IndexFromTheEnd >= 0 && IndexFromTheEnd < Super::ArrayNum)
-		{
-			int32 Index = TailIndex - IndexFromTheEnd;
-			if (Index < 0)
-			{
-				Index += Super::ArrayNum;
-			}
-			Result = GetData() + Index;
-		}
-		return Result;
-	}
-
-	/**
-	* Returns n-th last element from the buffer.
-	*
-	* Const version of the above.
-	*
-	* @param IndexFromTheEnd (Optional) Index from the end of buffer (default = 0).
-	* @returns Reference to n-th last element from the buffer.
-	*/
-	FORCEINLINE const ElementType* LastOrNull(int32 IndexFromTheEnd = 0) const
-	{
-		const ElementType* Result = nullptr;
-		if (IndexFromTheEnd >= 0 && IndexFromTheEnd < Super::ArrayNum)
-		{
-			int32 Index = TailIndex - IndexFromTheEnd;
-			if (Index < 0)
-			{
-				Index += Super::ArrayNum;
-			}
-			Result = GetData() + Index;
-		}
-		return Result;
-	}
-
-	/**
-	* Empties the array. It calls the destructors on held items if needed.
-	*
-	* @param Slack (Optional) The expected usage size after empty operation. Default is 0.
-	*/
-	FORCEINLINE void Reset(int32 Slack = 0)
-	{
-		Super::Reset(Slack);
-		TailIndex = INDEX_NONE;
-	}
-
-	/**
-	* Adds a new item to the buffer, possibly replacing the oldest element.
-	*
-	* @param Item The item to add
-	* @return Index to the new item
-	*/
-	int32 Add(const ElementType& Item)
-	{
-		if (Super::ArrayMax == 0)
-		{
-			return INDEX_NONE;
-		}
-
-		if (Super::ArrayNum < Super::ArrayMax)
-		{
-			TailIndex = Super::Add(Item);
-		}
-		else
-		{
-			int32 HeadIndex = (TailIndex < Super::ArrayMax - 1) ? TailIndex + 1 : 0;
-			(*this)[HeadIndex] = Item;
-			TailIndex = HeadIndex;
-		}
-
-		return TailIndex;
-	}
-
-	/**
-	* Creates a iterator for the contents of this buffer
-	*
-	* @param StartIndex (Optional) Index from the beginning of buffer (default = 0).
-	* @returns The iterator.
-	*/
-	TIterator CreateIterator(int32 StartIndex = 0)
-	{
-		return TIterator(*this, StartIndex);
-	}
-
-	/**
-	* Creates a const iterator for the contents of this buffer
-	*
-	* @returns The const iterator.
-	* @param StartIndex (Optional) Index from the beginning of buffer (default = 0).
-	*/
-	TConstIterator CreateConstIterator(int32 StartIndex = 0) const
-	{
-		return TConstIterator(*this, StartIndex);
-	}
-
-	/**
-	* Creates a reverse iterator for the contents of this buffer
-	*
-	* @param StartIndex (Optional) Index from the end of buffer (default = 0).
-	* @returns The iterator.
-	*/
-	TReverseIterator CreateReverseIterator(int32 StartIndex = 0)
-	{
-		return TReverseIterator(*this, StartIndex);
-	}
-
-	/**
-	* Creates a const reverse iterator for the contents of this buffer
-	*
-	* @param StartIndex (Optional) Index from the end of buffer (default = 0).
-	* @returns The const iterator.
-	*/
-	TConstReverseIterator CreateConstReverseIterator(int32 StartIndex = 0) const
-	{
-		return TConstReverseIterator(*this, StartIndex);
-	}
-
-protected:
-
-	/* The index of the first element. */
-	int32 GetHeadIndex() const 
-	{ 
-		if (Super::ArrayNum == 0)
-		{
-			return INDEX_NONE;
-		}
-		//else if (Super::ArrayNum < Super::ArrayMax)
-		//{
-		//	return 0;
-		//}
-		else
-		{
-			return (TailIndex < Super::ArrayNum - 1) ? TailIndex + 1 : 0;
-		}
-	}
-
-	/* The index of the last element. */
-	int32 TailIndex;
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+#include "Array.h"
+
+template<typename ElementType, typename Allocator>
+class TCyclicBuffer;
+
+template<typename ContainerType, typename ElementType>
+class TCyclicBufferIterator
+{
+	typedef TCyclicBufferIterator ThisClass;
+
+public:
+
+	TCyclicBufferIterator(ContainerType& InContainer)
+		: Container(InContainer)
+		, Index(InContainer.GetHeadIndex())
+	{}
+
+	TCyclicBufferIterator(ContainerType& InContainer, int32 StartIndex)
+		: Container(InContainer)
+		, Index(InContainer.GetHeadIndex() + StartIndex)
+	{
+		if (Container.IsValidIndex(StartIndex))
+		{
+			if (Index >= Container.Num())
+			{
+				Index -= Container.Num();
+			}
+		}
+		else
+		{
+			Index = Container.Num();
+		}
+	}
+
+	/** Advances iterator to the next element in the container. */
+	ThisClass& operator++()
+	{
+		Advance();
+		return *this;
+	}
+
+	ThisClass operator++(int)
+	{
+		ThisClass Tmp(*this);
+		Advance();
+		return Tmp;
+	}
+
+	/** @name Element access */
+	//@{
+	ElementType& operator* () const
+	{
+		return Container[Index];
+	}
+
+	ElementType* operator-> () const
+	{
+		return &Container[Index];
+	}
+	//@}
+
+	/** conversion to "bool" returning true if the iterator has not reached the last element. */
+	FORCEINLINE explicit operator bool() const
+	{
+		return Container.IsValidIndex(Index);
+	}
+	/** inverse of the "bool" operator */
+	FORCEINLINE bool operator !() const
+	{
+		return !(bool)*this;
+	}
+
+private:
+
+	void Advance()
+	{
+		if (Index == Container.TailIndex) // If we have reached the tail
+		{
+			Index = Container.Num();
+		}
+		else
+		{
+			++Index;
+			int32 Limit = Container.Num() - 1;
+			if (Index > Limit && Container.TailIndex != Limit) // If we have reached the upper bound but not the tail
+			{
+				Index = 0;
+			}
+		}
+	}
+
+	int32 Index;
+	ContainerType& Container;
+};
+
+template<typename ContainerType, typename ElementType>
+class TCyclicBufferReverseIterator
+{
+	typedef TCyclicBufferReverseIterator ThisClass;
+
+public:
+
+	TCyclicBufferReverseIterator(ContainerType& InContainer)
+		: Container(InContainer)
+		, Index(InContainer.TailIndex)
+	{}
+
+	TCyclicBufferReverseIterator(ContainerType& InContainer, int32 StartIndex)
+		: Container(InContainer)
+		, Index(InContainer.TailIndex - StartIndex)
+	{
+		if (Container.IsValidIndex(StartIndex))
+		{
+			if (Index < 0)
+			{
+				Index += Container.Num();
+			}
+		}
+		else
+		{
+			Index = INDEX_NONE;
+		}
+	}
+
+	/** Advances iterator to the next element in the container. */
+	ThisClass& operator++()
+	{
+		Advance();
+		return *this;
+	}
+
+	ThisClass operator++(int)
+	{
+		ThisClass Tmp(*this);
+		Advance();
+		return Tmp;
+	}
+
+	/** @name Element access */
+	//@{
+	ElementType& operator* () const
+	{
+		return Container[Index];
+	}
+
+	ElementType* operator-> () const
+	{
+		return &Container[Index];
+	}
+	//@}
+
+	/** conversion to "bool" returning true if the iterator has not reached the last element. */
+	FORCEINLINE explicit operator bool() const
+	{
+		return Container.IsValidIndex(Index);
+	}
+	/** inverse of the "bool" operator */
+	FORCEINLINE bool operator !() const
+	{
+		return !(bool)*this;
+	}
+
+private:
+
+	void Advance()
+	{
+		if (Index == Container.GetHeadIndex()) // If we have reached the head
+		{
+			Index = INDEX_NONE;
+		}
+		else
+		{
+			--Index;
+			int32 Limit = Container.Num() - 1;
+			if (Index < 0 && Container.TailIndex != Limit) // If we have reached the lower bound but not the head
+			{
+				Index = Limit;
+			}
+		}
+	}
+
+	int32 Index;
+	ContainerType& Container;
+};
+
+/**
+* Homogeneous cyclic buffer based on TArray. When a new element is added, the oldest one may be replaced if the buffer is full.
+*
+* The capacity of the buffer is kept apart from its allocation, which may be larger, e.g. storage taken from a pool.
+*
+* Caution: Must resize the buffer before adding elements to it.
+*/
+template<typename ElementType, typename Allocator = FDefaultAllocator>
+class TCyclicBuffer : private TArray<ElementType, Allocator>
+{
+	typedef TArray<ElementType, Allocator> Super;
+
+public:
+
+	typedef TCyclicBufferIterator<TCyclicBuffer, ElementType> TIterator;
+	friend TIterator;
+
+	typedef TCyclicBufferIterator<const TCyclicBuffer, const ElementType> TConstIterator;
+	friend TConstIterator;
+
+	typedef TCyclicBufferReverseIterator<TCyclicBuffer, ElementType> TReverseIterator;
+	friend TReverseIterator;
+
+	typedef TCyclicBufferReverseIterator<const TCyclicBuffer, const ElementType> TConstReverseIterator;
+	friend TConstReverseIterator;
+
+public:
+
+	TCyclicBuffer()	: TailIndex(INDEX_NONE), Capacity(0) {}
+
+	using Super::Num;
+	using Super::GetData;
+	using Super::GetAllocatedSize;
+
+	/* Returns the capacity of the buffer, i.e. how many elements it holds before the oldest one is replaced. */
+	FORCEINLINE int32 Max() const
+	{
+		return Capacity;
+	}
+
+	/**
+	* Returns n-th last element from the buffer.
+	*
+	* @param IndexFromTheEnd (Optional) Index from the end of buffer (default = 0).
+	* @returns Reference to n-th last element from the buffer.
+	*/
+	FORCEINLINE ElementType* LastOrNull(int32 IndexFromTheEnd = 0)
+	{
+		ElementType* Result = nullptr;
+		if (IndexFromTheEnd >= 0 && IndexFromTheEnd < Super::ArrayNum)
+		{
+			int32 Index = TailIndex - IndexFromTheEnd;
+			if (Index < 0)
+			{
+				Index += Super::ArrayNum;
+			}
+			Result = GetData() + Index;
+		}
+		return Result;
+	}
+
+	/**
+	* Returns n-th last element from the buffer.
+	*
+	* Const version of the above.
+	*
+	* @param IndexFromTheEnd (Optional) Index from the end of buffer (default = 0).
+	* @returns Reference to n-th last element from the buffer.
+	*/
+	FORCEINLINE const ElementType* LastOrNull(int32 IndexFromTheEnd = 0) const
+	{
+		const ElementType* Result = nullptr;
+		if (IndexFromTheEnd >= 0 && IndexFromTheEnd < Super::ArrayNum)
+		{
+			int32 Index = TailIndex - IndexFromTheEnd;
+			if (Index < 0)
+			{
+				Index += Super::ArrayNum;
+			}
+			Result = GetData() + Index;
+		}
+		return Result;
+	}
+
+	/**
+	* Empties the array. It calls the destructors on held items if needed.
+	*
+	* @param Slack (Optional) The capacity of the buffer after empty operation. Default is 0.
+	*/
+	FORCEINLINE void Reset(int32 Slack = 0)
+	{
+		Super::Reset(Slack);
+		TailIndex = INDEX_NONE;
+		Capacity = Slack;
+	}
+
+	/**
+	* Overwrites the contents of the buffer with raw elements, e.g. those copied from GetData() of another buffer.
+	* The capacity of the buffer is left untouched, so nothing is allocated.
+	*
+	* Caution: Only usable with element types that can be copied bitwise. Count must not exceed Max().
+	*
+	* @param Data Raw elements in storage order.
+	* @param Count The number of elements.
+	* @param InTailIndex The storage index of the last element, as returned by GetTailIndex().
+	*/
+	void RestoreRaw(const ElementType* Data, int32 Count, int32 InTailIndex)
+	{
+		check(Count >= 0 && Count <= Capacity);
+		check(Count == 0 ? InTailIndex == INDEX_NONE : (InTailIndex >= 0 && InTailIndex < Count));
+
+		Super::SetNumUninitialized(Count, false);
+		if (Count > 0)
+		{
+			FMemory::Memcpy(GetData(), Data, Count * sizeof(ElementType));
+		}
+		TailIndex = InTailIndex;
+	}
+
+	/**
+	* Changes the capacity of the buffer, keeping the newest elements in order. Reallocates the buffer if the capacity changes.
+	*
+	* @param NewMax The new capacity.
+	*/
+	void SetMax(int32 NewMax)
+	{
+		check(NewMax >= 0);
+		if (NewMax == Capacity)
+		{
+			return;
+		}
+
+		const int32 Count = FMath::Min(Super::ArrayNum, NewMax);
+
+		Super Elements;
+		Elements.Reserve(NewMax);
+		for (auto It = CreateConstIterator(Super::ArrayNum - Count); It; ++It)
+		{
+			Elements.Add(*It);
+		}
+
+		Super::operator=(MoveTemp(Elements));
+		TailIndex = Count - 1;
+		Capacity = NewMax;
+	}
+
+	/**
+	* Changes the capacity of the buffer like SetMax, but moves the newest elements into given storage instead of allocating, e.g. storage taken from a pool.
+	*
+	* @param Storage Storage that can hold the new capacity. Receives the previous storage emptied, with its allocation kept for reuse.
+	* @param NewMax The new capacity, which may be less than the capacity of the storage.
+	*/
+	void ExchangeStorage(TArray<ElementType, Allocator>& Storage, int32 NewMax)
+	{
+		check(NewMax >= 0 && NewMax <= Storage.Max());
+
+		const int32 Count = FMath::Min(Super::ArrayNum, NewMax);
+
+		Storage.Reset();
+		for (auto It = CreateConstIterator(Super::ArrayNum - Count); It; ++It)
+		{
+			Storage.Add(*It);
+		}
+
+		Swap(static_cast<Super&>(*this), Storage);
+		Storage.Reset();
+		TailIndex = Count - 1;
+		Capacity = NewMax;
+	}
+
+	/**
+	* Removes the newest elements, keeping the older ones in order. Reorders the storage, so it is meant for rare operations such as rolling back.
+	*
+	* @param Count The number of elements to remove. All elements are removed if it exceeds Num().
+	*/
+	void RemoveLatest(int32 Count)
+	{
+		check(Count >= 0);
+
+		const int32 NumKept = FMath::Max(Super::ArrayNum - Count, 0);
+		if (NumKept == Super::ArrayNum)
+		{
+			return;
+		}
+
+		Super Elements;
+		Elements.Reserve(Capacity);
+		for (auto It = CreateConstIterator(); It && Elements.Num() < NumKept; ++It)
+		{
+			Elements.Add(*It);
+		}
+
+		Super::operator=(MoveTemp(Elements));
+		TailIndex = NumKept - 1;
+	}
+
+	/* Returns the storage index of the last element, or INDEX_NONE if the buffer is empty. */
+	FORCEINLINE int32 GetTailIndex() const
+	{
+		return TailIndex;
+	}
+
+	/**
+	* Adds a new item to the buffer, possibly replacing the oldest element.
+	*
+	* @param Item The item to add
+	* @return Index to the new item
+	*/
+	int32 Add(const ElementType& Item)
+	{
+		if (Capacity == 0)
+		{
+			return INDEX_NONE;
+		}
+
+		if (Super::ArrayNum < Capacity)
+		{
+			TailIndex = Super::Add(Item);
+		}
+		else
+		{
+			int32 HeadIndex = (TailIndex < Capacity - 1) ? TailIndex + 1 : 0;
+			(*this)[HeadIndex] = Item;
+			TailIndex = HeadIndex;
+		}
+
+		return TailIndex;
+	}
+
+	/**
+	* Creates a iterator for the contents of this buffer
+	*
+	* @param StartIndex (Optional) Index from the beginning of buffer (default = 0).
+	* @returns The iterator.
+	*/
+	TIterator CreateIterator(int32 StartIndex = 0)
+	{
+		return TIterator(*this, StartIndex);
+	}
+
+	/**
+	* Creates a const iterator for the contents of this buffer
+	*
+	* @returns The const iterator.
+	* @param StartIndex (Optional) Index from the beginning of buffer (default = 0).
+	*/
+	TConstIterator CreateConstIterator(int32 StartIndex = 0) const
+	{
+		return TConstIterator(*this, StartIndex);
+	}
+
+	/**
+	* Creates a reverse iterator for the contents of this buffer
+	*
+	* @param StartIndex (Optional) Index from the end of buffer (default = 0).
+	* @returns The iterator.
+	*/
+	TReverseIterator CreateReverseIterator(int32 StartIndex = 0)
+	{
+		return TReverseIterator(*this, StartIndex);
+	}
+
+	/**
+	* Creates a const reverse iterator for the contents of this buffer
+	*
+	* @param StartIndex (Optional) Index from the end of buffer (default = 0).
+	* @returns The const iterator.
+	*/
+	TConstReverseIterator CreateConstReverseIterator(int32 StartIndex = 0) const
+	{
+		return TConstReverseIterator(*this, StartIndex);
+	}
+
+protected:
+
+	/* The index of the first element. */
+	int32 GetHeadIndex() const 
+	{ 
+		if (Super::ArrayNum == 0)
+		{
+			return INDEX_NONE;
+		}
+		//else if (Super::ArrayNum < Super::ArrayMax)
+		//{
+		//	return 0;
+		//}
+		else
+		{
+			return (TailIndex < Super::ArrayNum - 1) ? TailIndex + 1 : 0;
+		}
+	}
+
+	/* The index of the last element. */
+	int32 TailIndex;
+
+	/* The number of elements the buffer holds before the oldest one is replaced, at most the allocated size. */
+	int32 Capacity;
 };
\ No newline at end of file
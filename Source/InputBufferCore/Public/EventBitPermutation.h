@@ -0,0 +1,78 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+#include "InputBufferRecord.h"
+
+/**
+* Moves bits of input events to new positions, e.g. after input events are registered again in another order, and drops bits of unregistered events.
+* Bits that move by the same distance are moved together with one mask and one shift. Registering, removing or reordering a few events
+* shifts runs of neighbouring bits alike, so a mapping usually takes a handful of groups however many events are registered.
+*/
+struct FEventBitPermutation
+{
+	FEventBitPermutation()
+		: NumGroups(0)
+	{}
+
+	/**
+	* Builds the permutation.
+	*
+	* @param NewIndices New bit index of each old bit, or INDEX_NONE to drop the bit.
+	* @param Num The number of old bits, at most FInputBufferRecord::MAX_EVENTS.
+	*/
+	void Build(const int32* NewIndices, int32 Num)
+	{
+		check(Num <= FInputBufferRecord::MAX_EVENTS);
+
+		NumGroups = 0;
+		for (int32 Idx = 0; Idx < Num; Idx++)
+		{
+			if (NewIndices[Idx] == INDEX_NONE)
+			{
+				continue;
+			}
+
+			check(NewIndices[Idx] >= 0 && NewIndices[Idx] < FInputBufferRecord::MAX_EVENTS);
+			const int32 Shift = NewIndices[Idx] - Idx;
+
+			int32 Group = 0;
+			while (Group < NumGroups && Shifts[Group] != Shift)
+			{
+				Group++;
+			}
+
+			if (Group == NumGroups)
+			{
+				Masks[Group] = 0;
+				Shifts[Group] = Shift;
+				NumGroups++;
+			}
+
+			Masks[Group] |= 1ULL << Idx;
+		}
+	}
+
+	/* Returns given bit flags with their bits moved to new positions. */
+	FORCEINLINE uint64 Apply(uint64 Flags) const
+	{
+		uint64 Result = 0;
+		for (int32 Group = 0; Group < NumGroups; Group++)
+		{
+			const uint64 Bits = Flags & Masks[Group];
+			Result |= Shifts[Group] >= 0 ? Bits << Shifts[Group] : Bits >> -Shifts[Group];
+		}
+
+		return Result;
+	}
+
+private:
+
+	/* Old bits of each group. */
+	uint64 Masks[FInputBufferRecord::MAX_EVENTS];
+
+	/* How far bits of each group move, toward higher bits if positive. */
+	int32 Shifts[FInputBufferRecord::MAX_EVENTS];
+
+	int32 NumGroups;
+};
@@ -0,0 +1,97 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+/**
+* A small cache of values keyed by bit flags of input events, which evicts the least recently used value when full.
+* Input history tends to reuse a handful of event combinations, so a few slots searched linearly beat a hash map.
+* Evicted values are kept in their slots, so their allocations are reused by the values that replace them.
+*/
+template<typename ValueType, int32 NumSlots>
+class TEventMaskCache
+{
+public:
+
+	static const int32 Capacity = NumSlots;
+
+	TEventMaskCache()
+		: NumUsed(0)
+		, Clock(0)
+	{}
+
+	/* Returns the value cached for given bit flags and marks it as the most recently used, or null if it is not cached. */
+	ValueType* Find(uint64 Mask)
+	{
+		for (int32 Idx = 0; Idx < NumUsed; Idx++)
+		{
+			if (Masks[Idx] == Mask)
+			{
+				LastUses[Idx] = ++Clock;
+				return &Values[Idx];
+			}
+		}
+
+		return nullptr;
+	}
+
+	/**
+	* Adds a slot for given bit flags, which must not be cached yet, evicting the least recently used slot if the cache is full.
+	*
+	* @return The value of the slot, which the caller must overwrite. It may still hold the evicted value.
+	*/
+	ValueType& Add(uint64 Mask)
+	{
+		int32 Slot = NumUsed;
+		if (NumUsed < NumSlots)
+		{
+			NumUsed++;
+		}
+		else
+		{
+			// The clock may wrap around, which only makes a single eviction less optimal.
+			Slot = 0;
+			for (int32 Idx = 1; Idx < NumSlots; Idx++)
+			{
+				if (LastUses[Idx] < LastUses[Slot])
+				{
+					Slot = Idx;
+				}
+			}
+		}
+
+		Masks[Slot] = Mask;
+		LastUses[Slot] = ++Clock;
+		return Values[Slot];
+	}
+
+	/* Forgets all cached values, e.g. after event bits change meaning. Allocations of the values are kept. */
+	void Reset()
+	{
+		NumUsed = 0;
+	}
+
+	/* Returns the number of cached values. */
+	int32 Num() const
+	{
+		return NumUsed;
+	}
+
+	/* Returns values of all slots, including unused ones that keep allocations of forgotten values. */
+	const ValueType* GetSlotValues() const
+	{
+		return Values;
+	}
+
+private:
+
+	uint64 Masks[NumSlots];
+
+	uint32 LastUses[NumSlots];
+
+	ValueType Values[NumSlots];
+
+	int32 NumUsed;
+
+	/* Increased on every use, so that the least recently used slot has the smallest stamp. */
+	uint32 Clock;
+};
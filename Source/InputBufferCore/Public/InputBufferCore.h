@@ -0,0 +1,14 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+#include "ModuleManager.h"
+
+/**
+* UObject-free part of input buffering: input records, the cyclic history and command matching on compiled input commands.
+* Depends on the Core module only, so it can be used without UObjects, a world or player input. It is still built by UnrealBuildTool
+* and is not a standalone library: its containers and assertions come from Core, and its tests are automation tests.
+*/
+class FInputBufferCoreModule : public IModuleInterface
+{
+};
@@ -0,0 +1,153 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+#include "CyclicBuffer.h"
+
+/* Record stored in input buffer representing the same input status over one or several frames. */
+struct FInputBufferRecord
+{
+	FInputBufferRecord()
+		: bValid(false)
+		, StartTime(0.f)
+		, EndTime(0.f)
+		, Events(0)
+		, TranslatedEvents(0)
+	{}
+
+	FInputBufferRecord(float InStarTime, float InEndTime, uint64 InEvents, uint64 InTranslatedEvents, bool bInValid = true)
+		: bValid(bInValid)
+		, StartTime(InStarTime)
+		, EndTime(InEndTime)
+		, Events(InEvents)
+		, TranslatedEvents(InTranslatedEvents)
+	{}
+
+	/** Whether this record is valid. */
+	bool bValid;
+
+	/** Time when we start to record it. */
+	float StartTime;
+
+	/** Time when we stop recording it. */
+	float EndTime;
+
+	/** Bit flags of input events. */
+	uint64 Events;
+
+	/** Input events that are translated from. */
+	uint64 TranslatedEvents;
+
+	/** Input event capacity = the number of bits of event flags. */
+	static const int32 MAX_EVENTS = sizeof(uint64) * 8;
+};
+
+/**
+* Input history, from the oldest record to the latest one.
+* Records are invalidated by moving a watermark instead of writing their flags, so invalidation takes constant time however long the history is:
+* a record is valid only if its own flag is set and it was added after the watermark.
+*/
+class FInputBufferHistory : public TCyclicBuffer<FInputBufferRecord>
+{
+	typedef TCyclicBuffer<FInputBufferRecord> Super;
+
+public:
+
+	FInputBufferHistory()
+		: NumAdded(0)
+		, ValidSerial(0)
+	{}
+
+	/**
+	* Adds a new record to the history, possibly replacing the oldest one if the history is full.
+	*
+	* @return Index to the new record
+	*/
+	int32 Add(const FInputBufferRecord& Record)
+	{
+		const int32 Index = Super::Add(Record);
+		if (Index != INDEX_NONE)
+		{
+			NumAdded++;
+		}
+
+		return Index;
+	}
+
+	/* Empties the history, which clears the watermark too. */
+	void Reset(int32 Slack = 0)
+	{
+		Super::Reset(Slack);
+		NumAdded = 0;
+		ValidSerial = 0;
+	}
+
+	/**
+	* Overwrites the history with raw records, e.g. those of a snapshot. See TCyclicBuffer::RestoreRaw.
+	*
+	* @param NumValid The number of the latest records above the watermark, as returned by GetNumValid().
+	*/
+	void RestoreRaw(const FInputBufferRecord* Data, int32 Count, int32 InTailIndex, int32 NumValid)
+	{
+		check(NumValid >= 0 && NumValid <= Count);
+
+		Super::RestoreRaw(Data, Count, InTailIndex);
+		NumAdded = Count;
+		ValidSerial = Count - NumValid;
+	}
+
+	/**
+	* Removes the latest records and moves the watermark, e.g. to undo records added since a snapshot was taken. See TCyclicBuffer::RemoveLatest.
+	*
+	* @param NumRemoved The number of the latest records to remove.
+	* @param NumValid The number of the latest remaining records above the watermark afterwards.
+	*/
+	void RollBack(int32 NumRemoved, int32 NumValid)
+	{
+		Super::RemoveLatest(NumRemoved);
+		NumAdded = Num();
+		ValidSerial = Num() - FMath::Clamp(NumValid, 0, Num());
+	}
+
+	/* Returns the number of the latest records above the watermark. Records among them may still be invalid by their own flags. */
+	FORCEINLINE int32 GetNumValid() const
+	{
+		return (int32)FMath::Min<uint32>(NumAdded - ValidSerial, Num());
+	}
+
+	/* Returns whether a record is valid for command recognition. Its index is from the end of the history, i.e. zero is the latest record. */
+	FORCEINLINE bool IsValidRecord(int32 IndexFromTheEnd) const
+	{
+		return IndexFromTheEnd < GetNumValid() && LastOrNull(IndexFromTheEnd)->bValid;
+	}
+
+	/* Invalidates all records. */
+	FORCEINLINE void Invalidate()
+	{
+		ValidSerial = NumAdded;
+	}
+
+	/**
+	* Invalidates a record and all records older than it, keeping later records valid.
+	*
+	* @param IndexFromTheEnd Index of the latest record to invalidate from the end of the history, i.e. zero invalidates all records.
+	*/
+	FORCEINLINE void InvalidateFrom(int32 IndexFromTheEnd)
+	{
+		check(IndexFromTheEnd >= 0);
+
+		// The watermark never moves back, so records invalidated before stay invalid.
+		if (IndexFromTheEnd < GetNumValid())
+		{
+			ValidSerial = NumAdded - IndexFromTheEnd;
+		}
+	}
+
+private:
+
+	/* The number of records added since the history was reset, which is the serial number of the next record. */
+	uint32 NumAdded;
+
+	/* The serial number of the oldest record above the watermark. */
+	uint32 ValidSerial;
+};
@@ -0,0 +1,434 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+#include "BufferedInputEventKit.h"
+#include "InputBufferRecord.h"
+
+/* An entry of a compiled input command, with input events resolved to bit flags. */
+struct FInputCommandProgramEntry
+{
+	FInputCommandProgramEntry()
+		: MatchFlags(0)
+		, IgnoreFlags(0)
+		, MinDuration(0.f)
+		, MaxDuration(0.f)
+		, MinInterval(0.f)
+		, MaxInterval(0.f)
+		, bIgnoreOthers(false)
+	{}
+
+	CONSTEXPR FInputCommandProgramEntry(uint64 InMatchFlags, uint64 InIgnoreFlags, bool bInIgnoreOthers, float InMinDuration, float InMaxDuration, float InMinInterval, float InMaxInterval)
+		: MatchFlags(InMatchFlags)
+		, IgnoreFlags(InIgnoreFlags)
+		, MinDuration(InMinDuration)
+		, MaxDuration(InMaxDuration)
+		, MinInterval(InMinInterval)
+		, MaxInterval(InMaxInterval)
+		, bIgnoreOthers(bInIgnoreOthers)
+	{}
+
+	/* Bit flags of input events to match. */
+	uint64 MatchFlags;
+
+	/* Bit flags of input events to ignore, including those ignored by the whole command. Unused if bIgnoreOthers is true. */
+	uint64 IgnoreFlags;
+
+	float MinDuration;
+	float MaxDuration;
+	float MinInterval;
+	float MaxInterval;
+
+	/* If true, ignore the presence of the other input events except those to match. */
+	bool bIgnoreOthers;
+
+	FORCEINLINE bool MatchEvents(uint64 Events) const
+	{
+		return bIgnoreOthers ? FBufferedInputEventKit::HasEventFlags(Events, MatchFlags) : FBufferedInputEventKit::CompareEventFlags(Events, MatchFlags, IgnoreFlags);
+	}
+
+	FORCEINLINE bool CheckDuration(float Duration, float FrameRate) const
+	{
+		return FBufferedInputEventKit::CheckTimeLimits(Duration, MinDuration, MaxDuration, FrameRate);
+	}
+
+	FORCEINLINE bool CheckInterval(float Interval, float FrameRate) const
+	{
+		return FBufferedInputEventKit::CheckTimeLimits(Interval, MinInterval, MaxInterval, FrameRate);
+	}
+};
+
+/* A sequence of a compiled input command. Its entries are stored contiguously in the entries of the program. */
+struct FInputCommandProgramSequence
+{
+	FInputCommandProgramSequence()
+		: FirstEntry(0)
+		, NumEntries(0)
+		, TriggerFlags(0)
+		, bResolved(true)
+	{}
+
+	int32 FirstEntry;
+
+	int32 NumEntries;
+
+	/**
+	* Bit flags of input events to match by the last entry. The latest non-empty record must have all of them for the sequence to match,
+	* so sequences are skipped without being set up if it does not. Zero disables the check.
+	*/
+	uint64 TriggerFlags;
+
+	/* False if any entry has input events to match that are unknown to the input buffer, in which case the sequence never matches. */
+	bool bResolved;
+};
+
+/**
+* Plain representation of an input command with all enabled sequences and their entries flattened, and input events resolved to bit flags of an input buffer.
+* Compiled from UInputCommand by UInputBufferComponent.
+*/
+struct FInputCommandProgram
+{
+	FInputCommandProgram() : TimeLimit(0.f) {}
+
+	/* Empties the program but keeps its allocations for reuse. */
+	void Reset()
+	{
+		TimeLimit = 0.f;
+		Sequences.Reset();
+		Entries.Reset();
+	}
+
+	/* Time limit of valid input in seconds. Unused if zero. */
+	float TimeLimit;
+
+	TArray<FInputCommandProgramSequence> Sequences;
+
+	TArray<FInputCommandProgramEntry> Entries;
+};
+
+/* Programs of a set of input commands bound to the same input buffer, in order of priority. */
+struct INPUTBUFFERCORE_API FInputCommandSetProgram
+{
+	FInputCommandSetProgram()
+	{
+		FMemory::Memzero(TriggerStarts);
+	}
+
+	/* Builds the trigger index from trigger flags of the commands. Must be called after the commands change. */
+	void BuildTriggerIndex();
+
+	/**
+	* Marks commands that may match given the events of the latest non-empty record, according to the trigger index.
+	*
+	* @param TriggerEvents Events of the latest non-empty record.
+	* @param OutCandidates Set to whether each command may match.
+	*/
+	void GetCandidates(uint64 TriggerEvents, TBitArray<>& OutCandidates) const;
+
+	SIZE_T GetAllocatedSize() const;
+
+	TArray<FInputCommandProgram> Commands;
+
+	/* Indices of commands with a sequence whose trigger flags have a given lowest bit, grouped by the bit. */
+	TArray<int32> TriggeredCommands;
+
+	/* Where the commands for each bit start in TriggeredCommands. The commands for bit N end where those for bit N + 1 start. */
+	int32 TriggerStarts[FInputBufferRecord::MAX_EVENTS + 1];
+
+	/* Indices of commands with a sequence without trigger flags, which are always candidates. */
+	TArray<int32> UntriggeredCommands;
+};
+
+/* Records matched by an entry of an input command. Indices are from the end of input history, i.e. zero is the latest record. */
+struct FInputCommandMatchedEntry
+{
+	/* The oldest record matched by the entry. */
+	int32 StartRecord;
+
+	/* The latest record matched by the entry. */
+	int32 EndRecord;
+};
+
+/**
+* Where an input command matched in input history, filled in by the matcher while it walks the records, so gameplay code can tell
+* when a motion started without copying or scanning the history again. Record indices are from the end of input history, i.e. zero is the latest record,
+* as taken by FInputBufferHistory::LastOrNull and CreateConstReverseIterator. They are valid until a record is added to the history.
+*/
+struct FInputCommandMatchResult
+{
+	FInputCommandMatchResult()
+		: StartRecord(INDEX_NONE)
+		, EndRecord(INDEX_NONE)
+		, StartTime(0.f)
+		, EndTime(0.f)
+	{}
+
+	void Reset()
+	{
+		StartRecord = INDEX_NONE;
+		EndRecord = INDEX_NONE;
+		StartTime = 0.f;
+		EndTime = 0.f;
+		Entries.Reset();
+	}
+
+	/* Whether the match spans any record. False if nothing matched, or if the matching sequence has no entries. */
+	bool HasRecords() const
+	{
+		return StartRecord != INDEX_NONE;
+	}
+
+	/* Fills in the span of the match from the records of its entries. */
+	FORCEINLINE void SetSpan(const FInputBufferHistory& History)
+	{
+		if (Entries.Num() > 0)
+		{
+			StartRecord = Entries[0].StartRecord;
+			EndRecord = Entries.Last().EndRecord;
+			StartTime = History.LastOrNull(StartRecord)->StartTime;
+			EndTime = History.LastOrNull(EndRecord)->EndTime;
+		}
+		else
+		{
+			StartRecord = INDEX_NONE;
+			EndRecord = INDEX_NONE;
+			StartTime = 0.f;
+			EndTime = 0.f;
+		}
+	}
+
+	/* The oldest record of the match, i.e. the first record matched by the first entry. */
+	int32 StartRecord;
+
+	/* The latest record of the match, i.e. the last record matched by the last entry. Trailing empty records are not part of the match. */
+	int32 EndRecord;
+
+	/* The start time of the oldest record of the match, in the time unit of records. */
+	float StartTime;
+
+	/* The end time of the latest record of the match, in the time unit of records. */
+	float EndTime;
+
+	/* Records matched by each entry of the matching sequence. */
+	TArray<FInputCommandMatchedEntry, TInlineAllocator<8>> Entries;
+};
+
+/* Recognizes compiled input commands in input history. */
+struct INPUTBUFFERCORE_API FInputCommandMatcher
+{
+	/**
+	* Matches a compiled input command against input history. The command matches if any of its sequences matches.
+	* Entries of a sequence are matched backwards from the latest record, skipping empty records and receding to the previous entry when a record fails the current one.
+	*
+	* @param Program The compiled input command.
+	* @param History Input history to match.
+	* @param CurrTime The current time in the time unit of records.
+	* @param FrameRate Frames per second if record times are frame indices, or zero if they are in seconds.
+	* @param OutNumVisited (Optional) Incremented by the number of visited records.
+	* @param OutResult (Optional) Set to where the command matches, or reset if it does not.
+	* @param OutNumEvaluated (Optional) Incremented if any sequence passes the trigger prefilter and is actually matched against input history.
+	* @return Whether the command matches.
+	*/
+	static bool Match(const FInputCommandProgram& Program, const FInputBufferHistory& History, float CurrTime, float FrameRate, uint32* OutNumVisited = nullptr, FInputCommandMatchResult* OutResult = nullptr, uint32* OutNumEvaluated = nullptr);
+
+	/* Returns the events of the latest non-empty record, which the last entry of every matching sequence needs, or zero if there is none. */
+	static uint64 GetTriggerEvents(const FInputBufferHistory& History);
+
+	/**
+	* Matches a set of compiled input commands against input history. Only commands found in the trigger index for the latest non-empty record are evaluated.
+	*
+	* @param OutMatches (Optional) Set to whether each command matches. If null, matching stops at the first matching command.
+	* @param OutResult (Optional) Set to where the first matching command matches, or reset if none matches.
+	* @param OutNumEvaluated (Optional) Increased by the number of candidate commands actually matched against input history, as counted by Match.
+	* @return The index of the first matching command, i.e. the one with the highest priority, or INDEX_NONE if none matches.
+	*/
+	static int32 MatchSet(const FInputCommandSetProgram& Program, const FInputBufferHistory& History, float CurrTime, float FrameRate, TBitArray<>* OutMatches = nullptr, uint32* OutNumVisited = nullptr, FInputCommandMatchResult* OutResult = nullptr, uint32* OutNumEvaluated = nullptr);
+
+	/**
+	* Matches a sequence of entries against input history. Always inlined, so that callers with constant entries, such as TStaticInputCommand,
+	* get a matcher specialized for them by the compiler.
+	*
+	* @param Entries Entries of the sequence.
+	* @param NumEntries The number of entries.
+	* @param CommandTimeLimit Time limit of valid input in seconds. Unused if zero.
+	* @param History Input history to match, which must not be empty.
+	* @param NumVisited Incremented by the number of visited records.
+	* @param OutResult (Optional) Set to where the sequence matches. Left undefined if it does not.
+	*/
+	static bool MatchEntries(const FInputCommandProgramEntry* Entries, int32 NumEntries, float CommandTimeLimit, const FInputBufferHistory& History, float CurrTime, float FrameRate, uint32& NumVisited, FInputCommandMatchResult* OutResult = nullptr);
+
+private:
+
+	static bool MatchSequence(const FInputCommandProgram& Program, const FInputCommandProgramSequence& Sequence, const FInputBufferHistory& History, float CurrTime, float FrameRate, uint32& NumVisited, FInputCommandMatchResult* OutResult);
+
+	/* Passes the outcome of matching entries through, filling in the span of the result on success. */
+	static FORCEINLINE bool FinishEntries(bool bMatched, const FInputBufferHistory& History, FInputCommandMatchResult* OutResult)
+	{
+		if (bMatched && OutResult)
+		{
+			OutResult->SetSpan(History);
+		}
+
+		return bMatched;
+	}
+};
+
+FORCEINLINE bool FInputCommandMatcher::MatchEntries(const FInputCommandProgramEntry* Entries, int32 NumEntries, float CommandTimeLimit, const FInputBufferHistory& History, float CurrTime, float FrameRate, uint32& NumVisited, FInputCommandMatchResult* OutResult)
+{
+	const float TimeLimit = FBufferedInputEventKit::ScaleTimeLimit(CommandTimeLimit, FrameRate);
+
+	bool bRepeating = false; // Are we trying to repeat the current entry?
+	bool bCanRecede = false; // Can we rollback to the previous entry?
+	float CurrEntryStartTime = 0; // The start time of the oldest matching record for the current entry. Used to check durations of entries.
+	float CurrEntryEndTime = 0; // The end time of the latest matching record for the current entry. Used to check durations of entries.
+	float PrevEntryStartTime = 0; // The start time of the oldest matching record for the previous entry. Used to check durations and interval of entries.
+	float PrevEntryEndTime = 0; // The end time of the latest matching record for the previous entry. Used to check durations of entries.
+	int32 EntryIdx = NumEntries - 1; // The index of the command entry to match in the current iteration.
+	int32 RecordIdx = 0; // The index of the current record from the end of input history.
+	const int32 NumValid = History.GetNumValid(); // Records from this index on are below the invalidation watermark.
+	auto It = History.CreateConstReverseIterator(); // Input history iterator.
+
+	if (OutResult)
+	{
+		OutResult->Entries.SetNumUninitialized(NumEntries, false);
+	}
+
+	while (EntryIdx >= 0)
+	{
+		const FInputCommandProgramEntry& Entry = Entries[EntryIdx];
+		const FInputBufferRecord& Record = *It;
+		NumVisited++;
+
+		if (!Record.bValid || RecordIdx >= NumValid)
+		{
+			if (bRepeating && EntryIdx == 0)
+			{
+				// Even if we failed to repeat the first entry, command recognition still succeeds since we have found matching records for all entries.
+				return FinishEntries(Entry.CheckDuration(CurrEntryEndTime - CurrEntryStartTime, FrameRate), History, OutResult);
+			}
+			else
+			{
+				return false; // Need not check the previous records since they should be invalid too.
+			}
+		}
+
+		if (CurrTime - Record.EndTime > TimeLimit && TimeLimit != 0.f && !bRepeating)
+		{
+			return false;
+		}
+
+		const bool bMatched = Entry.MatchEvents(Record.Events); // Whether the current record matches the current entry?
+		bool bNextEntry = true; // Should we advance to the next entry in the next iteraion?
+		bool bNextRecord = true; // Should we advance to the next record in the next iteraion?
+
+		if (bMatched)
+		{
+			if (CurrEntryEndTime == 0)
+			{
+				// Check limits of the duration of the previous entry.
+				if (PrevEntryEndTime != 0.f)
+				{
+					const FInputCommandProgramEntry& PrevEntry = Entries[EntryIdx + 1];
+					if (!PrevEntry.CheckDuration(PrevEntryEndTime - PrevEntryStartTime, FrameRate))
+					{
+						return false;
+					}
+				}
+
+				// Check limits of the internal between the current entry and previous entry.
+				if (PrevEntryStartTime != 0.f && !Entry.CheckInterval(PrevEntryStartTime - Record.EndTime, FrameRate))
+				{
+					return false;
+				}
+
+				CurrEntryEndTime = Record.EndTime;
+
+				if (OutResult)
+				{
+					OutResult->Entries[EntryIdx].EndRecord = RecordIdx;
+				}
+			}
+			CurrEntryStartTime = Record.StartTime;
+
+			if (OutResult)
+			{
+				OutResult->Entries[EntryIdx].StartRecord = RecordIdx;
+			}
+
+			if (EntryIdx > 0)
+			{
+				bCanRecede = true;
+				bRepeating = false;
+			}
+			else
+			{
+				bCanRecede = false;
+				bRepeating = true;
+				bNextEntry = false;
+			}
+		}
+		else if (bRepeating && EntryIdx == 0)
+		{
+			// Even if we failed to repeat the first entry, command recognition still succeeds since we have found matching records for all entries.
+			return FinishEntries(Entry.CheckDuration(CurrEntryEndTime - CurrEntryStartTime, FrameRate), History, OutResult);
+		}
+		else if (Record.Events == 0)
+		{
+			// Skip the current record when no input.
+			bCanRecede = false;
+			bRepeating = false;
+			bNextEntry = false;
+		}
+		else if (bCanRecede)
+		{
+			// When failing to match the current entry, we try the previous entry if possible.
+			bCanRecede = false;
+			bRepeating = true;
+			bNextRecord = false;
+			bNextEntry = false;
+			EntryIdx++;
+			check(EntryIdx < NumEntries);
+
+			CurrEntryStartTime = PrevEntryStartTime;
+			CurrEntryEndTime = PrevEntryEndTime;
+			PrevEntryStartTime = 0.f;
+			PrevEntryEndTime = 0.f;
+		}
+		else
+		{
+			return false; // Fails due to mismatch.
+		}
+
+		if (bNextRecord)
+		{
+			++It;
+			RecordIdx++;
+			if (!It) // If there is no remaining history.
+			{
+				if (EntryIdx == 0 && bMatched)
+				{
+					return FinishEntries(Entry.CheckDuration(CurrEntryEndTime - CurrEntryStartTime, FrameRate), History, OutResult); // since we have checked all the entries
+				}
+				else
+				{
+					return false; // Fails because of mismatch or no remaining history to match the next entry.
+				}
+			}
+		}
+
+		if (bNextEntry)
+		{
+			if (CurrEntryEndTime != 0)
+			{
+				PrevEntryStartTime = CurrEntryStartTime;
+				PrevEntryEndTime = CurrEntryEndTime;
+				CurrEntryStartTime = 0.f;
+				CurrEntryEndTime = 0.f;
+			}
+
+			EntryIdx--;
+		}
+	}
+
+	return FinishEntries(true, History, OutResult); // since we have checked all the entries and didn't fail
+}
@@ -0,0 +1,102 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+#include "InputCommandProgram.h"
+
+/**
+* An entry of an input command declared in C++. Time limits are in milliseconds, since floating point values cannot be template arguments.
+*
+* @param InMatchFlags Bit flags of input events to match.
+* @param InIgnoreFlags Bit flags of input events to ignore. Unused if bInIgnoreOthers is true.
+* @param bInIgnoreOthers If true, ignore the presence of the other input events except those to match.
+*/
+template<uint64 InMatchFlags, uint64 InIgnoreFlags = 0, bool bInIgnoreOthers = false, int32 MinDurationMs = 0, int32 MaxDurationMs = 0, int32 MinIntervalMs = 0, int32 MaxIntervalMs = 0>
+struct TStaticInputCommandEntry
+{
+	static const uint64 MatchFlags = InMatchFlags;
+
+	static CONSTEXPR FInputCommandProgramEntry Get()
+	{
+		return FInputCommandProgramEntry(InMatchFlags, InIgnoreFlags, bInIgnoreOthers, MinDurationMs / 1000.f, MaxDurationMs / 1000.f, MinIntervalMs / 1000.f, MaxIntervalMs / 1000.f);
+	}
+};
+
+/* Returns the last type of a parameter pack. */
+template<typename... Types>
+struct TStaticInputCommandLast;
+
+template<typename Type>
+struct TStaticInputCommandLast<Type>
+{
+	typedef Type Result;
+};
+
+template<typename Type, typename... Types>
+struct TStaticInputCommandLast<Type, Types...>
+{
+	typedef typename TStaticInputCommandLast<Types...>::Result Result;
+};
+
+/**
+* An input command with a single sequence declared in C++, for fixed motions shared by every character such as quarter-circle or charge back-forward.
+* Its entries are constants, so the matcher is specialized for them at compile time instead of reading data-driven programs.
+*
+* Event bits are indices of input events in the order UInputBufferComponent::Initialize registers them, i.e. enabled EventSetups followed by TranslatedEvents.
+* Match with UInputBufferComponent::MatchStaticCommand.
+*
+* Example:
+*	typedef TStaticInputCommand<0,
+*		TStaticInputCommandEntry<DOWN>,
+*		TStaticInputCommandEntry<DOWN | RIGHT>,
+*		TStaticInputCommandEntry<RIGHT | PUNCH>> FQuarterCircleForwardPunch;
+*
+* @param TimeLimitMs Time limit of valid input in milliseconds. Unused if zero.
+*/
+template<int32 TimeLimitMs, typename... EntryTypes>
+struct TStaticInputCommand
+{
+	static const int32 NumEntries = sizeof...(EntryTypes);
+
+	static_assert(NumEntries > 0, "A static input command needs at least an entry.");
+
+	/* Bit flags of input events to match by the last entry, which the latest non-empty record must have. */
+	static const uint64 TriggerFlags = TStaticInputCommandLast<EntryTypes...>::Result::MatchFlags;
+
+	/**
+	* Matches the command against input history.
+	*
+	* @param CurrTime The current time in the time unit of records.
+	* @param FrameRate Frames per second if record times are frame indices, or zero if they are in seconds.
+	* @param OutNumVisited (Optional) Incremented by the number of visited records.
+	* @param OutResult (Optional) Set to where the command matches, or reset if it does not.
+	*/
+	static bool Match(const FInputBufferHistory& History, float CurrTime, float FrameRate, uint32* OutNumVisited = nullptr, FInputCommandMatchResult* OutResult = nullptr)
+	{
+		if (History.Num() == 0 || !FBufferedInputEventKit::HasEventFlags(FInputCommandMatcher::GetTriggerEvents(History), TriggerFlags))
+		{
+			if (OutResult)
+			{
+				OutResult->Reset();
+			}
+			return false;
+		}
+
+		static CONSTEXPR FInputCommandProgramEntry Entries[] = { EntryTypes::Get()... };
+
+		uint32 NumVisited = 0;
+		const bool bMatched = FInputCommandMatcher::MatchEntries(Entries, NumEntries, TimeLimitMs / 1000.f, History, CurrTime, FrameRate, NumVisited, OutResult);
+
+		if (!bMatched && OutResult)
+		{
+			OutResult->Reset();
+		}
+
+		if (OutNumVisited)
+		{
+			*OutNumVisited += NumVisited;
+		}
+
+		return bMatched;
+	}
+};
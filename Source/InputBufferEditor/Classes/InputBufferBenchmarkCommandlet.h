@@ -0,0 +1,21 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "InputBufferBenchmarkCommandlet.generated.h"
+
+/**
+ * Runs input buffer micro-benchmarks without the automation framework and writes results as JSON.
+ *
+ * Usage: UE4Editor-Cmd <Project> -run=InputBufferBenchmark [-Output=<Filename>] [-Scale=<Iteration multiplier>]
+ */
+UCLASS()
+class INPUTBUFFEREDITOR_API UInputBufferBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+	//~ Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	//~ End UCommandlet Interface
+};
@@ -0,0 +1,39 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferEditor.h"
+#include "InputBufferBenchmarkCommandlet.h"
+#include "Tests/InputBufferBenchmark.h"
+
+UInputBufferBenchmarkCommandlet::UInputBufferBenchmarkCommandlet(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UInputBufferBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString Filename = FInputBufferBenchmark::GetDefaultFilename();
+	FParse::Value(*Params, TEXT("Output="), Filename);
+
+	float Scale = 1.f;
+	FParse::Value(*Params, TEXT("Scale="), Scale);
+
+	TArray<FInputBufferBenchmarkResult> Results;
+	FInputBufferBenchmark::RunAll(Results, Scale);
+
+	for (const auto& Result : Results)
+	{
+		UE_LOG(InputBufferEditorLog, Display, TEXT("%-32s %10.1f ns"), *Result.Name, Result.GetNanosecondsPerIteration());
+	}
+
+	if (!FInputBufferBenchmark::WriteJson(Results, Filename))
+	{
+		return 1;
+	}
+
+	UE_LOG(InputBufferEditorLog, Display, TEXT("Benchmark results are written to '%s'."), *Filename);
+	return 0;
+}
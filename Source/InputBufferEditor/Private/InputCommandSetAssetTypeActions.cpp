@@ -0,0 +1,40 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferEditor.h"
+
+#include "InputCommandSetAssetTypeActions.h"
+#include "InputCommandSet.h"
+
+#define LOCTEXT_NAMESPACE "AssetTypeActions"
+
+//////////////////////////////////////////////////////////////////////////
+// FInputCommandSetAssetTypeActions
+
+FInputCommandSetAssetTypeActions::FInputCommandSetAssetTypeActions(EAssetTypeCategories::Type InAssetCategory)
+	: MyAssetCategory(InAssetCategory)
+{
+}
+
+FText FInputCommandSetAssetTypeActions::GetName() const
+{
+	return LOCTEXT("FInputCommandSetAssetTypeActionsName", "Input Command Set");
+}
+
+FColor FInputCommandSetAssetTypeActions::GetTypeColor() const
+{
+	return FColor(160, 96, 84);
+}
+
+UClass* FInputCommandSetAssetTypeActions::GetSupportedClass() const
+{
+	return UInputCommandSet::StaticClass();
+}
+
+uint32 FInputCommandSetAssetTypeActions::GetCategories()
+{
+	return MyAssetCategory;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+#undef LOCTEXT_NAMESPACE
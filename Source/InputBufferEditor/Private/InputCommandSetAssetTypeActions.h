@@ -0,0 +1,21 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+#include "AssetTypeActions_Base.h"
+
+class FInputCommandSetAssetTypeActions : public FAssetTypeActions_Base
+{
+public:
+	FInputCommandSetAssetTypeActions(EAssetTypeCategories::Type InAssetCategory);
+
+	// IAssetTypeActions interface
+	virtual FText GetName() const override;
+	virtual FColor GetTypeColor() const override;
+	virtual UClass* GetSupportedClass() const override;
+	virtual uint32 GetCategories() override;
+	// End of IAssetTypeActions interface
+
+private:
+	EAssetTypeCategories::Type MyAssetCategory;
+};
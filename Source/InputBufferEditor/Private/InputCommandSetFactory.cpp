@@ -0,0 +1,18 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferEditor.h"
+#include "InputCommandSetFactory.h"
+#include "InputCommandSet.h"
+
+UInputCommandSetFactory::UInputCommandSetFactory(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	bCreateNew = true;
+	bEditAfterNew = true;
+	SupportedClass = UInputCommandSet::StaticClass();
+}
+
+UObject* UInputCommandSetFactory::FactoryCreateNew(UClass* Class, UObject* InParent, FName Name, EObjectFlags Flags, UObject* Context, FFeedbackContext* Warn)
+{
+	return NewObject<UInputCommandSet>(InParent, Class, Name, Flags);
+}
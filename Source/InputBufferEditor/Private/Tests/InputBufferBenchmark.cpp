@@ -0,0 +1,461 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferEditor.h"
+#include "AutomationTest.h"
+#include "Json.h"
+#include "GameFramework/PlayerInput.h"
+#include "InputBufferComponent.h"
+#include "InputCommand.h"
+#include "Tests/InputBufferBenchmark.h"
+
+namespace
+{
+	/* Benchmarked results are accumulated here so that the work is not optimized away. */
+	volatile uint64 BenchmarkSink = 0;
+
+	/* A move of a fighting game. Each entry lists input events separated by spaces, e.g. "Down Right". */
+	struct FBenchmarkMove
+	{
+		const TCHAR* Name;
+		const TCHAR* Entries[7];
+		float ChargeDuration;
+	};
+
+	/* A typical move list of a fighting game character facing right. */
+	const FBenchmarkMove BenchmarkMoves[] =
+	{
+		{ TEXT("QuarterCircleForwardPunch"), { TEXT("Down"), TEXT("Down Right"), TEXT("Right Punch") }, 0.f },
+		{ TEXT("QuarterCircleForwardKick"), { TEXT("Down"), TEXT("Down Right"), TEXT("Right Kick") }, 0.f },
+		{ TEXT("QuarterCircleBackPunch"), { TEXT("Down"), TEXT("Down Left"), TEXT("Left Punch") }, 0.f },
+		{ TEXT("QuarterCircleBackKick"), { TEXT("Down"), TEXT("Down Left"), TEXT("Left Kick") }, 0.f },
+		{ TEXT("DragonPunch"), { TEXT("Right"), TEXT("Down"), TEXT("Down Right Punch") }, 0.f },
+		{ TEXT("DragonKick"), { TEXT("Right"), TEXT("Down"), TEXT("Down Right Kick") }, 0.f },
+		{ TEXT("HalfCircleForwardSlash"), { TEXT("Left"), TEXT("Down Left"), TEXT("Down"), TEXT("Down Right"), TEXT("Right Slash") }, 0.f },
+		{ TEXT("HalfCircleBackHeavy"), { TEXT("Right"), TEXT("Down Right"), TEXT("Down"), TEXT("Down Left"), TEXT("Left Heavy") }, 0.f },
+		{ TEXT("DoubleQuarterCirclePunch"), { TEXT("Down"), TEXT("Down Right"), TEXT("Right"), TEXT("Down"), TEXT("Down Right"), TEXT("Right Punch") }, 0.f },
+		{ TEXT("FullCirclePunch"), { TEXT("Right"), TEXT("Down"), TEXT("Left"), TEXT("Up Punch") }, 0.f },
+		{ TEXT("ChargeBackForwardPunch"), { TEXT("Left"), TEXT("Right Punch") }, 0.5f },
+		{ TEXT("ChargeDownUpKick"), { TEXT("Down"), TEXT("Up Kick") }, 0.5f },
+		{ TEXT("DashForward"), { TEXT("Right"), TEXT(""), TEXT("Right") }, 0.f },
+		{ TEXT("DashBack"), { TEXT("Left"), TEXT(""), TEXT("Left") }, 0.f },
+		{ TEXT("Throw"), { TEXT("Punch Kick") }, 0.f },
+		{ TEXT("Burst"), { TEXT("Punch Kick Slash Heavy") }, 0.f },
+	};
+
+	const TCHAR* BenchmarkEvents[] = { TEXT("Punch"), TEXT("Kick"), TEXT("Slash"), TEXT("Heavy"), TEXT("Up"), TEXT("Down"), TEXT("Left"), TEXT("Right") };
+
+	/* QuarterCircleForwardPunch of the move list declared in C++, with bits in the order of BenchmarkEvents. */
+	typedef TStaticInputCommand<1000,
+		TStaticInputCommandEntry<1 << 5, 0, false, 0, 0, 0, 200>,
+		TStaticInputCommandEntry<(1 << 5) | (1 << 7), 0, false, 0, 0, 0, 200>,
+		TStaticInputCommandEntry<(1 << 7) | (1 << 0), 0, false, 0, 0, 0, 200>> FBenchmarkQuarterCircleForwardPunch;
+
+	/* Runs a benchmark body for a number of iterations and adds its timing to results. */
+	template<typename BodyType>
+	void RunCase(TArray<FInputBufferBenchmarkResult>& OutResults, const FString& Name, int32 Iterations, BodyType Body)
+	{
+		// Warm up caches and storage allocated on first use.
+		for (int32 Idx = 0; Idx < FMath::Min(Iterations, 64); Idx++)
+		{
+			Body(Idx);
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Idx = 0; Idx < Iterations; Idx++)
+		{
+			Body(Idx);
+		}
+		const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+		OutResults.Add(FInputBufferBenchmarkResult(Name, Iterations, Seconds));
+	}
+
+	int32 ScaleIterations(int32 Iterations, float Scale)
+	{
+		return FMath::Max(1, FMath::RoundToInt(Iterations * Scale));
+	}
+
+	uint64 ParseEventFlags(UInputBufferComponent* InputBuffer, const TCHAR* Text)
+	{
+		TArray<FString> Names;
+		FString(Text).ParseIntoArray(Names, TEXT(" "));
+
+		TArray<FName> Events;
+		for (const FString& Name : Names)
+		{
+			Events.Add(*Name);
+		}
+
+		uint64 Flags = 0;
+		InputBuffer->ConvertEventsToFlags(Events, Flags);
+		return Flags;
+	}
+
+	/* Sets up an input buffer in frame-indexed simulation with the events of the move list. */
+	UInputBufferComponent* CreateMoveListInputBuffer(int32 MaxInputHistory)
+	{
+		auto InputBuffer = NewObject<UInputBufferComponent>();
+		InputBuffer->MaxInputHistory = MaxInputHistory;
+		InputBuffer->bFrameIndexedSimulation = true;
+		InputBuffer->SimulationFrameRate = 60.f;
+
+		for (const TCHAR* Event : BenchmarkEvents)
+		{
+			InputBuffer->TranslatedEvents.Add(Event);
+		}
+
+		InputBuffer->Initialize();
+		return InputBuffer;
+	}
+
+	void CreateMoveListCommands(TArray<UInputCommand*>& OutCommands)
+	{
+		for (const FBenchmarkMove& Move : BenchmarkMoves)
+		{
+			auto Command = NewObject<UInputCommand>(GetTransientPackage(), MakeUniqueObjectName(GetTransientPackage(), UInputCommand::StaticClass(), Move.Name));
+			Command->TimeLimit = 1.f;
+
+			auto& Sequence = Command->Sequences[Command->Sequences.AddDefaulted()];
+			for (int32 Idx = 0; Idx < ARRAY_COUNT(Move.Entries) && Move.Entries[Idx]; Idx++)
+			{
+				auto& Entry = Sequence.Entries[Sequence.Entries.AddDefaulted()];
+
+				TArray<FString> Names;
+				FString(Move.Entries[Idx]).ParseIntoArray(Names, TEXT(" "));
+				for (const FString& Name : Names)
+				{
+					Entry.EventsToMatch.Add(*Name);
+				}
+
+				Entry.MaxInterval = 0.2f;
+				if (Idx == 0 && Move.ChargeDuration > 0.f)
+				{
+					Entry.MinDuration = Move.ChargeDuration;
+				}
+			}
+
+			OutCommands.Add(Command);
+		}
+	}
+
+	/* Simulates a player performing random moves of the move list with some neutral frames in between. */
+	void SimulateMoves(UInputBufferComponent* InputBuffer, int32 NumFrames)
+	{
+		FRandomStream Random(1234);
+		int32 Frame = 1;
+
+		while (Frame <= NumFrames)
+		{
+			const FBenchmarkMove& Move = BenchmarkMoves[Random.RandHelper(ARRAY_COUNT(BenchmarkMoves))];
+			for (int32 Idx = 0; Idx < ARRAY_COUNT(Move.Entries) && Move.Entries[Idx]; Idx++)
+			{
+				const uint64 Flags = ParseEventFlags(InputBuffer, Move.Entries[Idx]);
+				const int32 HoldFrames = (Idx == 0 && Move.ChargeDuration > 0.f) ? FMath::CeilToInt(Move.ChargeDuration * 60.f) : Random.RandRange(1, 3);
+				for (int32 Hold = 0; Hold < HoldFrames; Hold++)
+				{
+					InputBuffer->SimulateFrame(Frame++, Flags);
+				}
+			}
+
+			const int32 NeutralFrames = Random.RandRange(0, 8);
+			for (int32 Neutral = 0; Neutral < NeutralFrames; Neutral++)
+			{
+				InputBuffer->SimulateFrame(Frame++, 0);
+			}
+		}
+	}
+
+	/* Simulates random mashing, which rarely completes any move. */
+	void SimulateNoise(UInputBufferComponent* InputBuffer, int32 NumFrames)
+	{
+		FRandomStream Random(5678);
+		const int32 NumEvents = ARRAY_COUNT(BenchmarkEvents);
+
+		for (int32 Frame = 1; Frame <= NumFrames; Frame++)
+		{
+			InputBuffer->SimulateFrame(Frame, (uint64)Random.RandHelper(1 << NumEvents));
+		}
+	}
+
+	/* Sets up an input buffer with a given number of input events, each bound to its own key. */
+	UInputBufferComponent* CreateKeyedInputBuffer(int32 NumEvents, const TArray<FKey>& Keys)
+	{
+		auto InputBuffer = NewObject<UInputBufferComponent>();
+		InputBuffer->MaxInputHistory = 64;
+
+		for (int32 Idx = 0; Idx < NumEvents && Idx < Keys.Num(); Idx++)
+		{
+			auto& Setup = InputBuffer->EventSetups[InputBuffer->EventSetups.AddDefaulted()];
+			Setup.Name = *FString::Printf(TEXT("Event%d"), Idx);
+			Setup.Type = (FBufferedInputEventType)(Idx % 3);
+			Setup.Keys.Add(Keys[Idx]);
+		}
+
+		InputBuffer->Initialize();
+		return InputBuffer;
+	}
+
+	void RunCyclicBufferBenchmarks(TArray<FInputBufferBenchmarkResult>& OutResults, float Scale)
+	{
+		TCyclicBuffer<FInputBufferRecord> Buffer;
+		Buffer.Reset(64);
+
+		RunCase(OutResults, TEXT("CyclicBuffer.Add"), ScaleIterations(10000000, Scale), [&](int32 Idx)
+		{
+			Buffer.Add(FInputBufferRecord((float)Idx, (float)Idx, (uint64)Idx, 0));
+		});
+
+		RunCase(OutResults, TEXT("CyclicBuffer.Iterate64"), ScaleIterations(1000000, Scale), [&](int32 Idx)
+		{
+			uint64 Sum = 0;
+			for (auto It = Buffer.CreateConstIterator(); It; ++It)
+			{
+				Sum += It->Events;
+			}
+			BenchmarkSink += Sum;
+		});
+
+		RunCase(OutResults, TEXT("CyclicBuffer.ReverseIterate64"), ScaleIterations(1000000, Scale), [&](int32 Idx)
+		{
+			uint64 Sum = 0;
+			for (auto It = Buffer.CreateConstReverseIterator(); It; ++It)
+			{
+				Sum += It->Events;
+			}
+			BenchmarkSink += Sum;
+		});
+	}
+
+	void RunProcessInputBenchmarks(TArray<FInputBufferBenchmarkResult>& OutResults, float Scale)
+	{
+		TArray<FKey> AllKeys;
+		EKeys::GetAllKeys(AllKeys);
+
+		TArray<FKey> Keys;
+		for (const FKey& Key : AllKeys)
+		{
+			if (!Key.IsFloatAxis() && !Key.IsVectorAxis())
+			{
+				Keys.Add(Key);
+			}
+		}
+
+		auto PlayerInput = NewObject<UPlayerInput>();
+		auto& KeyStateMap = PlayerInput->GetKeyStateMap();
+
+		const int32 EventCounts[] = { 8, 32, 64 };
+		for (int32 NumEvents : EventCounts)
+		{
+			auto InputBuffer = CreateKeyedInputBuffer(NumEvents, Keys);
+
+			KeyStateMap.Reset();
+			for (int32 Idx = 0; Idx < NumEvents; Idx++)
+			{
+				KeyStateMap.Add(Keys[Idx], FKeyState());
+			}
+
+			// The map is not modified any more, so its states can be kept by pointer.
+			TArray<FKeyState*> KeyStates;
+			for (int32 Idx = 0; Idx < NumEvents; Idx++)
+			{
+				KeyStates.Add(KeyStateMap.Find(Keys[Idx]));
+			}
+
+			// Each key changes its state every eight frames on average.
+			const int32 NUM_PATTERNS = 256;
+			TArray<uint64> Patterns;
+			FRandomStream Random(NumEvents);
+			uint64 Pattern = 0;
+			for (int32 Idx = 0; Idx < NUM_PATTERNS; Idx++)
+			{
+				for (int32 Bit = 0; Bit < NumEvents; Bit++)
+				{
+					if (Random.RandHelper(8) == 0)
+					{
+						Pattern ^= (1ULL << Bit);
+					}
+				}
+				Patterns.Add(Pattern);
+			}
+
+			RunCase(OutResults, FString::Printf(TEXT("ProcessInput.Events%d"), NumEvents), ScaleIterations(200000, Scale), [&](int32 Idx)
+			{
+				const uint64 KeyBits = Patterns[Idx % NUM_PATTERNS];
+				for (int32 Bit = 0; Bit < NumEvents; Bit++)
+				{
+					KeyStates[Bit]->bDown = (uint8)((KeyBits >> Bit) & 0x1);
+				}
+
+				InputBuffer->OnPostProcessInput(PlayerInput, false);
+			});
+		}
+
+		KeyStateMap.Reset();
+	}
+
+	void RunMatchCommandBenchmarks(TArray<FInputBufferBenchmarkResult>& OutResults, float Scale)
+	{
+		TArray<UInputCommand*> Commands;
+		CreateMoveListCommands(Commands);
+
+		auto MovesBuffer = CreateMoveListInputBuffer(64);
+		SimulateMoves(MovesBuffer, 600);
+
+		RunCase(OutResults, TEXT("MatchCommand.MoveList"), ScaleIterations(500000, Scale), [&](int32 Idx)
+		{
+			BenchmarkSink += MovesBuffer->MatchCommand(Commands[Idx % Commands.Num()]);
+		});
+
+		// Programs compiled once and matched by the UObject-free core matcher, without the component adapter.
+		TArray<FInputCommandProgram> Programs;
+		Programs.SetNum(Commands.Num());
+		for (int32 Idx = 0; Idx < Commands.Num(); Idx++)
+		{
+			MovesBuffer->CompileCommand(Commands[Idx], Programs[Idx]);
+		}
+
+		const FInputBufferHistory& MovesHistory = MovesBuffer->GetInputHistory();
+		const float MovesTime = (float)MovesBuffer->GetSimulationFrame();
+
+		RunCase(OutResults, TEXT("InputCommandMatcher.MoveList"), ScaleIterations(500000, Scale), [&](int32 Idx)
+		{
+			BenchmarkSink += FInputCommandMatcher::Match(Programs[Idx % Programs.Num()], MovesHistory, MovesTime, 60.f);
+		});
+
+		// The same command data-driven and declared in C++.
+		RunCase(OutResults, TEXT("MatchCommand.QuarterCircleForwardPunch"), ScaleIterations(500000, Scale), [&](int32 Idx)
+		{
+			BenchmarkSink += MovesBuffer->MatchCommand(Commands[0]);
+		});
+
+		RunCase(OutResults, TEXT("MatchStaticCommand.QuarterCircleForwardPunch"), ScaleIterations(500000, Scale), [&](int32 Idx)
+		{
+			BenchmarkSink += MovesBuffer->MatchStaticCommand<FBenchmarkQuarterCircleForwardPunch>();
+		});
+
+		auto NoiseBuffer = CreateMoveListInputBuffer(64);
+		SimulateNoise(NoiseBuffer, 600);
+
+		RunCase(OutResults, TEXT("MatchCommand.Noise"), ScaleIterations(500000, Scale), [&](int32 Idx)
+		{
+			BenchmarkSink += NoiseBuffer->MatchCommand(Commands[Idx % Commands.Num()]);
+		});
+	}
+
+	void RunHistoryRecordsBenchmarks(TArray<FInputBufferBenchmarkResult>& OutResults, float Scale)
+	{
+		auto InputBuffer = CreateMoveListInputBuffer(64);
+		SimulateMoves(InputBuffer, 600);
+
+		TArray<FInputHistoryRecord> Records;
+
+		RunCase(OutResults, TEXT("GetHistoryRecords.64"), ScaleIterations(100000, Scale), [&](int32 Idx)
+		{
+			Records.Reset();
+			InputBuffer->GetHistoryRecords(Records);
+			BenchmarkSink += Records.Num();
+		});
+
+		// Visiting the same records in place, with only bit flags read.
+		RunCase(OutResults, TEXT("VisitHistory.64"), ScaleIterations(100000, Scale), [&](int32 Idx)
+		{
+			uint64 Events = 0;
+			BenchmarkSink += InputBuffer->VisitHistory([&](const FInputHistoryRecordView& View)
+			{
+				Events |= View.GetEventFlags();
+				return true;
+			}, 0.f, false, false);
+			BenchmarkSink += Events;
+		});
+
+		// Printing converts event flags to names of a few recurring combinations.
+		FString Text;
+		RunCase(OutResults, TEXT("PrintTo.64"), ScaleIterations(20000, Scale), [&](int32 Idx)
+		{
+			Text.Reset();
+			InputBuffer->PrintTo(Text);
+			BenchmarkSink += Text.Len();
+		});
+
+		RunCase(OutResults, TEXT("SetHistoryRecords.64"), ScaleIterations(100000, Scale), [&](int32 Idx)
+		{
+			BenchmarkSink += InputBuffer->SetHistoryRecords(Records);
+		});
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FInputBufferBenchmark
+
+void FInputBufferBenchmark::RunAll(TArray<FInputBufferBenchmarkResult>& OutResults, float Scale)
+{
+	RunCyclicBufferBenchmarks(OutResults, Scale);
+	RunProcessInputBenchmarks(OutResults, Scale);
+	RunMatchCommandBenchmarks(OutResults, Scale);
+	RunHistoryRecordsBenchmarks(OutResults, Scale);
+}
+
+FString FInputBufferBenchmark::ToJson(const TArray<FInputBufferBenchmarkResult>& Results)
+{
+	TSharedRef<FJsonObject> Root = MakeShareable(new FJsonObject());
+	Root->SetStringField(TEXT("Suite"), TEXT("InputBuffer"));
+	Root->SetStringField(TEXT("Timestamp"), FDateTime::UtcNow().ToIso8601());
+	Root->SetStringField(TEXT("Platform"), FPlatformProperties::IniPlatformName());
+	Root->SetStringField(TEXT("Configuration"), EBuildConfigurations::ToString(FApp::GetBuildConfiguration()));
+
+	TArray<TSharedPtr<FJsonValue>> Cases;
+	for (const auto& Result : Results)
+	{
+		TSharedRef<FJsonObject> Case = MakeShareable(new FJsonObject());
+		Case->SetStringField(TEXT("Name"), Result.Name);
+		Case->SetNumberField(TEXT("Iterations"), Result.Iterations);
+		Case->SetNumberField(TEXT("TotalMs"), Result.Seconds * 1000.0);
+		Case->SetNumberField(TEXT("NsPerIteration"), Result.GetNanosecondsPerIteration());
+
+		Cases.Add(MakeShareable(new FJsonValueObject(Case)));
+	}
+	Root->SetArrayField(TEXT("Results"), Cases);
+
+	FString Json;
+	auto Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Root, Writer);
+	return Json;
+}
+
+bool FInputBufferBenchmark::WriteJson(const TArray<FInputBufferBenchmarkResult>& Results, const FString& Filename)
+{
+	if (!FFileHelper::SaveStringToFile(ToJson(Results), *Filename))
+	{
+		UE_LOG(InputBufferEditorLog, Warning, TEXT("Cannot write benchmark results to '%s'."), *Filename);
+		return false;
+	}
+
+	return true;
+}
+
+FString FInputBufferBenchmark::GetDefaultFilename()
+{
+	return FPaths::ProfilingDir() / TEXT("InputBufferBenchmark.json");
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInputBufferBenchmarkTest, "Plugins.InputBuffer.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FInputBufferBenchmarkTest::RunTest(const FString& Parameters)
+{
+	TArray<FInputBufferBenchmarkResult> Results;
+	FInputBufferBenchmark::RunAll(Results);
+
+	for (const auto& Result : Results)
+	{
+		AddLogItem(FString::Printf(TEXT("%-32s %10.1f ns"), *Result.Name, Result.GetNanosecondsPerIteration()));
+	}
+
+	const FString Filename = FInputBufferBenchmark::GetDefaultFilename();
+	TestTrue(TEXT("Benchmark results should be written as JSON."), FInputBufferBenchmark::WriteJson(Results, Filename));
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
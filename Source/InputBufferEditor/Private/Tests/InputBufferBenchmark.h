@@ -0,0 +1,50 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#pragma once
+
+/* Timing of a single benchmark case. */
+struct FInputBufferBenchmarkResult
+{
+	FInputBufferBenchmarkResult(const FString& InName, int32 InIterations, double InSeconds)
+		: Name(InName)
+		, Iterations(InIterations)
+		, Seconds(InSeconds)
+	{}
+
+	double GetNanosecondsPerIteration() const
+	{
+		return Iterations > 0 ? Seconds * 1e9 / Iterations : 0.0;
+	}
+
+	FString Name;
+
+	int32 Iterations;
+
+	/* Total time of all iterations in seconds. */
+	double Seconds;
+};
+
+/**
+* Micro-benchmarks of the input buffer: the cyclic buffer, input processing, command recognition and input history access.
+* Run by the automation test Plugins.InputBuffer.Benchmark and by the commandlet InputBufferBenchmark.
+* Results are written as JSON so they can be compared between builds.
+*/
+class FInputBufferBenchmark
+{
+public:
+
+	/**
+	* Runs all benchmarks.
+	*
+	* @param OutResults Results of all benchmark cases in order.
+	* @param Scale Multiplier of iteration counts. Lower it for quick runs.
+	*/
+	static void RunAll(TArray<FInputBufferBenchmarkResult>& OutResults, float Scale = 1.f);
+
+	static FString ToJson(const TArray<FInputBufferBenchmarkResult>& Results);
+
+	static bool WriteJson(const TArray<FInputBufferBenchmarkResult>& Results, const FString& Filename);
+
+	/* The default location of benchmark results. */
+	static FString GetDefaultFilename();
+};
@@ -0,0 +1,358 @@
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferEditor.h"
+#include "AutomationTest.h"
+#include "InputBufferComponent.h"
+#include "InputCommand.h"
+#include "InputCommandSet.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	const TCHAR* DifferentialEvents[] = { TEXT("Punch"), TEXT("Kick"), TEXT("Up"), TEXT("Down"), TEXT("Left"), TEXT("Right") };
+
+	/* An event unknown to input buffers, so that commands with unresolved events are covered too. */
+	const TCHAR* UnknownEvent = TEXT("Unknown");
+
+	/* A quarter-circle-forward punch declared in C++, with bits in the order of DifferentialEvents. */
+	typedef TStaticInputCommand<500,
+		TStaticInputCommandEntry<1 << 3>,
+		TStaticInputCommandEntry<(1 << 3) | (1 << 5), 0, false, 0, 0, 0, 100>,
+		TStaticInputCommandEntry<(1 << 5) | (1 << 0), 0, true>> FDifferentialStaticCommand;
+
+	const int32 NUM_TRIALS = 100;
+	const int32 NUM_COMMANDS = 16;
+	const int32 NUM_FRAMES = 200;
+	const int32 MAX_REPORTED_MISMATCHES = 10;
+
+	/* A matcher verified against the reference matcher. */
+	struct FDifferentialPath
+	{
+		FDifferentialPath(const TCHAR* InName, TFunction<bool(int32)> InMatch)
+			: Name(InName)
+			, Match(InMatch)
+			, Cycles(0)
+			, NumMismatches(0)
+		{}
+
+		FString Name;
+
+		/* Matches the command of a given index. */
+		TFunction<bool(int32)> Match;
+
+		uint64 Cycles;
+
+		int32 NumMismatches;
+	};
+
+	/* Returns a random time limit in seconds with a given probability, or zero. */
+	float RandomTimeLimit(FRandomStream& Random, float Probability)
+	{
+		return Random.FRand() < Probability ? Random.RandRange(1, 30) / 60.f : 0.f;
+	}
+
+	void AddRandomEvents(FRandomStream& Random, TArray<FName>& Events, int32 MaxCount, float UnknownProbability)
+	{
+		const int32 Count = Random.RandRange(0, MaxCount);
+		for (int32 Idx = 0; Idx < Count; Idx++)
+		{
+			Events.AddUnique(DifferentialEvents[Random.RandHelper(ARRAY_COUNT(DifferentialEvents))]);
+		}
+
+		if (Random.FRand() < UnknownProbability)
+		{
+			Events.Add(UnknownEvent);
+		}
+	}
+
+	UInputCommand* CreateRandomCommand(FRandomStream& Random)
+	{
+		auto Command = NewObject<UInputCommand>();
+		Command->TimeLimit = Random.FRand() < 0.3f ? Random.RandRange(5, 60) / 60.f : 0.f;
+		if (Random.FRand() < 0.2f)
+		{
+			AddRandomEvents(Random, Command->EventsToIgnore, 2, 0.f);
+		}
+
+		const int32 NumSequences = Random.RandRange(1, 3);
+		for (int32 SequenceIdx = 0; SequenceIdx < NumSequences; SequenceIdx++)
+		{
+			auto& Sequence = Command->Sequences[Command->Sequences.AddDefaulted()];
+			Sequence.bEnabled = Random.FRand() < 0.9f;
+
+			const int32 NumEntries = Random.FRand() < 0.03f ? 0 : Random.RandRange(1, 5);
+			for (int32 EntryIdx = 0; EntryIdx < NumEntries; EntryIdx++)
+			{
+				auto& Entry = Sequence.Entries[Sequence.Entries.AddDefaulted()];
+				AddRandomEvents(Random, Entry.EventsToMatch, 2, 0.03f);
+				if (Random.FRand() < 0.3f)
+				{
+					AddRandomEvents(Random, Entry.EventsToIgnore, 2, 0.1f);
+				}
+
+				Entry.bIgnoreOthers = Random.FRand() < 0.2f;
+				Entry.MinDuration = RandomTimeLimit(Random, 0.1f);
+				Entry.MaxDuration = RandomTimeLimit(Random, 0.1f);
+				Entry.MinInterval = RandomTimeLimit(Random, 0.1f);
+				Entry.MaxInterval = RandomTimeLimit(Random, 0.3f);
+			}
+		}
+
+		return Command;
+	}
+
+	/* Creates the asset equivalent of FDifferentialStaticCommand. */
+	UInputCommand* CreateStaticEquivalentCommand()
+	{
+		auto Command = NewObject<UInputCommand>();
+		Command->TimeLimit = 0.5f;
+
+		FInputCommandSequence& Sequence = Command->Sequences[Command->Sequences.AddDefaulted()];
+		Sequence.Entries.AddDefaulted(3);
+		Sequence.Entries[0].EventsToMatch.Add(TEXT("Down"));
+		Sequence.Entries[1].EventsToMatch.Add(TEXT("Down"));
+		Sequence.Entries[1].EventsToMatch.Add(TEXT("Right"));
+		Sequence.Entries[1].MaxInterval = 0.1f;
+		Sequence.Entries[2].EventsToMatch.Add(TEXT("Right"));
+		Sequence.Entries[2].EventsToMatch.Add(TEXT("Punch"));
+		Sequence.Entries[2].bIgnoreOthers = true;
+
+		return Command;
+	}
+
+	/* Queues frames that perform a random sequence of a command, possibly with extra events, so that histories often match. */
+	void QueueCommandFrames(FRandomStream& Random, UInputBufferComponent* InputBuffer, const UInputCommand* Command, TArray<uint64>& OutFrames)
+	{
+		const FInputCommandSequence& Sequence = Command->Sequences[Random.RandHelper(Command->Sequences.Num())];
+		for (const FInputCommandEntry& Entry : Sequence.Entries)
+		{
+			uint64 Events = 0;
+			InputBuffer->ConvertEventsToFlags(Entry.EventsToMatch, Events);
+			if (Random.FRand() < 0.1f)
+			{
+				Events |= 1ULL << Random.RandHelper(ARRAY_COUNT(DifferentialEvents));
+			}
+
+			const int32 HoldFrames = Random.RandRange(1, 4);
+			for (int32 Idx = 0; Idx < HoldFrames; Idx++)
+			{
+				OutFrames.Add(Events);
+			}
+
+			const int32 NeutralFrames = Random.RandRange(0, 2);
+			for (int32 Idx = 0; Idx < NeutralFrames; Idx++)
+			{
+				OutFrames.Add(0);
+			}
+		}
+	}
+
+	/* Queues frames of random input events. */
+	void QueueNoiseFrames(FRandomStream& Random, TArray<uint64>& OutFrames)
+	{
+		const int32 NumBursts = Random.RandRange(1, 4);
+		for (int32 Burst = 0; Burst < NumBursts; Burst++)
+		{
+			uint64 Events = 0;
+			for (int32 Bit = 0; Bit < ARRAY_COUNT(DifferentialEvents); Bit++)
+			{
+				if (Random.FRand() < 0.2f)
+				{
+					Events |= 1ULL << Bit;
+				}
+			}
+
+			const int32 HoldFrames = Random.RandRange(1, 3);
+			for (int32 Idx = 0; Idx < HoldFrames; Idx++)
+			{
+				OutFrames.Add(Events);
+			}
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInputBufferDifferentialTest, "Plugins.InputBuffer.Differential", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FInputBufferDifferentialTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(20170101);
+
+	auto InputBuffer = NewObject<UInputBufferComponent>();
+	InputBuffer->bFrameIndexedSimulation = true;
+	InputBuffer->SimulationFrameRate = 60.f;
+	for (const TCHAR* Event : DifferentialEvents)
+	{
+		InputBuffer->TranslatedEvents.Add(Event);
+	}
+
+	TArray<UInputCommand*> Commands;
+	TArray<FInputCommandProgram> Programs;
+	Programs.SetNum(NUM_COMMANDS);
+
+	// Programs bound from compiled data that went through serialization, as if loaded from cooked assets.
+	TArray<FInputCommandProgram> LoadedPrograms;
+	LoadedPrograms.SetNum(NUM_COMMANDS);
+	TArray<uint8> CompiledBytes;
+
+	// All commands of a trial matched as a set at once, when the first command is queried.
+	auto CommandSet = NewObject<UInputCommandSet>();
+	TArray<UInputCommand*> SetMatches;
+
+	// Every fast path is checked against the reference matcher.
+	TArray<FDifferentialPath> Paths;
+	Paths.Add(FDifferentialPath(TEXT("MatchCommand"), [&](int32 CommandIdx)
+	{
+		return InputBuffer->MatchCommand(Commands[CommandIdx]);
+	}));
+	Paths.Add(FDifferentialPath(TEXT("InputCommandMatcher"), [&](int32 CommandIdx)
+	{
+		return FInputCommandMatcher::Match(Programs[CommandIdx], InputBuffer->GetInputHistory(), (float)InputBuffer->GetSimulationFrame(), InputBuffer->SimulationFrameRate);
+	}));
+	Paths.Add(FDifferentialPath(TEXT("LoadedInputCommand"), [&](int32 CommandIdx)
+	{
+		return FInputCommandMatcher::Match(LoadedPrograms[CommandIdx], InputBuffer->GetInputHistory(), (float)InputBuffer->GetSimulationFrame(), InputBuffer->SimulationFrameRate);
+	}));
+	Paths.Add(FDifferentialPath(TEXT("MatchAllCommands"), [&](int32 CommandIdx)
+	{
+		if (CommandIdx == 0)
+		{
+			InputBuffer->MatchAllCommands(CommandSet, SetMatches);
+		}
+		return SetMatches.Contains(Commands[CommandIdx]);
+	}));
+
+	// Commands declared in C++ are checked against their asset equivalents, which are performed now and then.
+	UInputCommand* StaticEquivalent = CreateStaticEquivalentCommand();
+	int32 NumStaticMatches = 0;
+	int32 NumStaticMismatches = 0;
+
+	uint64 ReferenceCycles = 0;
+	int32 NumEvaluations = 0;
+	int32 NumMatches = 0;
+
+	TArray<bool> Expected;
+	Expected.SetNum(NUM_COMMANDS);
+
+	TArray<bool> Actual;
+	Actual.SetNum(NUM_COMMANDS);
+
+	TArray<uint64> Frames;
+
+	for (int32 Trial = 0; Trial < NUM_TRIALS; Trial++)
+	{
+		InputBuffer->MaxInputHistory = Random.RandRange(2, 32);
+		InputBuffer->Initialize();
+
+		Commands.Reset();
+		for (int32 CommandIdx = 0; CommandIdx < NUM_COMMANDS; CommandIdx++)
+		{
+			Commands.Add(CreateRandomCommand(Random));
+			InputBuffer->CompileCommand(Commands[CommandIdx], Programs[CommandIdx]);
+
+			CompiledBytes.Reset();
+			FMemoryWriter Writer(CompiledBytes);
+			Writer << const_cast<FCompiledInputCommand&>(Commands[CommandIdx]->GetCompiledData());
+
+			FCompiledInputCommand LoadedCommand;
+			FMemoryReader Reader(CompiledBytes);
+			Reader << LoadedCommand;
+			InputBuffer->BindCommand(LoadedCommand, LoadedPrograms[CommandIdx]);
+		}
+
+		CommandSet->Commands = Commands;
+		CommandSet->InvalidateCompiledData();
+
+		Frames.Reset();
+		for (int32 Frame = 1; Frame <= NUM_FRAMES; Frame++)
+		{
+			while (Frames.Num() == 0)
+			{
+				const float Choice = Random.FRand();
+				if (Choice < 0.1f)
+				{
+					QueueCommandFrames(Random, InputBuffer, StaticEquivalent, Frames);
+				}
+				else if (Choice < 0.5f)
+				{
+					QueueCommandFrames(Random, InputBuffer, Commands[Random.RandHelper(NUM_COMMANDS)], Frames);
+				}
+				else
+				{
+					QueueNoiseFrames(Random, Frames);
+				}
+
+				Algo::Reverse(Frames); // Frames are popped from the end.
+			}
+
+			if (Random.FRand() < 0.01f)
+			{
+				InputBuffer->InvalidateHistory();
+			}
+
+			InputBuffer->SimulateFrame(Frame, Frames.Pop(false));
+
+			uint64 StartCycles = FPlatformTime::Cycles64();
+			for (int32 CommandIdx = 0; CommandIdx < NUM_COMMANDS; CommandIdx++)
+			{
+				Expected[CommandIdx] = InputBuffer->MatchCommandReference(Commands[CommandIdx]);
+			}
+			ReferenceCycles += FPlatformTime::Cycles64() - StartCycles;
+
+			for (FDifferentialPath& Path : Paths)
+			{
+				StartCycles = FPlatformTime::Cycles64();
+				for (int32 CommandIdx = 0; CommandIdx < NUM_COMMANDS; CommandIdx++)
+				{
+					Actual[CommandIdx] = Path.Match(CommandIdx);
+				}
+				Path.Cycles += FPlatformTime::Cycles64() - StartCycles;
+
+				for (int32 CommandIdx = 0; CommandIdx < NUM_COMMANDS; CommandIdx++)
+				{
+					if (Actual[CommandIdx] != Expected[CommandIdx])
+					{
+						if (Path.NumMismatches < MAX_REPORTED_MISMATCHES)
+						{
+							AddError(FString::Printf(TEXT("%s disagrees with the reference in trial %d, frame %d, command %d: expected %s."),
+								*Path.Name, Trial, Frame, CommandIdx, Expected[CommandIdx] ? TEXT("match") : TEXT("mismatch")));
+						}
+						Path.NumMismatches++;
+					}
+				}
+			}
+
+			const bool bStaticExpected = InputBuffer->MatchCommandReference(StaticEquivalent);
+			if (InputBuffer->MatchStaticCommand<FDifferentialStaticCommand>() != bStaticExpected)
+			{
+				if (NumStaticMismatches < MAX_REPORTED_MISMATCHES)
+				{
+					AddError(FString::Printf(TEXT("MatchStaticCommand disagrees with the reference in trial %d, frame %d: expected %s."),
+						Trial, Frame, bStaticExpected ? TEXT("match") : TEXT("mismatch")));
+				}
+				NumStaticMismatches++;
+			}
+			NumStaticMatches += bStaticExpected ? 1 : 0;
+
+			for (bool bMatched : Expected)
+			{
+				NumMatches += bMatched ? 1 : 0;
+			}
+			NumEvaluations += NUM_COMMANDS;
+		}
+	}
+
+	TestTrue(TEXT("Random histories should match some random commands, or the differential test covers nothing."), NumMatches > 0);
+	TestTrue(TEXT("Random histories should match the static command sometimes, or it is not covered."), NumStaticMatches > 0);
+
+	AddLogItem(FString::Printf(TEXT("%d evaluations, %d matches, %d matches of the static command."), NumEvaluations, NumMatches, NumStaticMatches));
+	AddLogItem(FString::Printf(TEXT("%-24s %8.2f M/s"), TEXT("Reference"), NumEvaluations / FPlatformTime::ToSeconds64(ReferenceCycles) / 1e6));
+	for (const FDifferentialPath& Path : Paths)
+	{
+		AddLogItem(FString::Printf(TEXT("%-24s %8.2f M/s, %d mismatches"), *Path.Name, NumEvaluations / FPlatformTime::ToSeconds64(Path.Cycles) / 1e6, Path.NumMismatches));
+	}
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -1,217 +1,885 @@
-// Copyright 2017 Isaac Hsu. MIT License
-
-#include "InputBufferEditor.h"
-#include "AutomationTest.h"
-#include "AutomationEditorCommon.h"
-#include "InputBufferComponent.h"
-#include "InputBufferPlayerController.h"
-#include "InputCommand.h"
-
-#if WITH_DEV_AUTOMATION_TESTS
-
-IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInputBufferTest, "Plugins.InputBuffer.InputBuffer", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
-
-bool FInputBufferTest::RunTest(const FString& Parameters)
-{
-	UWorld* World = FAutomationEditorCommonUtils::CreateNewMap();
-	World->Tick(LEVELTICK_All, 1.f);
-
-	auto PlayerController = World->SpawnActor<AInputBufferPlayerController>();
-	auto InputBuffer = PlayerController->InputBuffer;
-
-	// Test maximal setup of input events
-	{
-		const int32 TestSetupCount = FInputBufferRecord::MAX_EVENTS + 1;
-		InputBuffer->EventSetups.Reset(TestSetupCount);
-		for (int32 Idx = 0; Idx < TestSetupCount; Idx++)
-		{
-			int32 EventIndex = InputBuffer->EventSetups.AddDefaulted();
-			auto* Setup = &InputBuffer->EventSetups[EventIndex];
-			Setup->Name = *FString::FromInt(Idx);
-			Setup->Type = FBufferedInputEventType::Pressed;
-			Setup->Keys.Add(EKeys::LeftMouseButton);
-		}
-
-		TestTrue(FString::Printf(TEXT("The number of registered input events must be equal to or less than %d."), FInputBufferRecord::MAX_EVENTS), InputBuffer->Initialize() <= FInputBufferRecord::MAX_EVENTS);
-	}
-
-	// Test maximal setup of input events
-	{
-		InputBuffer->EventSetups.Reset(FInputBufferRecord::MAX_EVENTS);
-		for (int32 Idx = 0; Idx < FInputBufferRecord::MAX_EVENTS; Idx++)
-		{
-			int32 EventIndex = InputBuffer->EventSetups.AddDefaulted();
-			auto* Setup = &InputBuffer->EventSetups[EventIndex];
-			Setup->Name = *FString::FromInt(Idx);
-			Setup->Type = FBufferedInputEventType::Pressed;
-			Setup->Keys.Add(EKeys::LeftMouseButton);
-		}
-
-		InputBuffer->TranslatedEvents.Reset();
-		InputBuffer->TranslatedEvents.Add(TEXT("Forward"));
-		InputBuffer->TranslatedEvents.Add(TEXT("Back"));
-
-		TestTrue(FString::Printf(TEXT("The number of registered input events must be equal to or less than %d."), FInputBufferRecord::MAX_EVENTS), InputBuffer->Initialize() <= FInputBufferRecord::MAX_EVENTS);
-	}
-
-	// Set up input events
-	{
-		InputBuffer->EventSetups.Reset();
-
-		int32 Index = InputBuffer->EventSetups.AddDefaulted();
-		auto* Setup = &InputBuffer->EventSetups[Index];
-		Setup->Name = TEXT("Punch");
-		Setup->Type = FBufferedInputEventType::Pressed;
-		Setup->Keys.Add(EKeys::LeftMouseButton);
-
-		Index = InputBuffer->EventSetups.AddDefaulted();
-		Setup = &InputBuffer->EventSetups[Index];
-		Setup->Name = TEXT("Kick");
-		Setup->Type = FBufferedInputEventType::Pressed;
-		Setup->Keys.Add(EKeys::LeftMouseButton);
-
-		Index = InputBuffer->EventSetups.AddDefaulted();
-		Setup = &InputBuffer->EventSetups[Index];
-		Setup->Name = TEXT("Up");
-		Setup->Type = FBufferedInputEventType::Held;
-		Setup->Keys.Add(EKeys::Up);
-
-		Index = InputBuffer->EventSetups.AddDefaulted();
-		Setup = &InputBuffer->EventSetups[Index];
-		Setup->Name = TEXT("Down");
-		Setup->Type = FBufferedInputEventType::Held;
-		Setup->Keys.Add(EKeys::Down);
-
-		Index = InputBuffer->EventSetups.AddDefaulted();
-		Setup = &InputBuffer->EventSetups[Index];
-		Setup->Name = TEXT("Left");
-		Setup->Type = FBufferedInputEventType::Held;
-		Setup->Keys.Add(EKeys::Left);
-
-		Index = InputBuffer->EventSetups.AddDefaulted();
-		Setup = &InputBuffer->EventSetups[Index];
-		Setup->Name = TEXT("Right");
-		Setup->Type = FBufferedInputEventType::Held;
-		Setup->Keys.Add(EKeys::Right);
-
-		InputBuffer->TranslatedEvents.Reset();
-		InputBuffer->TranslatedEvents.Add(TEXT("Forward"));
-		InputBuffer->TranslatedEvents.Add(TEXT("Back"));
-
-		TestEqual(TEXT("The number of registered input events must be the same as input event set-up."), InputBuffer->Initialize(), InputBuffer->EventSetups.Num() + InputBuffer->TranslatedEvents.Num());
-	}
-
-	// Input history getter/setter
-	{
-		TArray<FInputHistoryRecord> InRecords;
-
-		int32 Index = InRecords.AddDefaulted();
-		InRecords[Index].Events.Add(TEXT("Punch"));
-		InRecords[Index].Events.Add(TEXT("Forward"));
-		InRecords[Index].TranslatedEvents.Add(TEXT("Right"));
-		InRecords[Index].StartTime = 0.8;
-		InRecords[Index].EndTime = 0.8;
-
-		Index = InRecords.AddDefaulted();
-		InRecords[Index].StartTime = 0.9;
-		InRecords[Index].EndTime = 1;
-
-		TestTrue(TEXT("Input records assignment should succeed if all input is valid."), InputBuffer->SetHistoryRecords(InRecords));
-
-		TArray<FInputHistoryRecord> OutRecords;
-		InputBuffer->GetHistoryRecords(OutRecords);
-		TestEqual(TEXT("Input history must be the same as given input records after assignment."), InRecords, OutRecords);
-
-		// Get last events
-		{
-			TArray<FName> Events;
-			TestEqual(TEXT("GetLastEvents should return the last events' end time."), InputBuffer->GetLastEvents(Events, 0.5, true), InRecords[0].EndTime);
-			TestEqual(TEXT("GetLastEvents should return the last events in the input buffer."), Events, InRecords[0].Events);
-		}
-
-		// Get last events
-		{
-			TArray<FName> Events;
-			TestEqual(TEXT("GetLastEvents should return the last events' end time."), InputBuffer->GetLastEvents(Events, 0.5, false), InRecords[1].EndTime);
-			TestEqual(TEXT("GetLastEvents should return the last events in the input buffer."), Events, InRecords[1].Events);
-		}
-
-		// Event matching
-		{
-			TArray<FName> EventsToMatch;
-			EventsToMatch.Add(TEXT("Punch"));
-
-			TestFalse(TEXT("Event matching should fail if last events mismatch."), InputBuffer->MatchEvents(EventsToMatch, TArray<FName>(), 0.5, true));
-		}
-
-		// Event matching
-		{
-			TArray<FName> EventsToMatch;
-			EventsToMatch.Add(TEXT("Punch"));
-
-			TArray<FName> EventsToIgnore;
-			EventsToIgnore.Add(TEXT("Forward"));
-
-			TestTrue(TEXT("Event matching should succeed if last events match."), InputBuffer->MatchEvents(EventsToMatch, EventsToIgnore, 0.5, true));
-		}
-	}
-
-	// Input history assignment with an unknown event
-	{
-		TArray<FInputHistoryRecord> InRecords;
-
-		int32 Index = InRecords.AddDefaulted();
-		InRecords[Index].Events.Add(TEXT("Punch"));
-		InRecords[Index].TranslatedEvents.Add(TEXT("Right"));
-		InRecords[Index].StartTime = 0.8;
-		InRecords[Index].EndTime = 0.8;
-
-		Index = InRecords.AddDefaulted();
-		InRecords[Index].Events.Add(TEXT("Fire"));
-		InRecords[Index].StartTime = 0.9;
-		InRecords[Index].EndTime = 1;
-
-		TestFalse(TEXT("Input records assignment should return failed if any input is invalid."), InputBuffer->SetHistoryRecords(InRecords));
-	}
-
-	TestFalse(TEXT("Command recognition should fail if given input command is NULL."), InputBuffer->MatchCommand(nullptr));
-
-	// Post-conditions after invalidation
-	{
-		TArray<FInputHistoryRecord> BeforeRecords;
-		InputBuffer->GetHistoryRecords(BeforeRecords, 0, true);
-
-		InputBuffer->InvalidateHistory();
-
-		TArray<FInputHistoryRecord> AfterRecords;
-		InputBuffer->GetHistoryRecords(AfterRecords, 0, true);
-
-		TestEqual(TEXT("The number of input history must be the same after invalidation."), BeforeRecords.Num(), AfterRecords.Num());
-
-		for (const auto& Record : AfterRecords)
-		{
-			TestFalse(TEXT("Input records must be invalid after invalidation."), Record.bValid);
-		}
-	}
-
-	// Post-conditions after clearance
-	{
-		InputBuffer->ClearHistory();
-
-		TArray<FInputHistoryRecord> Records;
-		InputBuffer->GetHistoryRecords(Records);
-		TestEqual(TEXT("The number of input history must be zero after clearance."), Records.Num(), 0);
-
-		auto InputCommand = NewObject<UInputCommand>();
-		InputCommand->Sequences.AddDefaulted();
-		InputCommand->Sequences[0].Entries.AddDefaulted();
-		InputCommand->Sequences[0].Entries[0].EventsToMatch.Add(TEXT("Punch"));
-		InputCommand->Sequences[0].Entries[0].EventsToIgnore.Add(TEXT("Kick"));
-
-		TestFalse(TEXT("Command recognition should fail if input history is empty."), InputBuffer->MatchCommand(InputCommand));
-	}
-
-	return true;
-}
-
+// Copyright 2017 Isaac Hsu. MIT License
+
+#include "InputBufferEditor.h"
+#include "AutomationTest.h"
+#include "AutomationEditorCommon.h"
+#include "InputBufferComponent.h"
+#include "InputHistoryPool.h"
+#include "InputBufferPlayerController.h"
+#include "InputCommand.h"
+#include "InputCommandSet.h"
+#include "InputBufferSnapshot.h"
+#include "InputBufferPlayback.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInputBufferTest, "Plugins.InputBuffer.InputBuffer", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FInputBufferTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = FAutomationEditorCommonUtils::CreateNewMap();
+	World->Tick(LEVELTICK_All, 1.f);
+
+	auto PlayerController = World->SpawnActor<AInputBufferPlayerController>();
+	auto InputBuffer = PlayerController->InputBuffer;
+
+	// Test maximal setup of input events
+	{
+		const int32 TestSetupCount = FInputBufferRecord::MAX_EVENTS + 1;
+		InputBuffer->EventSetups.Reset(TestSetupCount);
+		for (int32 Idx = 0; Idx < TestSetupCount; Idx++)
+		{
+			int32 EventIndex = InputBuffer->EventSetups.AddDefaulted();
+			auto* Setup = &InputBuffer->EventSetups[EventIndex];
+			Setup->Name = *FString::FromInt(Idx);
+			Setup->Type = FBufferedInputEventType::Pressed;
+			Setup->Keys.Add(EKeys::LeftMouseButton);
+		}
+
+		TestTrue(FString::Printf(TEXT("The number of registered input events must be equal to or less than %d."), FInputBufferRecord::MAX_EVENTS), InputBuffer->Initialize() <= FInputBufferRecord::MAX_EVENTS);
+	}
+
+	// Test maximal setup of input events
+	{
+		InputBuffer->EventSetups.Reset(FInputBufferRecord::MAX_EVENTS);
+		for (int32 Idx = 0; Idx < FInputBufferRecord::MAX_EVENTS; Idx++)
+		{
+			int32 EventIndex = InputBuffer->EventSetups.AddDefaulted();
+			auto* Setup = &InputBuffer->EventSetups[EventIndex];
+			Setup->Name = *FString::FromInt(Idx);
+			Setup->Type = FBufferedInputEventType::Pressed;
+			Setup->Keys.Add(EKeys::LeftMouseButton);
+		}
+
+		InputBuffer->TranslatedEvents.Reset();
+		InputBuffer->TranslatedEvents.Add(TEXT("Forward"));
+		InputBuffer->TranslatedEvents.Add(TEXT("Back"));
+
+		TestTrue(FString::Printf(TEXT("The number of registered input events must be equal to or less than %d."), FInputBufferRecord::MAX_EVENTS), InputBuffer->Initialize() <= FInputBufferRecord::MAX_EVENTS);
+	}
+
+	// Set up input events
+	{
+		InputBuffer->EventSetups.Reset();
+
+		int32 Index = InputBuffer->EventSetups.AddDefaulted();
+		auto* Setup = &InputBuffer->EventSetups[Index];
+		Setup->Name = TEXT("Punch");
+		Setup->Type = FBufferedInputEventType::Pressed;
+		Setup->Keys.Add(EKeys::LeftMouseButton);
+
+		Index = InputBuffer->EventSetups.AddDefaulted();
+		Setup = &InputBuffer->EventSetups[Index];
+		Setup->Name = TEXT("Kick");
+		Setup->Type = FBufferedInputEventType::Pressed;
+		Setup->Keys.Add(EKeys::LeftMouseButton);
+
+		Index = InputBuffer->EventSetups.AddDefaulted();
+		Setup = &InputBuffer->EventSetups[Index];
+		Setup->Name = TEXT("Up");
+		Setup->Type = FBufferedInputEventType::Held;
+		Setup->Keys.Add(EKeys::Up);
+
+		Index = InputBuffer->EventSetups.AddDefaulted();
+		Setup = &InputBuffer->EventSetups[Index];
+		Setup->Name = TEXT("Down");
+		Setup->Type = FBufferedInputEventType::Held;
+		Setup->Keys.Add(EKeys::Down);
+
+		Index = InputBuffer->EventSetups.AddDefaulted();
+		Setup = &InputBuffer->EventSetups[Index];
+		Setup->Name = TEXT("Left");
+		Setup->Type = FBufferedInputEventType::Held;
+		Setup->Keys.Add(EKeys::Left);
+
+		Index = InputBuffer->EventSetups.AddDefaulted();
+		Setup = &InputBuffer->EventSetups[Index];
+		Setup->Name = TEXT("Right");
+		Setup->Type = FBufferedInputEventType::Held;
+		Setup->Keys.Add(EKeys::Right);
+
+		InputBuffer->TranslatedEvents.Reset();
+		InputBuffer->TranslatedEvents.Add(TEXT("Forward"));
+		InputBuffer->TranslatedEvents.Add(TEXT("Back"));
+
+		TestEqual(TEXT("The number of registered input events must be the same as input event set-up."), InputBuffer->Initialize(), InputBuffer->EventSetups.Num() + InputBuffer->TranslatedEvents.Num());
+	}
+
+	// Memory accounting
+	{
+		const SIZE_T HistorySize = InputBuffer->MaxInputHistory * sizeof(FInputBufferRecord);
+		TestTrue(TEXT("Resource size of an input buffer must include its input history."), InputBuffer->GetResourceSizeBytes(EResourceSizeMode::Exclusive) >= HistorySize);
+	}
+
+	// Input history getter/setter
+	{
+		TArray<FInputHistoryRecord> InRecords;
+
+		int32 Index = InRecords.AddDefaulted();
+		InRecords[Index].Events.Add(TEXT("Punch"));
+		InRecords[Index].Events.Add(TEXT("Forward"));
+		InRecords[Index].TranslatedEvents.Add(TEXT("Right"));
+		InRecords[Index].StartTime = 0.8;
+		InRecords[Index].EndTime = 0.8;
+
+		Index = InRecords.AddDefaulted();
+		InRecords[Index].StartTime = 0.9;
+		InRecords[Index].EndTime = 1;
+
+		TestTrue(TEXT("Input records assignment should succeed if all input is valid."), InputBuffer->SetHistoryRecords(InRecords));
+
+		TArray<FInputHistoryRecord> OutRecords;
+		InputBuffer->GetHistoryRecords(OutRecords);
+		TestEqual(TEXT("Input history must be the same as given input records after assignment."), InRecords, OutRecords);
+
+		// Visiting history in place
+		{
+			TArray<FInputHistoryRecord> VisitedRecords;
+			auto CopyRecord = [&](const FInputHistoryRecordView& View)
+			{
+				FInputHistoryRecord& Copy = VisitedRecords[VisitedRecords.Emplace(View.GetStartTime(), View.GetEndTime(), View.IsValid())];
+				View.GetEvents(Copy.Events);
+				View.GetTranslatedEvents(Copy.TranslatedEvents);
+				return true;
+			};
+
+			TestEqual(TEXT("All records should be visited."), InputBuffer->VisitHistory(CopyRecord, 0.f, false, false), InRecords.Num());
+			TestEqual(TEXT("Records visited in chronological order should be the same as retrieved ones."), VisitedRecords, OutRecords);
+
+			VisitedRecords.Reset();
+			InputBuffer->VisitHistory(CopyRecord);
+			Algo::Reverse(VisitedRecords);
+			TestEqual(TEXT("Records visited in reverse chronological order should be the same as retrieved ones reversed."), VisitedRecords, OutRecords);
+
+			int32 LatestIndex = INDEX_NONE;
+			TestEqual(TEXT("Visiting should stop when the visitor returns false."), InputBuffer->VisitHistory([&](const FInputHistoryRecordView& View)
+			{
+				LatestIndex = View.GetIndex();
+				return false;
+			}), 1);
+			TestEqual(TEXT("The latest record should be visited first, with index zero."), LatestIndex, 0);
+		}
+
+		// Get last events
+		{
+			TArray<FName> Events;
+			TestEqual(TEXT("GetLastEvents should return the last events' end time."), InputBuffer->GetLastEvents(Events, 0.5, true), InRecords[0].EndTime);
+			TestEqual(TEXT("GetLastEvents should return the last events in the input buffer."), Events, InRecords[0].Events);
+		}
+
+		// Get last events
+		{
+			TArray<FName> Events;
+			TestEqual(TEXT("GetLastEvents should return the last events' end time."), InputBuffer->GetLastEvents(Events, 0.5, false), InRecords[1].EndTime);
+			TestEqual(TEXT("GetLastEvents should return the last events in the input buffer."), Events, InRecords[1].Events);
+		}
+
+		// Event names of flags
+		{
+			const TArray<FName> Names = { TEXT("Kick"), TEXT("Down"), TEXT("Right"), TEXT("Back") };
+			uint64 Flags = 0;
+			InputBuffer->ConvertEventsToFlags({ TEXT("Back"), TEXT("Right"), TEXT("Kick"), TEXT("Down") }, Flags);
+
+			// Convert more distinct flags than the cache holds in between, so the names are converted again after eviction.
+			for (int32 Pass = 0; Pass < 2; Pass++)
+			{
+				TArray<FName> Events;
+				InputBuffer->ConvertFlagsToEvents(Flags, Events);
+				TestEqual(TEXT("Event names should be in order of registration."), Events, Names);
+
+				InputBuffer->ConvertFlagsToEvents(Flags, Events);
+				TestEqual(TEXT("Event names should be appended."), Events.Num(), Names.Num() * 2);
+
+				for (uint64 Others = 1; Others < 64; Others++)
+				{
+					Events.Reset();
+					InputBuffer->ConvertFlagsToEvents(Others, Events);
+				}
+			}
+		}
+
+		// Event matching
+		{
+			TArray<FName> EventsToMatch;
+			EventsToMatch.Add(TEXT("Punch"));
+
+			TestFalse(TEXT("Event matching should fail if last events mismatch."), InputBuffer->MatchEvents(EventsToMatch, TArray<FName>(), 0.5, true));
+		}
+
+		// Event matching
+		{
+			TArray<FName> EventsToMatch;
+			EventsToMatch.Add(TEXT("Punch"));
+
+			TArray<FName> EventsToIgnore;
+			EventsToIgnore.Add(TEXT("Forward"));
+
+			TestTrue(TEXT("Event matching should succeed if last events match."), InputBuffer->MatchEvents(EventsToMatch, EventsToIgnore, 0.5, true));
+		}
+
+		// Event matching with resolved masks
+		{
+			const FBufferedInputEventMask Mask = InputBuffer->MakeEventMask({ TEXT("Punch") }, { TEXT("Forward") });
+			TestTrue(TEXT("A mask should be current for the input buffer it is resolved against."), InputBuffer->IsEventMaskCurrent(Mask));
+			TestTrue(TEXT("Matching a mask should be the same as matching its input events."), InputBuffer->MatchEvents(Mask, 0.5, true));
+			TestFalse(TEXT("A mask should mismatch if input events to ignore are not ignored."), InputBuffer->MatchEvents(InputBuffer->MakeEventMask({ TEXT("Punch") }, TArray<FName>()), 0.5, true));
+
+			FBufferedInputEventMask LastEvents;
+			TestEqual(TEXT("GetLastEvents should return the last events' end time."), InputBuffer->GetLastEvents(LastEvents, 0.5, true), InRecords[0].EndTime);
+			TestTrue(TEXT("The last events as a mask should match the last record."), InputBuffer->IsEventMaskCurrent(LastEvents) && InputBuffer->MatchEvents(LastEvents, 0.5, true));
+
+			TestFalse(TEXT("A mask that was never resolved should not be current."), InputBuffer->IsEventMaskCurrent(FBufferedInputEventMask()));
+
+			auto OtherBuffer = NewObject<UInputBufferComponent>();
+			OtherBuffer->TranslatedEvents.Add(TEXT("Punch"));
+			OtherBuffer->Initialize();
+			TestFalse(TEXT("A mask should be stale for another input buffer."), OtherBuffer->IsEventMaskCurrent(Mask));
+
+			const FBufferedInputEventMask OtherMask = OtherBuffer->MakeEventMask({ TEXT("Punch") }, TArray<FName>());
+			OtherBuffer->Initialize();
+			TestFalse(TEXT("A mask should be stale after the input buffer is initialized again."), OtherBuffer->IsEventMaskCurrent(OtherMask));
+		}
+
+		// Snapshot round trip
+		{
+			FInputBufferSnapshotRing Snapshots;
+			Snapshots.Init(InputBuffer, 8);
+			Snapshots.Save(InputBuffer, 3);
+
+			InputBuffer->ClearHistory();
+
+			TestFalse(TEXT("Restoring a frame that has not been saved should fail."), Snapshots.Restore(InputBuffer, 11));
+			TestTrue(TEXT("Restoring a saved frame should succeed."), Snapshots.Restore(InputBuffer, 3));
+
+			TArray<FInputHistoryRecord> RestoredRecords;
+			InputBuffer->GetHistoryRecords(RestoredRecords);
+			TestEqual(TEXT("Input history must be the same as the saved one after restoration."), InRecords, RestoredRecords);
+		}
+
+		// Snapshots after the capacity changes
+		{
+			auto SnapshotBuffer = NewObject<UInputBufferComponent>();
+			SnapshotBuffer->TranslatedEvents.Add(TEXT("Punch"));
+			SnapshotBuffer->MaxInputHistory = 4;
+			SnapshotBuffer->Initialize();
+
+			FInputBufferSnapshotRing Snapshots;
+			Snapshots.Init(SnapshotBuffer, 4);
+			Snapshots.Save(SnapshotBuffer, 1);
+
+			SnapshotBuffer->MaxInputHistory = 8;
+			SnapshotBuffer->Reinitialize();
+			Snapshots.Save(SnapshotBuffer, 2);
+			TestTrue(TEXT("Saving after the capacity changes should drop frames saved before and keep the new one."), !Snapshots.Contains(1) && Snapshots.Restore(SnapshotBuffer, 2));
+
+			// Registering another event keeps the snapshot size but changes the meaning of event bits.
+			TArray<uint8> Snapshot;
+			Snapshot.SetNumUninitialized(SnapshotBuffer->GetSnapshotSize());
+			SnapshotBuffer->SaveSnapshot(Snapshot.GetData());
+			SnapshotBuffer->TranslatedEvents.Insert(TEXT("Kick"), 0);
+			SnapshotBuffer->Reinitialize();
+			TestTrue(TEXT("A snapshot of another event layout should be rejected even if its size matches."), Snapshot.Num() == SnapshotBuffer->GetSnapshotSize() && !SnapshotBuffer->RestoreSnapshot(Snapshot.GetData()));
+		}
+	}
+
+	// Input history assignment with an unknown event
+	{
+		TArray<FInputHistoryRecord> InRecords;
+
+		int32 Index = InRecords.AddDefaulted();
+		InRecords[Index].Events.Add(TEXT("Punch"));
+		InRecords[Index].TranslatedEvents.Add(TEXT("Right"));
+		InRecords[Index].StartTime = 0.8;
+		InRecords[Index].EndTime = 0.8;
+
+		Index = InRecords.AddDefaulted();
+		InRecords[Index].Events.Add(TEXT("Fire"));
+		InRecords[Index].StartTime = 0.9;
+		InRecords[Index].EndTime = 1;
+
+		TestFalse(TEXT("Input records assignment should return failed if any input is invalid."), InputBuffer->SetHistoryRecords(InRecords));
+	}
+
+	TestFalse(TEXT("Command recognition should fail if given input command is NULL."), InputBuffer->MatchCommand(nullptr));
+
+	// Post-conditions after invalidation
+	{
+		TArray<FInputHistoryRecord> BeforeRecords;
+		InputBuffer->GetHistoryRecords(BeforeRecords, 0, true);
+
+		InputBuffer->InvalidateHistory();
+
+		TArray<FInputHistoryRecord> AfterRecords;
+		InputBuffer->GetHistoryRecords(AfterRecords, 0, true);
+
+		TestEqual(TEXT("The number of input history must be the same after invalidation."), BeforeRecords.Num(), AfterRecords.Num());
+
+		for (const auto& Record : AfterRecords)
+		{
+			TestFalse(TEXT("Input records must be invalid after invalidation."), Record.bValid);
+		}
+	}
+
+	// Post-conditions after clearance
+	{
+		InputBuffer->ClearHistory();
+
+		TArray<FInputHistoryRecord> Records;
+		InputBuffer->GetHistoryRecords(Records);
+		TestEqual(TEXT("The number of input history must be zero after clearance."), Records.Num(), 0);
+
+		auto InputCommand = NewObject<UInputCommand>();
+		InputCommand->Sequences.AddDefaulted();
+		InputCommand->Sequences[0].Entries.AddDefaulted();
+		InputCommand->Sequences[0].Entries[0].EventsToMatch.Add(TEXT("Punch"));
+		InputCommand->Sequences[0].Entries[0].EventsToIgnore.Add(TEXT("Kick"));
+
+		TestFalse(TEXT("Command recognition should fail if input history is empty."), InputBuffer->MatchCommand(InputCommand));
+	}
+
+	// Frame-indexed simulation
+	{
+		InputBuffer->bFrameIndexedSimulation = true;
+		InputBuffer->SimulationFrameRate = 60.f;
+		InputBuffer->ClearHistory();
+
+		auto InputCommand = NewObject<UInputCommand>();
+		InputCommand->Sequences.AddDefaulted();
+		InputCommand->Sequences[0].Entries.AddDefaulted(2);
+		InputCommand->Sequences[0].Entries[0].EventsToMatch.Add(TEXT("Down"));
+		InputCommand->Sequences[0].Entries[0].MaxInterval = 0.1f; // 6 frames
+		InputCommand->Sequences[0].Entries[1].EventsToMatch.Add(TEXT("Punch"));
+
+		TArray<FName> Down;
+		Down.Add(TEXT("Down"));
+
+		TArray<FName> Punch;
+		Punch.Add(TEXT("Punch"));
+
+		InputBuffer->SimulateFrameEvents(1, Down);
+		InputBuffer->SimulateFrameEvents(2, Down);
+		InputBuffer->SimulateFrameEvents(3, TArray<FName>());
+		InputBuffer->SimulateFrameEvents(4, Punch);
+
+		TestEqual(TEXT("The current time must be the last simulated frame in frame-indexed simulation."), InputBuffer->GetSimulationFrame(), 4);
+		TestTrue(TEXT("Command recognition should succeed if the interval in frames is within the limit."), InputBuffer->MatchCommand(InputCommand));
+
+		// Compiled data round trip
+		{
+			TArray<uint8> Bytes;
+			FMemoryWriter Writer(Bytes);
+			Writer << const_cast<FCompiledInputCommand&>(InputCommand->GetCompiledData());
+
+			FCompiledInputCommand LoadedCommand;
+			FMemoryReader Reader(Bytes);
+			Reader << LoadedCommand;
+
+			FInputCommandProgram Program;
+			InputBuffer->BindCommand(LoadedCommand, Program);
+			TestTrue(TEXT("Loaded compiled data should match the same as the input command."),
+				FInputCommandMatcher::Match(Program, InputBuffer->GetInputHistory(), (float)InputBuffer->GetSimulationFrame(), InputBuffer->SimulationFrameRate));
+
+			InputCommand->Sequences[0].Entries[1].EventsToMatch[0] = TEXT("Unknown");
+			InputCommand->InvalidateCompiledData();
+			TestFalse(TEXT("Command recognition should use the modified command after its compiled data is invalidated."), InputBuffer->MatchCommand(InputCommand));
+
+			InputCommand->Sequences[0].Entries[1].EventsToMatch[0] = TEXT("Punch");
+			InputCommand->InvalidateCompiledData();
+			TestTrue(TEXT("Command recognition should succeed again after the command is restored."), InputBuffer->MatchCommand(InputCommand));
+		}
+
+		// Input command sets
+		{
+			auto UnknownCommand = NewObject<UInputCommand>();
+			UnknownCommand->Sequences.AddDefaulted();
+			UnknownCommand->Sequences[0].Entries.AddDefaulted();
+			UnknownCommand->Sequences[0].Entries[0].EventsToMatch.Add(TEXT("Unknown"));
+
+			auto CommandSet = NewObject<UInputCommandSet>();
+			CommandSet->Commands.Add(UnknownCommand);
+			CommandSet->Commands.Add(nullptr);
+			CommandSet->Commands.Add(InputCommand);
+			InputBuffer->BindCommandSet(CommandSet);
+
+			TestTrue(TEXT("The matching command with the highest priority should be returned."), InputBuffer->MatchCommandSet(CommandSet) == InputCommand);
+
+			TArray<UInputCommand*> MatchedCommands;
+			TestTrue(TEXT("All matching commands should be found."), InputBuffer->MatchAllCommands(CommandSet, MatchedCommands) && MatchedCommands.Num() == 1 && MatchedCommands[0] == InputCommand);
+
+			CommandSet->Commands.Insert(InputCommand, 0);
+			CommandSet->InvalidateCompiledData();
+			TestTrue(TEXT("Matching commands should be returned in order of priority."), InputBuffer->MatchAllCommands(CommandSet, MatchedCommands) && MatchedCommands.Num() == 2);
+
+			CommandSet->Commands.Reset();
+			CommandSet->InvalidateCompiledData();
+			TestNull(TEXT("An empty command set should never match."), InputBuffer->MatchCommandSet(CommandSet));
+		}
+
+		// Automatic history sizing
+		{
+			auto LongCommand = NewObject<UInputCommand>();
+			LongCommand->Sequences.AddDefaulted();
+			for (int32 Idx = 0; Idx < 6; Idx++)
+			{
+				auto& Entry = LongCommand->Sequences[0].Entries[LongCommand->Sequences[0].Entries.AddDefaulted()];
+				Entry.EventsToMatch.Add(Idx % 2 ? TEXT("Down") : TEXT("Punch"));
+			}
+
+			auto CommandSet = NewObject<UInputCommandSet>();
+			CommandSet->Commands.Add(LongCommand);
+			TestEqual(TEXT("Each entry should need a record to match and an empty record after it."), CommandSet->GetCompiledData().GetMinHistoryRecords(60.f), 12);
+
+			// A held button tolerating other events, e.g. a charge, is spread over as many records as other events toggle.
+			auto ChargeCommand = NewObject<UInputCommand>();
+			ChargeCommand->Sequences.AddDefaulted();
+			ChargeCommand->Sequences[0].Entries.AddDefaulted(2);
+			auto& Charge = ChargeCommand->Sequences[0].Entries[0];
+			Charge.EventsToMatch.Add(TEXT("Down"));
+			Charge.bIgnoreOthers = true;
+			auto& Release = ChargeCommand->Sequences[0].Entries[1];
+			Release.EventsToMatch.Add(TEXT("Punch"));
+			Release.bIgnoreOthers = true;
+			ChargeCommand->InvalidateCompiledData();
+			TestEqual(TEXT("A tolerant entry without a maximal duration should be unbounded."), ChargeCommand->GetCompiledData().GetMinHistoryRecords(60.f), (int32)INDEX_NONE);
+
+			// Records over the release's ten frames, over the charge's six frames and one beyond, and an empty record after each entry.
+			Release.MaxDuration = 10.f / 60.f;
+			Charge.MaxDuration = 0.1f;
+			ChargeCommand->InvalidateCompiledData();
+			TestEqual(TEXT("Maximal durations should bound tolerant entries in frames."), ChargeCommand->GetCompiledData().GetMinHistoryRecords(60.f), 11 + 8 + 2);
+			TestEqual(TEXT("Tolerant entries should be unbounded in seconds."), ChargeCommand->GetCompiledData().GetMinHistoryRecords(0.f), (int32)INDEX_NONE);
+
+			ChargeCommand->TimeLimit = 0.05f;
+			ChargeCommand->InvalidateCompiledData();
+			TestEqual(TEXT("The time limit should bound all but the older records of the first entry."), ChargeCommand->GetCompiledData().GetMinHistoryRecords(60.f), 4 + 7);
+
+			auto SizedBuffer = NewObject<UInputBufferComponent>();
+			SizedBuffer->TranslatedEvents.Add(TEXT("Down"));
+			SizedBuffer->TranslatedEvents.Add(TEXT("Punch"));
+			SizedBuffer->MaxInputHistory = 2;
+			SizedBuffer->bAutoSizeHistory = true;
+			SizedBuffer->bFrameIndexedSimulation = true;
+			SizedBuffer->Initialize();
+
+			SizedBuffer->SimulateFrameEvents(1, Down);
+			SizedBuffer->SimulateFrameEvents(2, Punch);
+			SizedBuffer->BindCommandSet(CommandSet);
+
+			TestEqual(TEXT("Binding a command set should grow the capacity to the minimum needed."), SizedBuffer->GetHistoryCapacity(), 12);
+
+			TArray<FInputHistoryRecord> Records;
+			SizedBuffer->GetHistoryRecords(Records);
+			TestEqual(TEXT("Growing the capacity should keep buffered input."), Records.Num(), 2);
+
+			for (int32 Frame = 3; Frame <= 13; Frame++)
+			{
+				SizedBuffer->SimulateFrameEvents(Frame, Frame % 2 ? Down : Punch);
+			}
+			TestTrue(TEXT("A long command should be recognized in a grown input history."), SizedBuffer->MatchCommandSet(CommandSet) == LongCommand);
+
+			SizedBuffer->Initialize();
+			TestEqual(TEXT("The grown capacity should be kept when the input buffer is initialized again."), SizedBuffer->GetHistoryCapacity(), 12);
+		}
+
+		// Automatic history sizing with translated events
+		{
+			// Down, then Punch within six frames.
+			auto PressCommand = NewObject<UInputCommand>();
+			PressCommand->TimeLimit = 0.1f;
+			PressCommand->Sequences.AddDefaulted();
+			PressCommand->Sequences[0].Entries.AddDefaulted(2);
+			PressCommand->Sequences[0].Entries[0].EventsToMatch.Add(TEXT("Down"));
+			PressCommand->Sequences[0].Entries[1].EventsToMatch.Add(TEXT("Punch"));
+
+			auto PressSet = NewObject<UInputCommandSet>();
+			PressSet->Commands.Add(PressCommand);
+			TestEqual(TEXT("Records of entries that tolerate nothing should be merged without translated events."), PressSet->GetCompiledData().GetMinHistoryRecords(60.f), 4);
+
+			// Records that differ only in translated events are not merged, whether they match an entry or are empty.
+			TestEqual(TEXT("Every frame in the time limit may need a record with translated events."), PressSet->GetCompiledData().GetMinHistoryRecords(60.f, nullptr, true), 7);
+
+			PressCommand->SetTimeLimit(0.f);
+			TestEqual(TEXT("A command without a time limit should be unbounded with translated events."), PressSet->GetCompiledData().GetMinHistoryRecords(60.f, nullptr, true), (int32)INDEX_NONE);
+			PressCommand->SetTimeLimit(0.1f);
+
+			auto TranslatedBuffer = NewObject<UInputBufferComponent>();
+			TranslatedBuffer->TranslatedEvents.Add(TEXT("Down"));
+			TranslatedBuffer->TranslatedEvents.Add(TEXT("Punch"));
+			TranslatedBuffer->MaxInputHistory = 2;
+			TranslatedBuffer->bAutoSizeHistory = true;
+			TranslatedBuffer->bFrameIndexedSimulation = true;
+			TranslatedBuffer->Initialize();
+			TranslatedBuffer->BindCommandSet(PressSet);
+			TestEqual(TEXT("A command set should need as few records as without translated events until they are seen."), TranslatedBuffer->GetHistoryCapacity(), 4);
+
+			// Down held over two frames and released over three, each translated differently from the previous frame.
+			const uint64 DownFlag = 1 << 0;
+			const uint64 PunchFlag = 1 << 1;
+			TranslatedBuffer->SimulateFrame(1, DownFlag, PunchFlag);
+			TranslatedBuffer->SimulateFrame(2, DownFlag, 0);
+			TranslatedBuffer->SimulateFrame(3, 0, DownFlag);
+			TranslatedBuffer->SimulateFrame(4, 0, PunchFlag);
+			TranslatedBuffer->SimulateFrame(5, 0, DownFlag);
+			TranslatedBuffer->SimulateFrame(6, PunchFlag, 0);
+
+			TestEqual(TEXT("Records differing in translated events should not be merged."), TranslatedBuffer->GetInputHistory().Num(), 6);
+			TestEqual(TEXT("The first record with translated events should grow the capacity for bound command sets."), TranslatedBuffer->GetHistoryCapacity(), 7);
+			TestTrue(TEXT("A command spread over unmerged records should be recognized in the grown input history."), TranslatedBuffer->MatchCommandSet(PressSet) == PressCommand);
+		}
+
+		InputBuffer->ClearHistory();
+		InputBuffer->SimulateFrameEvents(1, Down);
+		for (int32 Frame = 2; Frame < 20; Frame++)
+		{
+			InputBuffer->SimulateFrameEvents(Frame, TArray<FName>());
+		}
+		InputBuffer->SimulateFrameEvents(20, Punch);
+
+		TestFalse(TEXT("Command recognition should fail if the interval in frames exceeds the limit."), InputBuffer->MatchCommand(InputCommand));
+
+		// Consuming matched input
+		{
+			InputBuffer->ClearHistory();
+			InputBuffer->SimulateFrameEvents(1, Down);
+			InputBuffer->SimulateFrameEvents(2, Punch);
+
+			FInputCommandMatchResult Result;
+			TestTrue(TEXT("Command recognition should fill in where the command matches."), InputBuffer->MatchCommandWithResult(InputCommand, Result) && Result.StartTime == 1.f && Result.EndTime == 2.f);
+
+			InputBuffer->ConsumeHistory(Result);
+			TestFalse(TEXT("Command recognition should fail after the matched input is consumed."), InputBuffer->MatchCommand(InputCommand));
+
+			InputBuffer->SimulateFrameEvents(3, TArray<FName>());
+			InputBuffer->SimulateFrameEvents(4, Down);
+			InputBuffer->InvalidateHistoryFrom(1);
+			InputBuffer->SimulateFrameEvents(5, Punch);
+			TestTrue(TEXT("Input after the invalidated records should stay valid."), InputBuffer->MatchCommand(InputCommand));
+
+			TArray<FInputHistoryRecord> Records;
+			InputBuffer->GetHistoryRecords(Records);
+			TestEqual(TEXT("Only records after the invalidated ones should be valid."), Records.Num(), 2);
+		}
+
+		// Replay round trip
+		{
+			const FString Filename = FPaths::AutomationTransientDir() / TEXT("InputBufferTest.replay");
+
+			InputBuffer->ClearHistory();
+			TestTrue(TEXT("Recording should start if the replay file can be opened."), InputBuffer->StartRecording(Filename));
+
+			InputBuffer->SimulateFrameEvents(1, Down);
+			InputBuffer->SimulateFrameEvents(2, Down);
+			InputBuffer->SimulateFrameEvents(3, TArray<FName>());
+			InputBuffer->SimulateFrameEvents(4, Punch);
+			InputBuffer->SimulateFrameEvents(5, TArray<FName>());
+
+			// Consumed input is recorded too.
+			FInputCommandMatchResult Result;
+			InputBuffer->SimulateFrameEvents(6, Down);
+			InputBuffer->SimulateFrameEvents(7, Punch);
+			InputBuffer->MatchCommandWithResult(InputCommand, Result);
+			InputBuffer->ConsumeHistory(Result);
+			InputBuffer->SimulateFrameEvents(8, TArray<FName>());
+			InputBuffer->StopRecording();
+
+			TArray<FInputHistoryRecord> RecordedRecords;
+			InputBuffer->GetHistoryRecords(RecordedRecords, 0, true);
+
+			FInputBufferPlayback Playback;
+			TestTrue(TEXT("A recorded replay should be opened for playback."), Playback.Open(Filename));
+
+			auto ReplayBuffer = NewObject<UInputBufferComponent>();
+			Playback.InitializeInputBuffer(ReplayBuffer);
+
+			TArray<UInputCommand*> Commands;
+			Commands.Add(InputCommand);
+
+			TArray<FInputBufferPlaybackMatch> Matches;
+			TestEqual(TEXT("All recorded records should be played back."), Playback.Play(ReplayBuffer, Commands, Matches), RecordedRecords.Num());
+
+			TArray<FInputHistoryRecord> PlayedRecords;
+			ReplayBuffer->GetHistoryRecords(PlayedRecords, 0, true);
+			TestEqual(TEXT("Input history must be the same as the recorded one after playback."), RecordedRecords, PlayedRecords);
+
+			TestTrue(TEXT("Input commands should be recognized during playback."), Matches.Num() > 0 && Matches[0].RecordIndex == 2);
+
+			Playback.Close();
+			IFileManager::Get().Delete(*Filename);
+		}
+
+		// Replay across snapshot restoration
+		{
+			const FString Filename = FPaths::AutomationTransientDir() / TEXT("InputBufferRollBackTest.replay");
+
+			InputBuffer->ClearHistory();
+			TestTrue(TEXT("Recording should start if the replay file can be opened."), InputBuffer->StartRecording(Filename));
+
+			InputBuffer->SimulateFrameEvents(1, Down);
+			InputBuffer->SimulateFrameEvents(2, Punch);
+			InputBuffer->SimulateFrameEvents(3, TArray<FName>());
+
+			TArray<uint8> Snapshot;
+			Snapshot.SetNumUninitialized(InputBuffer->GetSnapshotSize());
+			InputBuffer->SaveSnapshot(Snapshot.GetData());
+
+			// Mispredicted input, which the restoration undoes along with its invalidation.
+			InputBuffer->SimulateFrameEvents(4, Down);
+			InputBuffer->SimulateFrameEvents(5, Down);
+			InputBuffer->SimulateFrameEvents(6, Punch);
+			InputBuffer->InvalidateHistory();
+
+			TestTrue(TEXT("Restoring a snapshot while recording should succeed."), InputBuffer->RestoreSnapshot(Snapshot.GetData()));
+			InputBuffer->SimulateFrameEvents(4, Punch);
+			InputBuffer->SimulateFrameEvents(5, TArray<FName>());
+			InputBuffer->StopRecording();
+
+			TArray<FInputHistoryRecord> RecordedRecords;
+			InputBuffer->GetHistoryRecords(RecordedRecords, 0, true);
+
+			FInputBufferPlayback Playback;
+			TestTrue(TEXT("A replay with a rollback should be opened for playback."), Playback.Open(Filename));
+
+			auto ReplayBuffer = NewObject<UInputBufferComponent>();
+			Playback.InitializeInputBuffer(ReplayBuffer);
+
+			TArray<FInputBufferPlaybackMatch> Matches;
+			TestTrue(TEXT("A replay with a rollback should be played back."), Playback.Play(ReplayBuffer, TArray<UInputCommand*>(), Matches) != INDEX_NONE);
+
+			TArray<FInputHistoryRecord> PlayedRecords;
+			ReplayBuffer->GetHistoryRecords(PlayedRecords, 0, true);
+			TestEqual(TEXT("Records written since the snapshot should be removed in playback, with validity as restored."), RecordedRecords, PlayedRecords);
+
+			TArray<FInputHistoryRecord> ValidRecords;
+			ReplayBuffer->GetHistoryRecords(ValidRecords);
+			TestEqual(TEXT("Records invalidated after the snapshot should be valid again in playback."), ValidRecords.Num(), RecordedRecords.Num());
+
+			Playback.Close();
+			IFileManager::Get().Delete(*Filename);
+		}
+
+		InputBuffer->bFrameIndexedSimulation = false;
+	}
+
+	// Frame counter clock
+	{
+		auto FrameBuffer = NewObject<UInputBufferComponent>();
+		FrameBuffer->TranslatedEvents.Add(TEXT("Punch"));
+		FrameBuffer->SetClockSource(EInputBufferClockSource::FrameCounter);
+		FrameBuffer->SimulationFrameRate = 60.f;
+		FrameBuffer->Initialize();
+
+		TArray<FInputHistoryRecord> Records;
+		int32 Index = Records.AddDefaulted();
+		Records[Index].Events.Add(TEXT("Punch"));
+		Records[Index].StartTime = Records[Index].EndTime = (float)GFrameCounter - 30.f;
+		FrameBuffer->SetHistoryRecords(Records);
+
+		TArray<FName> Events;
+		TestEqual(TEXT("Time limits should be measured in engine frames with the frame counter clock."), FrameBuffer->GetLastEvents(Events, 1.f), Records[0].EndTime);
+		TestEqual(TEXT("A record older than the time limit in engine frames should be excluded."), FrameBuffer->GetLastEvents(Events, 0.25f), 0.f);
+	}
+
+	// Pooled input history storage
+	{
+		FInputHistoryPool& Pool = FInputHistoryPool::Get();
+		Pool.Empty();
+
+		TArray<FInputBufferRecord> Storage;
+		Pool.Acquire(16, Storage);
+		TestTrue(TEXT("Acquired storage should be empty and fit the capacity."), Storage.Num() == 0 && Storage.Max() >= 16);
+
+		const FInputBufferRecord* Allocation = Storage.GetData();
+		Pool.Release(Storage);
+		TestTrue(TEXT("Released storage should be pooled and left without allocation."), Pool.GetNumPooledRecords() > 0 && Storage.Max() == 0);
+
+		Pool.Acquire(12, Storage);
+		TestTrue(TEXT("Pooled storage that fits should be reused."), Storage.GetData() == Allocation && Pool.GetNumPooledRecords() == 0);
+
+		Pool.Release(Storage);
+		Pool.Acquire(4, Storage);
+		TestTrue(TEXT("Pooled storage much larger than needed should not be reused."), Storage.GetData() != Allocation && Pool.GetNumPooledRecords() > 0);
+
+		Pool.Release(Storage);
+		Pool.Empty();
+	}
+
+	// Input history retained by time, driven by played back records
+	{
+		auto RetainingBuffer = NewObject<UInputBufferComponent>();
+		RetainingBuffer->TranslatedEvents.Add(TEXT("Punch"));
+		RetainingBuffer->MaxInputHistory = 4;
+		RetainingBuffer->HistoryRetention = 1.f;
+		RetainingBuffer->MaxRetainedHistory = 16;
+		RetainingBuffer->Initialize();
+		RetainingBuffer->BeginPlayback(0.f);
+
+		const FInputBufferHistory& History = RetainingBuffer->GetInputHistory();
+
+		// A burst of 40 records within one second, alternating events so that none are merged.
+		FInputBufferRecord Record;
+		Record.bValid = true;
+		int32 MaxCapacity = 0;
+		for (int32 Idx = 0; Idx < 40; Idx++)
+		{
+			Record.Events = Idx % 2;
+			Record.StartTime = Record.EndTime = Idx * 0.02f;
+			RetainingBuffer->PlaybackRecord(Record);
+			MaxCapacity = FMath::Max(MaxCapacity, History.Max());
+		}
+
+		TestTrue(TEXT("Input history should grow during a burst within the retention window."), History.Max() > 4 && History.Num() == History.Max());
+		TestEqual(TEXT("Input history should never grow beyond MaxRetainedHistory."), MaxCapacity, 16);
+
+		// An idle second later, the burst is out of the window.
+		Record.Events = 1;
+		Record.StartTime = Record.EndTime = 10.f;
+		RetainingBuffer->PlaybackRecord(Record);
+		TestTrue(TEXT("Input history should shrink back to its capacity when idle."), History.Max() == 4 && History.Num() == 4 && History.LastOrNull()->EndTime == 10.f);
+
+		const FInputBufferRecord* Storage = History.GetData();
+		Record.Events = 0;
+		Record.StartTime = Record.EndTime = 20.f;
+		RetainingBuffer->PlaybackRecord(Record);
+		TestTrue(TEXT("Idle input history at its capacity should keep its storage."), History.Max() == 4 && History.GetData() == Storage);
+
+		RetainingBuffer->EndPlayback();
+		FInputHistoryPool::Get().Empty();
+	}
+
+	// Registering input events again without clearing the input buffer
+	{
+		auto RebindBuffer = NewObject<UInputBufferComponent>();
+		RebindBuffer->TranslatedEvents.Add(TEXT("Punch"));
+		RebindBuffer->TranslatedEvents.Add(TEXT("Kick"));
+		RebindBuffer->TranslatedEvents.Add(TEXT("Down"));
+		RebindBuffer->Initialize();
+
+		TArray<FInputHistoryRecord> Records;
+		int32 Index = Records.AddDefaulted();
+		Records[Index].Events.Add(TEXT("Punch"));
+		Records[Index].Events.Add(TEXT("Down"));
+		Records[Index].StartTime = Records[Index].EndTime = 1.f;
+		Index = Records.AddDefaulted();
+		Records[Index].Events.Add(TEXT("Kick"));
+		Records[Index].StartTime = Records[Index].EndTime = 2.f;
+		RebindBuffer->SetHistoryRecords(Records);
+
+		// Register a new event first and drop one, so remaining events move to other bits.
+		RebindBuffer->TranslatedEvents.Reset();
+		RebindBuffer->TranslatedEvents.Add(TEXT("Up"));
+		RebindBuffer->TranslatedEvents.Add(TEXT("Down"));
+		RebindBuffer->TranslatedEvents.Add(TEXT("Punch"));
+		TestEqual(TEXT("Registering input events again should return the number of registered events."), RebindBuffer->Reinitialize(), 3);
+
+		Records[0].Events = { TEXT("Down"), TEXT("Punch") };
+		Records[1].Events.Reset();
+
+		TArray<FInputHistoryRecord> RemappedRecords;
+		RebindBuffer->GetHistoryRecords(RemappedRecords);
+		TestEqual(TEXT("Buffered input should keep its events, in order of the new registration, and lose dropped ones."), RemappedRecords, Records);
+
+		// Switching between key sets, e.g. sub-modes, reuses key states of unbound keys.
+		RebindBuffer->EventSetups.AddDefaulted();
+		RebindBuffer->EventSetups[0].Name = TEXT("Jump");
+		RebindBuffer->EventSetups[0].Keys.Add(EKeys::SpaceBar);
+		RebindBuffer->Reinitialize();
+
+		const int32 SnapshotSize = RebindBuffer->GetSnapshotSize();
+		for (int32 Idx = 0; Idx < 40; Idx++)
+		{
+			RebindBuffer->EventSetups[0].Keys[0] = Idx % 2 ? EKeys::SpaceBar : EKeys::Gamepad_FaceButton_Bottom;
+			RebindBuffer->Reinitialize();
+		}
+		TestEqual(TEXT("Switching between key sets should not grow snapshots."), RebindBuffer->GetSnapshotSize(), SnapshotSize);
+	}
+
+	// Archive of evicted records
+	{
+		auto ArchiveBuffer = NewObject<UInputBufferComponent>();
+		ArchiveBuffer->TranslatedEvents.Add(TEXT("Punch"));
+		ArchiveBuffer->TranslatedEvents.Add(TEXT("Down"));
+		ArchiveBuffer->MaxInputHistory = 4;
+		ArchiveBuffer->MaxArchivedHistory = 1000;
+		ArchiveBuffer->bFrameIndexedSimulation = true;
+		ArchiveBuffer->Initialize();
+
+		// Every frame changes input events, so every frame adds a record.
+		const int32 NumFrames = 200;
+		const uint64 Punch = 1 << 0;
+		const uint64 Down = 1 << 1;
+		for (int32 Frame = 1; Frame <= NumFrames; Frame++)
+		{
+			ArchiveBuffer->SimulateFrame(Frame, Frame % 2 ? Down : Punch);
+		}
+
+		const FInputHistoryArchive& Archive = ArchiveBuffer->GetArchivedHistory();
+		TestEqual(TEXT("Every evicted record should be archived."), Archive.Num(), NumFrames - ArchiveBuffer->GetInputHistory().Num());
+		TestTrue(TEXT("Archived records should take less memory than uncompressed ones."), Archive.GetAllocatedSize() < Archive.Num() * sizeof(FInputBufferRecord));
+
+		TArray<FInputHistoryRecord> Records;
+		ArchiveBuffer->GetArchivedHistoryRecords(Records);
+		ArchiveBuffer->GetHistoryRecords(Records);
+		TestEqual(TEXT("Archived records followed by input history should cover all input."), Records.Num(), NumFrames);
+
+		bool bChronological = true;
+		for (int32 Idx = 0; Idx < Records.Num(); Idx++)
+		{
+			bChronological = bChronological && Records[Idx].StartTime == (float)(Idx + 1) && Records[Idx].Events.Num() == 1 && Records[Idx].Events[0] == ((Idx + 1) % 2 ? TEXT("Down") : TEXT("Punch"));
+		}
+		TestTrue(TEXT("Archived records should be decoded as they were recorded."), bChronological);
+
+		FInputHistoryArchive::FReader Reader(Archive);
+		FInputBufferRecord Record;
+		TestTrue(TEXT("Seeking should find a record that ends at a given time."), Reader.Seek(150.f) && Reader.Next(Record) && Record.EndTime == 150.f);
+		TestTrue(TEXT("Reading should go on from the sought record."), Reader.Next(Record) && Record.EndTime == 151.f);
+		TestFalse(TEXT("Seeking beyond the archive should find nothing."), Reader.Seek((float)NumFrames));
+
+		// Rolling back and simulating again evicts the same records again, which must not be archived twice.
+		TArray<uint8> Snapshot;
+		Snapshot.SetNumUninitialized(ArchiveBuffer->GetSnapshotSize());
+		ArchiveBuffer->SaveSnapshot(Snapshot.GetData());
+		for (int32 Frame = NumFrames + 1; Frame <= NumFrames + 30; Frame++)
+		{
+			ArchiveBuffer->SimulateFrame(Frame, Frame % 2 ? Down : Punch);
+		}
+
+		TestTrue(TEXT("Restoring a snapshot should succeed."), ArchiveBuffer->RestoreSnapshot(Snapshot.GetData()));
+		TestEqual(TEXT("Restoring a snapshot should remove records archived after it."), Archive.Num(), NumFrames - ArchiveBuffer->GetInputHistory().Num());
+		for (int32 Frame = NumFrames + 1; Frame <= NumFrames + 30; Frame++)
+		{
+			ArchiveBuffer->SimulateFrame(Frame, Frame % 2 ? Down : Punch);
+		}
+
+		// Shrinking input history drops its oldest records, which must be archived too.
+		ArchiveBuffer->MaxInputHistory = 2;
+		ArchiveBuffer->Reinitialize();
+
+		Records.Reset();
+		ArchiveBuffer->GetArchivedHistoryRecords(Records);
+		TestEqual(TEXT("Records dropped by shrinking input history should be archived."), Archive.Num(), NumFrames + 30 - 2);
+		ArchiveBuffer->GetHistoryRecords(Records);
+
+		bChronological = Records.Num() == NumFrames + 30;
+		for (int32 Idx = 0; Idx < Records.Num(); Idx++)
+		{
+			bChronological = bChronological && Records[Idx].StartTime == (float)(Idx + 1);
+		}
+		TestTrue(TEXT("Records archived across a rollback and a shrink should stay in order without duplicates."), bChronological);
+
+		Records.Reset();
+		ArchiveBuffer->GetArchivedHistoryRecords(Records, 190.f);
+		TestTrue(TEXT("Archived records should be retrieved from a given time."), Records.Num() > 0 && Records[0].EndTime == 190.f);
+
+		ArchiveBuffer->MaxArchivedHistory = 100;
+		ArchiveBuffer->Initialize();
+		for (int32 Frame = 1; Frame <= NumFrames; Frame++)
+		{
+			ArchiveBuffer->SimulateFrame(Frame, Frame % 2 ? Down : Punch);
+		}
+		TestTrue(TEXT("The archive should drop whole blocks of the oldest records beyond its limit."), Archive.Num() >= 100 && Archive.Num() < 100 + FInputHistoryArchive::RECORDS_PER_BLOCK);
+	}
+
+	return true;
+}
+
 #endif //WITH_DEV_AUTOMATION_TESTS
\ No newline at end of file